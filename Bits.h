@@ -6,6 +6,23 @@
 #include <limits>
 #include <cstring>
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// the GCC and clang builtins count and swap bits in one instruction where the target has one (see the
+// bit utilities); other compilers, or EMATTSAN_BITS_NO_BUILTINS defined, use shift and mask fallbacks
+#if defined(__GNUC__) && !defined(EMATTSAN_BITS_NO_BUILTINS)
+#define EMATTSAN_BITS_HAS_BUILTINS
+#endif
+
+// __builtin_bitreverse64 (clang) reverses bits in a few instructions; see bitreverse
+#if defined(__has_builtin) && !defined(EMATTSAN_BITS_NO_BUILTINS)
+#if __has_builtin(__builtin_bitreverse64)
+#define EMATTSAN_BITS_HAS_BITREVERSE
+#endif
+#endif
+
 //----------------------------------------------------------------------
 
 namespace emattsan
@@ -21,7 +38,12 @@ namespace bits
 struct Signed;   // only declaration; used template parameter for expressing number signed
 struct Unsigned; // only declaration; used template parameter for expressing number unsigned
 
+template<typename S> struct Saturate; // only declaration; Bits<N, Saturate<S> > clamps instead of wrapping (see Container)
+
 template<int SIZE, typename T> class Bits;
+template<typename E>             class Lazy;
+template<int SIZE, typename S>   class Wide;
+template<typename B, int HI, int LO> class BitSlice;
 
 //----------------------------------------------------------------------
 
@@ -207,139 +229,147 @@ struct Traits<MultiByte<N> >
 
 //----------------------------------------------------------------------
 
-template<int N, typename S = Unsigned>
-struct Fit
+// the primitive type of RANK (0: char, 1: short, 2: int, 3: long) and sign S
+template<int RANK, typename S> struct FitPrimitive;
+template<> struct FitPrimitive<0, Unsigned> { typedef unsigned char  value_type; };
+template<> struct FitPrimitive<1, Unsigned> { typedef unsigned short value_type; };
+template<> struct FitPrimitive<2, Unsigned> { typedef unsigned int   value_type; };
+template<> struct FitPrimitive<3, Unsigned> { typedef unsigned long  value_type; };
+template<> struct FitPrimitive<0, Signed>   { typedef signed   char  value_type; };
+template<> struct FitPrimitive<1, Signed>   { typedef signed   short value_type; };
+template<> struct FitPrimitive<2, Signed>   { typedef signed   int   value_type; };
+template<> struct FitPrimitive<3, Signed>   { typedef signed   long  value_type; };
+
+// traits of the smallest type which holds N bits; MultiByte if no primitive type does.
+// the rank is computed, so that each N instantiates only Fit itself
+template<int N, typename S = Unsigned, bool PRIMITIVE = (N <= std::numeric_limits<unsigned int>::digits)>
+struct Fit : Traits<typename FitPrimitive<(std::numeric_limits<unsigned char >::digits < N) +
+                                          (std::numeric_limits<unsigned short>::digits < N), S>::value_type>
 {
-    template<typename SIGN, bool LE_CHAR_SIZE, bool LE_SHORT_SIZE, bool LE_INT_SIZE, bool LE_LONG_SIZE>
-    struct _
-    {
-        typedef Traits<MultiByte<N> > traits;
-    };
+    typedef Traits<typename FitPrimitive<(std::numeric_limits<unsigned char >::digits < N) +
+                                         (std::numeric_limits<unsigned short>::digits < N), S>::value_type> traits;
+};
 
-    template<typename SIGN, bool LE_SHORT_SIZE, bool LE_INT_SIZE, bool LE_LONG_SIZE>
-    struct _<SIGN, true, LE_SHORT_SIZE, LE_INT_SIZE, LE_LONG_SIZE>
-    {
-        typedef Traits<unsigned char> traits;
-    };
+template<int N, typename S>
+struct Fit<N, S, false> : Traits<MultiByte<N> >
+{
+    typedef Traits<MultiByte<N> > traits;
+};
 
-    template<typename SIGN, bool LE_INT_SIZE, bool LE_LONG_SIZE>
-    struct _<SIGN, false, true, LE_INT_SIZE, LE_LONG_SIZE>
-    {
-        typedef Traits<unsigned short> traits;
-    };
+// only declaration; for error message when invalid template parameter is used
+template<bool VALID> struct ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE;
+template<>           struct ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<true> { static const int value = 1; };
 
-    template<typename SIGN, bool LE_LONG_SIZE>
-    struct _<SIGN, false, false, true, LE_LONG_SIZE>
-    {
-        typedef Traits<unsigned int> traits;
-    };
+template<typename T, int N>
+struct Mask
+{
+    static const int Capacity = std::numeric_limits<T>::digits;
 
-    template<bool LE_SHORT_SIZE, bool LE_INT_SIZE, bool LE_LONG_SIZE>
-    struct _<Signed, true, LE_SHORT_SIZE, LE_INT_SIZE, LE_LONG_SIZE>
-    {
-        typedef Traits<signed char> traits;
-    };
+    // ((1 << (N - 1)) << 1) - 1 never shifts by the width of T, even if N == Capacity
+    static const T value = static_cast<T>(
+        ((static_cast<T>(ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<(0 < N) && (N <= Capacity)>::value)
+          << ((N - 1) & (Capacity - 1))) << 1) - 1);
+
+    static const T msb = value ^ (value >> 1);
+};
+
+// sign extension strategies of SIZE bits in a primitive container of traits T.
+// TrimShift and TrimXor rely on two's complement conversions and arithmetic right shifts
+
+// the word in which a container of traits T is computed (int or long), of sign S
+template<typename T, typename S>
+struct TrimWord
+{
+    typedef typename FitPrimitive<2 + (std::numeric_limits<unsigned int>::digits < T::Capacity), S>::value_type type;
+};
 
-    template<bool LE_INT_SIZE, bool LE_LONG_SIZE>
-    struct _<Signed, false, true, LE_INT_SIZE, LE_LONG_SIZE>
+// mask, then fill the left side if the MSB is high
+struct TrimBranch
+{
+    template<typename T, int SIZE>
+    static void trim(typename T::ref_arg_type n)
     {
-        typedef Traits<signed short> traits;
-    };
+        static const typename T::mask_type mask = Mask<typename T::mask_type, SIZE>::value;
+        static const typename T::mask_type msb  = mask ^ (mask >> 1);
+
+        n &= mask;
+        if((n & msb) != 0) // if MSB is high then ...
+        {
+            n |= ~mask;    // ... padding the left side with 1
+        }
+    }
+};
 
-    template<bool LE_LONG_SIZE>
-    struct _<Signed, false, false, true, LE_LONG_SIZE>
+// move the MSB to the top of the word and shift it back arithmetically
+struct TrimShift
+{
+    template<typename T, int SIZE>
+    static void trim(typename T::ref_arg_type n)
     {
-        typedef Traits<signed int> traits;
-    };
+        typedef typename TrimWord<T, Signed>::type   word;
+        typedef typename TrimWord<T, Unsigned>::type unsigned_word;
 
-     typedef typename _< S,
-                         (N <= Traits<unsigned char >::Capacity),
-                         (N <= Traits<unsigned short>::Capacity),
-                         (N <= Traits<unsigned int  >::Capacity),
-                         (N <= Traits<unsigned long >::Capacity)
-                       >::traits traits;
+        static const int Shift = std::numeric_limits<unsigned_word>::digits - SIZE;
 
-    typedef typename traits::signed_value_type   signed_value_type;
-    typedef typename traits::unsigned_value_type unsigned_value_type;
-    typedef typename traits::value_type          value_type;
-    typedef typename traits::sign_type           sign_type;
-    typedef typename traits::arg_type            arg_type;
-    typedef typename traits::const_arg_type      const_arg_type;
-    typedef typename traits::ref_arg_type        ref_arg_type;
-    typedef typename traits::result_type         result_type;
-    typedef typename traits::const_result_type   const_result_type;
+        n = static_cast<typename T::value_type>(static_cast<word>(static_cast<unsigned_word>(n) << Shift) >> Shift);
+    }
 };
 
-template<typename T> struct TraitsType;
-template<>           struct TraitsType<char>           { typedef Traits<char>           traits; };
-template<>           struct TraitsType<signed char>    { typedef Traits<signed char>    traits; };
-template<>           struct TraitsType<unsigned char>  { typedef Traits<unsigned char>  traits; };
-template<>           struct TraitsType<signed short>   { typedef Traits<signed short>   traits; };
-template<>           struct TraitsType<unsigned short> { typedef Traits<unsigned short> traits; };
-template<>           struct TraitsType<signed int>     { typedef Traits<signed int>     traits; };
-template<>           struct TraitsType<unsigned int>   { typedef Traits<unsigned int>   traits; };
-template<>           struct TraitsType<signed long>    { typedef Traits<signed long>    traits; };
-template<>           struct TraitsType<unsigned long>  { typedef Traits<unsigned long>  traits; };
-template<int N>      struct TraitsType<MultiByte<N> >  { typedef Traits<MultiByte<N> >  traits; };
-
-template<typename T, int N>
-struct Mask
+// mask, then flip the MSB and subtract it: 0 stays positive, 1 borrows from all the left side
+struct TrimXor
 {
-    // only declaration; for error message when invalid template parameter is used
-    struct ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE;
-
-    template<int M, bool GREATER_THAN_ZERO, bool LESS_THAN_M, bool EQUAL_M>
-    struct _
+    template<typename T, int SIZE>
+    static void trim(typename T::ref_arg_type n)
     {
-        static const T value = ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE::value;
-    };
+        typedef typename TrimWord<T, Unsigned>::type unsigned_word;
 
-    template<int M>
-    struct _<M, true, true, false>
-    {
-        static const T value = static_cast<T>((1u << M) - 1);
-    };
+        static const unsigned_word mask = Mask<typename T::mask_type, SIZE>::value;
+        static const unsigned_word msb  = mask ^ (mask >> 1);
 
-    template<int M>
-    struct _<M, true, false, true>
+        n = static_cast<typename T::value_type>(((static_cast<unsigned_word>(n) & mask) ^ msb) - msb);
+    }
+};
+
+#if defined(__BMI2__)
+
+// as TrimXor, masking with BZHI (zero the bits from SIZE up)
+struct TrimBzhi
+{
+    static unsigned int  bzhi(unsigned int n,  unsigned int size) { return _bzhi_u32(n, size); }
+    static unsigned long bzhi(unsigned long n, unsigned int size)
     {
-        static const T value = static_cast<T>(-1);
-    };
+        return (std::numeric_limits<unsigned long>::digits == 64) ? static_cast<unsigned long>(_bzhi_u64(n, size)) : _bzhi_u32(static_cast<unsigned int>(n), size);
+    }
 
-    template<int M>
-    struct _<M, true, false, false>
+    template<typename T, int SIZE>
+    static void trim(typename T::ref_arg_type n)
     {
-        static const T value = static_cast<T>((1u << (M % std::numeric_limits<unsigned char>::digits)) - 1);;
-    };
+        typedef typename TrimWord<T, Unsigned>::type unsigned_word;
 
-    static const T value = _< N,
-                              0 < N,
-                              N < Traits<T>::Capacity,
-                              N == Traits<T>::Capacity
-                            >::value;
+        static const unsigned_word msb = static_cast<unsigned_word>(1) << (SIZE - 1);
 
-    static const T msb = value ^ (value >> 1);
+        n = static_cast<typename T::value_type>((bzhi(static_cast<unsigned_word>(n), SIZE) ^ msb) - msb);
+    }
 };
 
-template<int N>
-struct Mask<Unsigned, N>
-{
-    static const unsigned char value = N % std::numeric_limits<unsigned char>::digits;
-};
+#endif//__BMI2__
+
+// the strategy of the signed containers of traits T (see sample/bench/trim_bench.cpp); define
+// EMATTSAN_BITS_TRIM_STRATEGY (e.g. emattsan::bits::detail::TrimBranch) to use one strategy for every type
+#if defined(EMATTSAN_BITS_TRIM_STRATEGY)
+template<typename T> struct TrimStrategy { typedef EMATTSAN_BITS_TRIM_STRATEGY type; };
+#else
+template<typename T> struct TrimStrategy                       { typedef TrimShift type; };
+template<>           struct TrimStrategy<Traits<signed char> > { typedef TrimXor   type; }; // shifts of promoted values
+template<>           struct TrimStrategy<Traits<short> >       { typedef TrimXor   type; }; // keep vector lanes wide
+#endif
 
 template<typename T, int SIZE, typename S>
 struct Trimmer
 {
-    static const typename T::mask_type mask = Mask<typename T::mask_type, SIZE>::value;
-    static const typename T::mask_type msb  = mask ^ (mask >> 1);
-
     static void trim(typename T::ref_arg_type n)
     {
-        n &= mask;
-        if((n & msb) != 0) // if MSB is high then ...
-        {
-            n |= ~mask;    // ... padding the left side with 1
-        }
+        TrimStrategy<T>::type::template trim<T, SIZE>(n);
     }
 };
 
@@ -359,7 +389,8 @@ struct Trimmer<Traits<MultiByte<N> >, SIZE, Unsigned>
 {
     typedef MultiByte<N> multibyte;
 
-    static const typename multibyte::mask_type mask = Mask<typename multibyte::mask_type, SIZE>::value;
+    // the first block holds the highest (SIZE - 1) % BlockSize + 1 bits
+    static const typename multibyte::mask_type mask = Mask<typename multibyte::mask_type, (SIZE - 1) % multibyte::BlockSize + 1>::value;
 
     static typename multibyte::const_result_type trim(typename multibyte::ref_arg_type n)
     {
@@ -368,16 +399,191 @@ struct Trimmer<Traits<MultiByte<N> >, SIZE, Unsigned>
     }
 };
 
+//----------------------------------------------------------------------
+
+#if defined(EMATTSAN_BITS_TRIM_TELEMETRY)
+
+// counts of the trims which changed the value, per container type (see namespace telemetry).
+// every thread counts into its own block, found through a thread local pointer; blocks are
+// linked into a list on the first trim of the thread and never freed, so that the counts of
+// finished threads remain. the counters are read and written with relaxed atomics; these are the
+// __atomic and __sync builtins of GCC and clang, so the telemetry needs one of them
+
+#if !defined(EMATTSAN_BITS_TRIM_TELEMETRY_TYPES)
+#define EMATTSAN_BITS_TRIM_TELEMETRY_TYPES 256 // types beyond this share the counter 0
+#endif
+
+struct TrimType
+{
+    int       size;
+    int       capacity;
+    bool      isSigned;
+    bool      saturating; // Saturate<S>; the count is of clamped values
+    int       id;         // 0 until the first trim which changes a value
+    TrimType* next;
+};
+
+struct TrimBlock
+{
+    unsigned long counts[EMATTSAN_BITS_TRIM_TELEMETRY_TYPES];
+    TrimBlock*    next;
+};
+
+// a template, so that the static members are defined once in a program of any number of translation units
+template<typename DUMMY = void>
+struct TrimRegistry
+{
+    static TrimType*           types;
+    static TrimBlock*          blocks;
+    static int                 lastId;
+    static __thread TrimBlock* block;
+
+    template<typename T>
+    static void push(T*& head, T* node)
+    {
+        do
+        {
+            node->next = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        } while(!__sync_bool_compare_and_swap(&head, node->next, node));
+    }
+
+    static int slot(const TrimType& type)
+    {
+        const int id = __atomic_load_n(&type.id, __ATOMIC_ACQUIRE);
+        return (id < EMATTSAN_BITS_TRIM_TELEMETRY_TYPES) ? id : 0;
+    }
+
+    static void count(TrimType& type)
+    {
+        if(__atomic_load_n(&type.id, __ATOMIC_ACQUIRE) == 0)
+        {
+            // a type losing the race wastes an id
+            if(__sync_bool_compare_and_swap(&type.id, 0, __sync_add_and_fetch(&lastId, 1)))
+            {
+                push(types, &type);
+            }
+        }
+        if(block == 0)
+        {
+            block = new TrimBlock();
+            push(blocks, block);
+        }
+        unsigned long& counter = block->counts[slot(type)];
+        __atomic_store_n(&counter, counter + 1, __ATOMIC_RELAXED);
+    }
+
+    static unsigned long total(const TrimType& type)
+    {
+        if(__atomic_load_n(&type.id, __ATOMIC_ACQUIRE) == 0)
+        {
+            return 0;
+        }
+        unsigned long sum = 0;
+        for(const TrimBlock* b = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); b != 0; b = b->next)
+        {
+            sum += __atomic_load_n(&b->counts[slot(type)], __ATOMIC_RELAXED);
+        }
+        return sum;
+    }
+
+    static void reset()
+    {
+        for(TrimBlock* b = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); b != 0; b = b->next)
+        {
+            for(int i = 0; i < EMATTSAN_BITS_TRIM_TELEMETRY_TYPES; ++i)
+            {
+                __atomic_store_n(&b->counts[i], 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+};
+
+template<typename DUMMY> TrimType*           TrimRegistry<DUMMY>::types  = 0;
+template<typename DUMMY> TrimBlock*          TrimRegistry<DUMMY>::blocks = 0;
+template<typename DUMMY> int                 TrimRegistry<DUMMY>::lastId = 0;
+template<typename DUMMY> __thread TrimBlock* TrimRegistry<DUMMY>::block  = 0;
+
+template<typename C>
+struct TrimCounter
+{
+    static TrimType type;
+};
+
+template<typename C>
+TrimType TrimCounter<C>::type = { C::Size, C::Capacity, std::numeric_limits<typename C::value_type>::is_signed, false, 0, 0 };
+
+template<typename T>
+inline bool changed(const T& before, const T& after)
+{
+    return before != after;
+}
+
+template<int N>
+inline bool changed(const MultiByte<N>& before, const MultiByte<N>& after)
+{
+    return std::memcmp(before.value_, after.value_, MultiByte<N>::Length) != 0;
+}
+
+#endif//EMATTSAN_BITS_TRIM_TELEMETRY
+
+template<typename T, typename U>
+struct Sign
+{
+    template<bool C, typename T1, typename T2> struct _                { typedef T1 type; };
+    template<typename T1, typename T2>         struct _<false, T1, T2> { typedef T2 type; };
+
+    typedef typename _<std::numeric_limits<T>::is_signed && std::numeric_limits<U>::is_signed, Signed, Unsigned>::type sign_type;
+};
+
+template<typename T>
+struct Sign<T, Unsigned>
+{
+    typedef Unsigned sign_type;
+};
+
+template<typename U>
+struct Sign<Unsigned, U>
+{
+    typedef Unsigned sign_type;
+};
+
+template<>
+struct Sign<Unsigned, Unsigned>
+{
+    typedef Unsigned sign_type;
+};
+
+template<>
+struct Sign<Signed, Signed>
+{
+    typedef Signed sign_type;
+};
+
+// the bits of a value as an unsigned sequence; a MultiByte value already is one
+template<typename T, int SIZE>
+struct Sequence
+{
+    static typename T::result_type get(typename T::const_arg_type value)
+    {
+        return static_cast<typename T::unsigned_value_type>(value) & Mask<typename T::mask_type, SIZE>::value;
+    }
+};
+
+template<int N, int SIZE>
+struct Sequence<Traits<MultiByte<N> >, SIZE>
+{
+    static const MultiByte<N>& get(const MultiByte<N>& value)
+    {
+        return value;
+    }
+};
+
 template<int SIZE, typename T = typename Fit<SIZE>::value_type>
 struct Container
 {
     static const int Size = SIZE;
 
-    template<int S, typename U> struct _              { typedef U                                        value_type; };
-    template<int S>             struct _<S, Signed>   { typedef typename Fit<Size, Signed>::value_type   value_type; };
-    template<int S>             struct _<S, Unsigned> { typedef typename Fit<Size, Unsigned>::value_type value_type; };
-
-    typedef typename TraitsType<typename _<SIZE, T>::value_type>::traits traits;
+    typedef Traits<T> traits;
 
     typedef typename traits::signed_value_type   signed_value_type;
     typedef typename traits::unsigned_value_type unsigned_value_type;
@@ -394,15 +600,110 @@ struct Container
 
     static void trim(ref_arg_type n)
     {
+#if defined(EMATTSAN_BITS_TRIM_TELEMETRY)
+        const value_type before = n;
+        Trimmer<traits, Size, sign_type>::trim(n);
+        if(changed(before, n))
+        {
+            TrimRegistry<>::count(TrimCounter<Container>::type);
+        }
+#else
         Trimmer<traits, Size, sign_type>::trim(n);
+#endif
+    }
+
+    // the bits of a pack
+    static void trimSequence(ref_arg_type n)
+    {
+        trim(n);
     }
 
     static const_result_type getSequence(const_arg_type value)
     {
-        return static_cast<unsigned_value_type>(value) & Mask<mask_type, Size>::value;
+        return Sequence<traits, Size>::get(value);
+    };
+};
+
+// Signed and Unsigned choose the smallest type
+template<int SIZE> struct Container<SIZE, Signed>   : Container<SIZE, typename Fit<SIZE, Signed>::value_type>   {};
+template<int SIZE> struct Container<SIZE, Unsigned> : Container<SIZE, typename Fit<SIZE, Unsigned>::value_type> {};
+
+// values out of SIZE bits of sign S (signed, unsigned, Signed or Unsigned) clamp to the nearest
+// end instead of wrapping; the bits of a pack still wrap. values are stored in the smallest type
+// (storage_type) but read and written as long, so that a sum or a product of two of them is exact
+// before it is clamped
+template<int SIZE, typename S>
+struct Container<SIZE, Saturate<S> >
+{
+    static const int Size = SIZE;
+
+    typedef Traits<long> traits;
+
+    typedef typename Fit<SIZE, typename Sign<S, S>::sign_type>::value_type storage_type;
+
+    typedef typename traits::signed_value_type   signed_value_type;
+    typedef typename traits::unsigned_value_type unsigned_value_type;
+    typedef typename traits::value_type          value_type;
+    typedef typename Sign<S, S>::sign_type       sign_type;
+    typedef typename traits::arg_type            arg_type;
+    typedef typename traits::const_arg_type      const_arg_type;
+    typedef typename traits::ref_arg_type        ref_arg_type;
+    typedef typename traits::result_type         result_type;
+    typedef typename traits::const_result_type   const_result_type;
+    typedef typename traits::mask_type           mask_type;
+
+    static const bool IsSigned = std::numeric_limits<typename FitPrimitive<3, sign_type>::value_type>::is_signed;
+    static const int  Capacity = std::numeric_limits<value_type>::digits / 2 + IsSigned;
+
+    static const mask_type  mask     = Mask<mask_type, Size>::value *
+                                       ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<(0 < SIZE) && (SIZE <= Capacity)>::value;
+    static const value_type max      = static_cast<value_type>(IsSigned ? (mask >> 1) : mask);
+    static const value_type min      = IsSigned ? -max - 1 : 0;
+
+    static void trim(ref_arg_type n)
+    {
+#if defined(EMATTSAN_BITS_TRIM_TELEMETRY)
+        if((n < min) || (max < n))
+        {
+            TrimRegistry<>::count(TrimCounter<Container>::type);
+        }
+#endif
+        n = (n < min) ? min : n;
+        n = (max < n) ? max : n;
+    }
+
+    // the bits of a pack wrap and are not counted by the telemetry
+    static void trimSequence(ref_arg_type n)
+    {
+        Trimmer<traits, Size, sign_type>::trim(n);
+    }
+
+    static result_type getSequence(const_arg_type value)
+    {
+        return static_cast<unsigned_value_type>(value) & mask;
     };
+
+    static storage_type store(value_type n)
+    {
+        trim(n);
+        return static_cast<storage_type>(n);
+    }
+};
+
+#if defined(EMATTSAN_BITS_TRIM_TELEMETRY)
+
+// the sign of a saturating container is the one of S, not of the long holding it
+template<int SIZE, typename S>
+struct TrimCounter<Container<SIZE, Saturate<S> > >
+{
+    static TrimType type;
 };
 
+template<int SIZE, typename S>
+TrimType TrimCounter<Container<SIZE, Saturate<S> > >::type = { SIZE, Container<SIZE, Saturate<S> >::Capacity, Container<SIZE, Saturate<S> >::IsSigned, true, 0, 0 };
+
+#endif//EMATTSAN_BITS_TRIM_TELEMETRY
+
 //----------------------------------------------------------------------
 
 template<int SIZE, typename T>
@@ -452,7 +753,7 @@ public:
     void setSequence(const_arg_type value)
     {
         value_ = value;
-        trim(value_);
+        container::trimSequence(value_);
     }
 
     const_result_type getSequence() const
@@ -464,178 +765,145 @@ private:
     value_type value_;
 };
 
-//----------------------------------------------------------------------
-
-template<typename LHS, typename RHS>
-class PackBase
+// a saturating Bits stores the clamped value in container::storage_type
+template<int SIZE, typename S>
+class BitsBase<SIZE, Saturate<S> >
 {
 public:
-    static const int Size = LHS::Size + RHS::Size;
+    typedef Container<SIZE, Saturate<S> > container;
 
-    typedef Container<Size> container;
+    typedef typename container::signed_value_type   signed_value_type;
+    typedef typename container::unsigned_value_type unsigned_value_type;
+    typedef typename container::value_type          value_type;
+    typedef typename container::sign_type           sign_type;
+    typedef typename container::arg_type            arg_type;
+    typedef typename container::const_arg_type      const_arg_type;
+    typedef typename container::ref_arg_type        ref_arg_type;
+    typedef typename container::result_type         result_type;
+    typedef typename container::const_result_type   const_result_type;
 
-    typedef typename container::value_type         value_type;
-    typedef typename container::arg_type           arg_type;
-    typedef typename container::const_arg_type     const_arg_type;
-    typedef typename container::ref_arg_type       ref_arg_type;
-    typedef typename container::result_type        result_type;
-    typedef typename container::const_result_type  const_result_type;
+    static const int Size     = SIZE;
+    static const int Capacity = container::Capacity;
 
-    PackBase(LHS& lhs, RHS& rhs) : lhs_(lhs), rhs_(rhs)
+    BitsBase() : value_()
     {
     }
 
-    void setSequence(const_arg_type value)
+    BitsBase(const_arg_type value) : value_(container::store(value))
     {
-        rhs_.setSequence(value);
-        lhs_.setSequence(value >> RHS::Size);
     }
 
-    const_result_type getSequence() const
+    void set(const_arg_type value)
     {
-        return (lhs_.getSequence() << RHS::Size) | rhs_.getSequence();
+        value_ = container::store(value);
     }
 
-private:
-    LHS& lhs_;
-    RHS& rhs_;
-};
-
-template<typename LHS, int N>
-class PackBase<LHS, void (*)(Reserved<N>*)>
-{
-public:
-    static const int Size = LHS::Size + N;
-
-    typedef Container<Size> container;
-
-    typedef typename container::value_type         value_type;
-    typedef typename container::arg_type           arg_type;
-    typedef typename container::const_arg_type     const_arg_type;
-    typedef typename container::ref_arg_type       ref_arg_type;
-    typedef typename container::result_type        result_type;
-    typedef typename container::const_result_type  const_result_type;
+    const_result_type get() const
+    {
+        return value_;
+    }
 
-    PackBase(LHS& lhs, void (*)(Reserved<N>*)) : lhs_(lhs)
+    static void trim(ref_arg_type n)
     {
+        container::trim(n);
     }
 
     void setSequence(const_arg_type value)
     {
-        lhs_.setSequence(value >> N);
+        value_type n = value;
+        container::trimSequence(n);
+        value_ = static_cast<typename container::storage_type>(n);
     }
 
     const_result_type getSequence() const
     {
-        return lhs_.getSequence() << N;
+        return container::getSequence(value_);
     }
 
 private:
-    LHS& lhs_;
+    typename container::storage_type value_;
 };
 
-template<typename LHS, typename RHS>
-class ConstPackBase
-{
-public:
-    static const int Size = LHS::Size + RHS::Size;
-
-    typedef Container<Size> container;
-
-    typedef typename container::value_type         value_type;
-    typedef typename container::arg_type           arg_type;
-    typedef typename container::const_arg_type     const_arg_type;
-    typedef typename container::ref_arg_type       ref_arg_type;
-    typedef typename container::result_type        result_type;
-    typedef typename container::const_result_type  const_result_type;
-
-    ConstPackBase(const LHS& lhs, const RHS& rhs) : lhs_(lhs), rhs_(rhs)
-    {
-    }
+//----------------------------------------------------------------------
 
-    const_result_type getSequence() const
-    {
-        return (lhs_.getSequence() << RHS::Size) | rhs_.getSequence();
-    }
+// how a pack holds its right hand side; reserved bits hold nothing
+template<typename T>
+struct Field
+{
+    static const int Size = T::Size;
 
-private:
-    const LHS& lhs_;
-    const RHS& rhs_;
+    typedef T&       type;
+    typedef const T& const_type;
 };
 
-template<typename LHS, int N>
-class ConstPackBase<LHS, void (*)(Reserved<N>*)>
+template<int N>
+class ReservedField
 {
 public:
-    static const int Size = LHS::Size + N;
-
-    typedef Container<Size> container;
-
-    typedef typename container::value_type         value_type;
-    typedef typename container::arg_type           arg_type;
-    typedef typename container::const_arg_type     const_arg_type;
-    typedef typename container::ref_arg_type       ref_arg_type;
-    typedef typename container::result_type        result_type;
-    typedef typename container::const_result_type  const_result_type;
+    static const int Size = N;
 
-    ConstPackBase(const LHS& lhs, void (*)(Reserved<N>*)) : lhs_(lhs)
+    ReservedField(void (*)(Reserved<N>*))
     {
     }
 
-    const_result_type getSequence() const
+    template<typename T>
+    void setSequence(const T&) const
     {
-        return lhs_.getSequence() << N;
     }
 
-private:
-    const LHS& lhs_;
+    unsigned char getSequence() const
+    {
+        return 0;
+    }
 };
 
-//----------------------------------------------------------------------
-
-template<typename T, typename U>
-struct Sign
+template<int N>
+struct Field<void (*)(Reserved<N>*)>
 {
-    template<bool C, typename T1, typename T2> struct _                { typedef T1 type; };
-    template<typename T1, typename T2>         struct _<false, T1, T2> { typedef T2 type; };
+    static const int Size = N;
 
-    typedef typename _<std::numeric_limits<T>::is_signed && std::numeric_limits<U>::is_signed, Signed, Unsigned>::type sign_type;
+    typedef ReservedField<N> type;
+    typedef ReservedField<N> const_type;
 };
 
-template<typename T>
-struct Sign<T, Unsigned>
+// a slice holds a view of its bits
+template<typename B, int HI, int LO>
+struct Field<BitSlice<B, HI, LO> >
 {
-    typedef Unsigned sign_type;
-};
+    static const int Size = BitSlice<B, HI, LO>::Size;
 
-template<typename U>
-struct Sign<Unsigned, U>
-{
-    typedef Unsigned sign_type;
+    typedef BitSlice<B, HI, LO> type;
+    typedef BitSlice<B, HI, LO> const_type;
 };
 
-template<>
-struct Sign<Unsigned, Unsigned>
-{
-    typedef Unsigned sign_type;
-};
+//----------------------------------------------------------------------
 
-template<>
-struct Sign<Signed, Signed>
-{
-    typedef Signed sign_type;
-};
+// a saturating operand makes the result saturate; its sign counts as that of long or unsigned long
+template<typename T> struct Saturating               { typedef T type; static const bool value = false; };
+template<typename S> struct Saturating<Saturate<S> > { typedef typename FitPrimitive<3, typename Sign<S, S>::sign_type>::value_type type; static const bool value = true; };
+
+template<int SIZE, typename S, bool SATURATE> struct ResultBits                { typedef Bits<SIZE, typename Fit<SIZE, S>::value_type> type; };
+template<int SIZE, typename S>                struct ResultBits<SIZE, S, true> { typedef Bits<SIZE, Saturate<S> > type; };
 
 template<int N, int M, typename T, typename U>
 struct Result
 {
     static const int Size = (N < M) ? M : N;
 
-    typedef typename Sign<T, U>::sign_type sign_type;
+    typedef typename Sign<typename Saturating<T>::type, typename Saturating<U>::type>::sign_type sign_type;
 
-    typedef Bits<Size, typename detail::Fit<Size, sign_type>::value_type> result_type;
+    typedef typename ResultBits<Size, sign_type, Saturating<T>::value || Saturating<U>::value>::type result_type;
 };
 
+// only declaration; for error message when a saturating Bits is given to lazy, which wraps
+template<bool VALID> struct ERROR__lazy_CAN_NOT_SATURATE__USE_THE_OPERATORS_OF_Bits;
+template<>           struct ERROR__lazy_CAN_NOT_SATURATE__USE_THE_OPERATORS_OF_Bits<true> {};
+// only declaration; for error message when a lazy product is stored into a MultiByte
+template<bool VALID> struct ERROR__lazy_CAN_NOT_MULTIPLY_MultiByte__USE_THE_OPERATORS_OF_Bits;
+template<>           struct ERROR__lazy_CAN_NOT_MULTIPLY_MultiByte__USE_THE_OPERATORS_OF_Bits<true> {};
+
+template<typename V, bool EXACT = false> struct LazyStore; // value of type V from a lazy expression; see Lazy
+
 //----------------------------------------------------------------------
 
 } // namespace detail
@@ -679,6 +947,16 @@ public:
     {
     }
 
+    template<typename E>
+    explicit Bits(const Lazy<E>& expression) : super(detail::LazyStore<value_type, detail::Saturating<T>::value>::template value<Size>(expression.node()))
+    {
+    }
+
+    template<int M, typename S>
+    explicit Bits(const Wide<M, S>& wide) : super(static_cast<value_type>(wide.get()))
+    {
+    }
+
     Bits& set(const_arg_type n)
     {
         super::set(n);
@@ -700,6 +978,19 @@ public:
         return super::getSequence();
     }
 
+    // bits HI down to LO, read and written in place (see BitSlice)
+    template<int HI, int LO>
+    BitSlice<Bits, HI, LO> slice()
+    {
+        return BitSlice<Bits, HI, LO>(*this);
+    }
+
+    template<int HI, int LO>
+    BitSlice<const Bits, HI, LO> slice() const
+    {
+        return BitSlice<const Bits, HI, LO>(*this);
+    }
+
     operator const_result_type () const
     {
         return get();
@@ -751,6 +1042,19 @@ public:
         return set(n);
     }
 
+    template<typename E>
+    Bits& operator = (const Lazy<E>& expression)
+    {
+        super::set(detail::LazyStore<value_type, detail::Saturating<T>::value>::template value<Size>(expression.node()));
+        return *this;
+    }
+
+    template<int M, typename S>
+    Bits& operator = (const Wide<M, S>& wide)
+    {
+        return set(static_cast<value_type>(wide.get()));
+    }
+
     Bits& operator += (const_arg_type n)
     {
         return set(super::get() + n);
@@ -816,29 +1120,63 @@ public:
 
 //----------------------------------------------------------------------
 
+template<typename LHS, typename RHS> class Pack;
 template<typename LHS, typename RHS> class ConstPack;
 
+namespace detail
+{
+
+// a pack ORs every field at its place (place), rather than shifting the fields before each one again,
+// so that the shift and the mask of a slice fold with the shift to its place. a pack of whole bytes
+// shifts as it goes, which compilers recognize as a load of the bytes in order
+template<typename F>             struct Bytewise                   { static const bool value = (Field<F>::Size % 8) == 0; };
+template<typename L, typename R> struct Bytewise<Pack<L, R> >      { static const bool value = Bytewise<L>::value && Bytewise<R>::value; };
+template<typename L, typename R> struct Bytewise<ConstPack<L, R> > { static const bool value = Bytewise<L>::value && Bytewise<R>::value; };
+
+// the sequence of a field of a pack moved S bits up in V
+template<typename V, int S, typename F>
+inline V place(const F& field)
+{
+    return static_cast<V>(static_cast<V>(field.getSequence()) << S);
+}
+
+template<typename V, int S, typename L, typename R>
+inline V place(const Pack<L, R>& pack)
+{
+    return pack.template placeSequence<V, S>();
+}
+
+template<typename V, int S, typename L, typename R>
+inline V place(const ConstPack<L, R>& pack)
+{
+    return pack.template placeSequence<V, S>();
+}
+
+} // namespace detail
+
 template<typename LHS, typename RHS>
-class Pack : public detail::PackBase<LHS, RHS>
+class Pack
 {
 public:
-    typedef detail::PackBase<LHS, RHS> super;
+    typedef detail::Field<RHS> rhs_field;
+
+    static const int Size = LHS::Size + rhs_field::Size;
 
-    static const int Size = super::Size;
+    typedef detail::Container<Size> container;
 
-    typedef typename super::value_type         value_type;
-    typedef typename super::arg_type           arg_type;
-    typedef typename super::const_arg_type     const_arg_type;
-    typedef typename super::ref_arg_type       ref_arg_type;
-    typedef typename super::result_type        result_type;
-    typedef typename super::const_result_type  const_result_type;
+    typedef typename container::value_type         value_type;
+    typedef typename container::arg_type           arg_type;
+    typedef typename container::const_arg_type     const_arg_type;
+    typedef typename container::ref_arg_type       ref_arg_type;
+    typedef typename container::result_type        result_type;
+    typedef typename container::const_result_type  const_result_type;
 
     static int size()
     {
         return Size;
     }
 
-    Pack(LHS& lhs, RHS& rhs) : super(lhs, rhs)
+    Pack(LHS& lhs, typename rhs_field::type rhs) : lhs_(lhs), rhs_(rhs)
     {
     }
 
@@ -856,7 +1194,24 @@ public:
 
     operator result_type () const
     {
-        return super::getSequence();
+        return getSequence();
+    }
+
+    void setSequence(const_arg_type value)
+    {
+        rhs_.setSequence(value);
+        lhs_.setSequence(value >> rhs_field::Size);
+    }
+
+    const_result_type getSequence() const
+    {
+        return detail::Bytewise<Pack>::value ? ((lhs_.getSequence() << rhs_field::Size) | rhs_.getSequence()) : placeSequence<value_type, 0>();
+    }
+
+    template<typename V, int S>
+    V placeSequence() const
+    {
+        return detail::place<V, S + rhs_field::Size>(lhs_) | detail::place<V, S>(rhs_);
     }
 
     template<int M, typename U>
@@ -871,6 +1226,12 @@ public:
         return Pack<Pack, void (*)(detail::Reserved<M>*)>(*this, rhs);
     }
 
+    template<typename B, int HI, int LO>
+    Pack<Pack, BitSlice<B, HI, LO> > operator , (const BitSlice<B, HI, LO>& rhs)
+    {
+        return Pack<Pack, BitSlice<B, HI, LO> >(*this, rhs);
+    }
+
     template<int M, typename U>
     ConstPack<Pack, Bits<M, U> > operator , (const Bits<M, U>& rhs) const
     {
@@ -894,35 +1255,70 @@ public:
     {
         return ConstPack<Pack, void (*)(detail::Reserved<M>*)>(*this, rhs);
     }
+
+    template<typename B, int HI, int LO>
+    ConstPack<Pack, BitSlice<B, HI, LO> > operator , (const BitSlice<B, HI, LO>& rhs) const
+    {
+        return ConstPack<Pack, BitSlice<B, HI, LO> >(*this, rhs);
+    }
+
+    template<int HI, int LO>
+    BitSlice<Pack, HI, LO> slice()
+    {
+        return BitSlice<Pack, HI, LO>(*this);
+    }
+
+    template<int HI, int LO>
+    BitSlice<const Pack, HI, LO> slice() const
+    {
+        return BitSlice<const Pack, HI, LO>(*this);
+    }
+
+private:
+    LHS&                     lhs_;
+    typename rhs_field::type rhs_;
 };
 
 template<typename LHS, typename RHS>
-class ConstPack : public detail::ConstPackBase<LHS, RHS>
+class ConstPack
 {
 public:
-    typedef detail::ConstPackBase<LHS, RHS> super;
+    typedef detail::Field<RHS> rhs_field;
+
+    static const int Size = LHS::Size + rhs_field::Size;
 
-    static const int Size = super::Size;
+    typedef detail::Container<Size> container;
 
-    typedef typename super::value_type         value_type;
-    typedef typename super::arg_type           arg_type;
-    typedef typename super::const_arg_type     const_arg_type;
-    typedef typename super::ref_arg_type       ref_arg_type;
-    typedef typename super::result_type        result_type;
-    typedef typename super::const_result_type  const_result_type;
+    typedef typename container::value_type         value_type;
+    typedef typename container::arg_type           arg_type;
+    typedef typename container::const_arg_type     const_arg_type;
+    typedef typename container::ref_arg_type       ref_arg_type;
+    typedef typename container::result_type        result_type;
+    typedef typename container::const_result_type  const_result_type;
 
     static int size()
     {
         return Size;
     }
 
-    ConstPack(const LHS& lhs, const RHS& rhs) : super(lhs, rhs)
+    ConstPack(const LHS& lhs, typename rhs_field::const_type rhs) : lhs_(lhs), rhs_(rhs)
     {
     }
 
     operator result_type () const
     {
-        return super::getSequence();
+        return getSequence();
+    }
+
+    const_result_type getSequence() const
+    {
+        return detail::Bytewise<ConstPack>::value ? ((lhs_.getSequence() << rhs_field::Size) | rhs_.getSequence()) : placeSequence<value_type, 0>();
+    }
+
+    template<typename V, int S>
+    V placeSequence() const
+    {
+        return detail::place<V, S + rhs_field::Size>(lhs_) | detail::place<V, S>(rhs_);
     }
 
     template<int M, typename U>
@@ -948,94 +1344,953 @@ public:
     {
         return ConstPack<ConstPack, void (*)(detail::Reserved<M>*)>(*this, rhs);
     }
-};
 
-//----------------------------------------------------------------------
+    template<typename B, int HI, int LO>
+    ConstPack<ConstPack, BitSlice<B, HI, LO> > operator , (const BitSlice<B, HI, LO>& rhs) const
+    {
+        return ConstPack<ConstPack, BitSlice<B, HI, LO> >(*this, rhs);
+    }
 
-#define EMATTSAN_BITS_DEFINE_OP(op)                                                            \
-                                                                                               \
-template<int N, typename T, int M, typename U>                                                 \
-inline typename detail::Result<N, M, T, U>::result_type                                        \
-operator op (const Bits<N, T>& lhs, const Bits<M, U>& rhs)                                     \
-{                                                                                              \
-    return typename detail::Result<N, M, T, U>::result_type(lhs.get() op rhs.get());           \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, typename Bits<N, T>::signed_value_type>::result_type   \
-operator op (const Bits<N, T>& lhs, typename Bits<N, T>::signed_value_type rhs)                \
-{                                                                                              \
-    return lhs op Bits<N, typename Bits<N, T>::signed_value_type>(rhs);                        \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, typename Bits<N, T>::signed_value_type>::result_type   \
-operator op (typename Bits<N, T>::signed_value_type lhs, const Bits<N, T>& rhs)                \
-{                                                                                              \
-    return Bits<N, typename Bits<N, T>::signed_value_type>(lhs) op rhs;                        \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, typename Bits<N, T>::unsigned_value_type>::result_type \
-operator op (const Bits<N, T>& lhs, typename Bits<N, T>::unsigned_value_type rhs)              \
-{                                                                                              \
-    return lhs op Bits<N, typename Bits<N, T>::unsigned_value_type>(rhs);                      \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, typename Bits<N, T>::unsigned_value_type>::result_type \
-operator op (typename Bits<N, T>::unsigned_value_type lhs, const Bits<N, T>& rhs)              \
-{                                                                                              \
-    return Bits<N, typename Bits<N, T>::unsigned_value_type>(lhs) op rhs;                      \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, signed int>::result_type                               \
-operator op (const Bits<N, T>& lhs, signed int rhs)                                            \
-{                                                                                              \
-    return lhs op Bits<N, typename Bits<N, T>::signed_value_type>(rhs);                        \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, signed int>::result_type                               \
-operator op (signed int lhs, const Bits<N, T>& rhs)                                            \
-{                                                                                              \
-    return Bits<N, typename Bits<N, T>::signed_value_type>(lhs) op rhs;                        \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, unsigned int>::result_type                             \
-operator op (const Bits<N, T>& lhs, unsigned int rhs)                                          \
-{                                                                                              \
-    return lhs op Bits<N, typename Bits<N, T>::unsigned_value_type>(rhs);                      \
-}                                                                                              \
-                                                                                               \
-template<int N, typename T>                                                                    \
-inline typename detail::Result<N, N, T, unsigned int>::result_type                             \
-operator op (unsigned int lhs, const Bits<N, T>& rhs)                                          \
-{                                                                                              \
-    return Bits<N, typename Bits<N, T>::unsigned_value_type>(lhs) op rhs;                      \
-}
+    template<int HI, int LO>
+    BitSlice<const ConstPack, HI, LO> slice() const
+    {
+        return BitSlice<const ConstPack, HI, LO>(*this);
+    }
 
+private:
+    const LHS&                     lhs_;
+    typename rhs_field::const_type rhs_;
+};
 
-EMATTSAN_BITS_DEFINE_OP(+)
-EMATTSAN_BITS_DEFINE_OP(-)
-EMATTSAN_BITS_DEFINE_OP(*)
-EMATTSAN_BITS_DEFINE_OP(/)
-EMATTSAN_BITS_DEFINE_OP(%)
-EMATTSAN_BITS_DEFINE_OP(|)
-EMATTSAN_BITS_DEFINE_OP(&)
-EMATTSAN_BITS_DEFINE_OP(^)
+//----------------------------------------------------------------------
 
-#undef EMATTSAN_BITS_DEFINE_OP
+namespace detail
+{
 
-//----------------------------------------------------------------------
+// only declaration; for error message when a slice is out of its bits
+template<bool VALID> struct ERROR__INVALID_slice_RANGE__ONLY_CAN_USE_FROM_ZERO_TO_SIZE_MINUS_ONE;
+template<>           struct ERROR__INVALID_slice_RANGE__ONLY_CAN_USE_FROM_ZERO_TO_SIZE_MINUS_ONE<true> { static const int value = 1; };
 
-template<int N, typename T, int M, typename U>
-Pack<Bits<N, T>, Bits<M, U> > operator , (Bits<N, T>& lhs, Bits<M, U>& rhs)
+template<typename V> struct IsMultiByte                { static const bool value = false; };
+template<int N>      struct IsMultiByte<MultiByte<N> > { static const bool value = true; };
+
+// the 8 bits of a sequence from bit pos up, and the replacement of width of them; bits past the value read as 0
+template<typename V>
+struct SliceBlock
 {
-    return Pack<Bits<N, T>, Bits<M, U> >(lhs, rhs);
-}
+    typedef typename Traits<V>::unsigned_value_type unsigned_value_type;
+
+    static const int Capacity = std::numeric_limits<unsigned_value_type>::digits;
+
+    static unsigned char at(const V& value, int pos)
+    {
+        return (pos < Capacity) ? static_cast<unsigned char>(static_cast<unsigned_value_type>(value) >> pos) : 0;
+    }
+
+    static void put(V& value, int pos, unsigned char block, int width)
+    {
+        if(pos < Capacity)
+        {
+            const unsigned_value_type mask = static_cast<unsigned_value_type>(static_cast<unsigned_value_type>((1u << width) - 1) << pos);
+            value = static_cast<V>((static_cast<unsigned_value_type>(value) & ~mask) | (static_cast<unsigned_value_type>(static_cast<unsigned_value_type>(block) << pos) & mask));
+        }
+    }
+};
+
+// value_[Length - 1] is the least significant block; a block of bits may straddle two of them
+template<int N>
+struct SliceBlock<MultiByte<N> >
+{
+    typedef MultiByte<N> multibyte;
+
+    static const int BlockSize = multibyte::BlockSize;
+    static const int Length    = multibyte::Length;
+
+    static unsigned char at(const multibyte& value, int pos)
+    {
+        const int k = Length - pos / BlockSize - 1;
+        return static_cast<unsigned char>((value.blockAt(k) | (value.blockAt(k - 1) << BlockSize)) >> (pos % BlockSize));
+    }
+
+    static void put(multibyte& value, int pos, unsigned char block, int width)
+    {
+        const int          k    = Length - pos / BlockSize - 1;
+        const unsigned int mask = ((1u << width) - 1) << (pos % BlockSize);
+        const unsigned int bits = (static_cast<unsigned int>(block) << (pos % BlockSize)) & mask;
+        if(0 <= k)
+        {
+            value.value_[k] = static_cast<unsigned char>((value.value_[k] & ~mask) | bits);
+        }
+        if(0 < k)
+        {
+            value.value_[k - 1] = static_cast<unsigned char>((value.value_[k - 1] & ~(mask >> BlockSize)) | (bits >> BlockSize));
+        }
+    }
+};
+
+// bits [LO, LO + SIZE) of a sequence V as a sequence R, and back; a shift and a mask on primitive
+// values, block by block if either is MultiByte
+template<typename V, typename R, bool BLOCKS = IsMultiByte<V>::value || IsMultiByte<R>::value>
+struct SliceAccess
+{
+    static const int BlockSize = std::numeric_limits<unsigned char>::digits;
+
+    template<int LO, int SIZE>
+    static R get(const V& value)
+    {
+        R result = R();
+        for(int k = 0; k < SIZE; k += BlockSize)
+        {
+            SliceBlock<R>::put(result, k, SliceBlock<V>::at(value, LO + k), (SIZE - k < BlockSize) ? SIZE - k : BlockSize);
+        }
+        return result;
+    }
+
+    template<int LO, int SIZE>
+    static V set(const V& value, const R& bits)
+    {
+        V result(value);
+        for(int k = 0; k < SIZE; k += BlockSize)
+        {
+            SliceBlock<V>::put(result, LO + k, SliceBlock<R>::at(bits, k), (SIZE - k < BlockSize) ? SIZE - k : BlockSize);
+        }
+        return result;
+    }
+};
+
+template<typename V, typename R>
+struct SliceAccess<V, R, false>
+{
+    typedef typename Traits<V>::unsigned_value_type unsigned_value_type;
+
+    template<int LO, int SIZE>
+    static R get(const V& value)
+    {
+        return static_cast<R>((static_cast<unsigned_value_type>(value) >> LO) & Mask<unsigned_value_type, SIZE>::value);
+    }
+
+    template<int LO, int SIZE>
+    static V set(const V& value, const R& bits)
+    {
+        const unsigned_value_type mask = Mask<unsigned_value_type, SIZE>::value;
+        return static_cast<V>((static_cast<unsigned_value_type>(value) & static_cast<unsigned_value_type>(~(mask << LO))) |
+                              static_cast<unsigned_value_type>((static_cast<unsigned_value_type>(bits) & mask) << LO));
+    }
+};
+
+} // namespace detail
+
+// bits HI down to LO of a Bits or a pack B as an unsigned sequence of HI - LO + 1 bits, read and
+// written in place without a temporary Bits; a view of a const B only reads.
+//   x.slice<11, 5>() = 3;                               // x[11:5] = 3
+//   (x.slice<15, 12>(), y, x.slice<3, 0>()) = 0x1234;   // {x[15:12], y, x[3:0]} = 16'h1234
+// a slice refers to its bits, as a pack does; use it before the end of the full expression
+template<typename B, int HI, int LO>
+class BitSlice
+{
+public:
+    static const int Size = (HI - LO + 1) *
+                            detail::ERROR__INVALID_slice_RANGE__ONLY_CAN_USE_FROM_ZERO_TO_SIZE_MINUS_ONE<(0 <= LO) && (LO <= HI) && (HI < B::Size)>::value;
+
+    typedef detail::Container<Size> container;
+
+    typedef typename container::value_type         value_type;
+    typedef typename container::arg_type           arg_type;
+    typedef typename container::const_arg_type     const_arg_type;
+    typedef typename container::ref_arg_type       ref_arg_type;
+    typedef typename container::result_type        result_type;
+    typedef typename container::const_result_type  const_result_type;
+
+    static int size()
+    {
+        return Size;
+    }
+
+    explicit BitSlice(B& bits) : bits_(bits)
+    {
+    }
+
+    // a copy views the same bits
+    BitSlice(const BitSlice& other) : bits_(other.bits_)
+    {
+    }
+
+    BitSlice& operator = (const_arg_type value)
+    {
+        setSequence(value);
+        return *this;
+    }
+
+    BitSlice& operator = (const BitSlice& value)
+    {
+        setSequence(value.getSequence());
+        return *this;
+    }
+
+    template<typename C, int H, int L>
+    BitSlice& operator = (const BitSlice<C, H, L>& value)
+    {
+        setSequence(value.getSequence());
+        return *this;
+    }
+
+    operator value_type () const
+    {
+        return getSequence();
+    }
+
+    value_type get() const
+    {
+        return getSequence();
+    }
+
+    void setSequence(const_arg_type value) const
+    {
+        bits_.setSequence(access::template set<LO, Size>(bits_.getSequence(), value));
+    }
+
+    value_type getSequence() const
+    {
+        return access::template get<LO, Size>(bits_.getSequence());
+    }
+
+    // bits H down to L of this slice
+    template<int H, int L>
+    BitSlice<B, LO + H, LO + L> slice() const
+    {
+        return BitSlice<B, LO + H, LO + L>(bits_);
+    }
+
+    template<int M, typename U>
+    Pack<BitSlice, Bits<M, U> > operator , (Bits<M, U>& rhs)
+    {
+        return Pack<BitSlice, Bits<M, U> >(*this, rhs);
+    }
+
+    template<int M>
+    Pack<BitSlice, void (*)(detail::Reserved<M>*)> operator , (void (*rhs)(detail::Reserved<M>*))
+    {
+        return Pack<BitSlice, void (*)(detail::Reserved<M>*)>(*this, rhs);
+    }
+
+    template<typename C, int H, int L>
+    Pack<BitSlice, BitSlice<C, H, L> > operator , (const BitSlice<C, H, L>& rhs)
+    {
+        return Pack<BitSlice, BitSlice<C, H, L> >(*this, rhs);
+    }
+
+    template<int M, typename U>
+    ConstPack<BitSlice, Bits<M, U> > operator , (const Bits<M, U>& rhs) const
+    {
+        return ConstPack<BitSlice, Bits<M, U> >(*this, rhs);
+    }
+
+    template<typename L, typename R>
+    ConstPack<BitSlice, Pack<L, R> > operator , (const Pack<L, R>& rhs) const
+    {
+        return ConstPack<BitSlice, Pack<L, R> >(*this, rhs);
+    }
+
+    template<typename L, typename R>
+    ConstPack<BitSlice, ConstPack<L, R> > operator , (const ConstPack<L, R>& rhs) const
+    {
+        return ConstPack<BitSlice, ConstPack<L, R> >(*this, rhs);
+    }
+
+    template<int M>
+    ConstPack<BitSlice, void (*)(detail::Reserved<M>*)> operator , (void (*rhs)(detail::Reserved<M>*)) const
+    {
+        return ConstPack<BitSlice, void (*)(detail::Reserved<M>*)>(*this, rhs);
+    }
+
+    template<typename C, int H, int L>
+    ConstPack<BitSlice, BitSlice<C, H, L> > operator , (const BitSlice<C, H, L>& rhs) const
+    {
+        return ConstPack<BitSlice, BitSlice<C, H, L> >(*this, rhs);
+    }
+
+private:
+    typedef detail::SliceAccess<typename B::value_type, value_type> access;
+
+    B& bits_;
+};
+
+//----------------------------------------------------------------------
+
+#define EMATTSAN_BITS_DEFINE_OP(op)                                                            \
+                                                                                               \
+template<int N, typename T, int M, typename U>                                                 \
+inline typename detail::Result<N, M, T, U>::result_type                                        \
+operator op (const Bits<N, T>& lhs, const Bits<M, U>& rhs)                                     \
+{                                                                                              \
+    return typename detail::Result<N, M, T, U>::result_type(lhs.get() op rhs.get());           \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, typename Bits<N, T>::signed_value_type>::result_type   \
+operator op (const Bits<N, T>& lhs, typename Bits<N, T>::signed_value_type rhs)                \
+{                                                                                              \
+    return lhs op Bits<N, typename Bits<N, T>::signed_value_type>(rhs);                        \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, typename Bits<N, T>::signed_value_type>::result_type   \
+operator op (typename Bits<N, T>::signed_value_type lhs, const Bits<N, T>& rhs)                \
+{                                                                                              \
+    return Bits<N, typename Bits<N, T>::signed_value_type>(lhs) op rhs;                        \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, typename Bits<N, T>::unsigned_value_type>::result_type \
+operator op (const Bits<N, T>& lhs, typename Bits<N, T>::unsigned_value_type rhs)              \
+{                                                                                              \
+    return lhs op Bits<N, typename Bits<N, T>::unsigned_value_type>(rhs);                      \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, typename Bits<N, T>::unsigned_value_type>::result_type \
+operator op (typename Bits<N, T>::unsigned_value_type lhs, const Bits<N, T>& rhs)              \
+{                                                                                              \
+    return Bits<N, typename Bits<N, T>::unsigned_value_type>(lhs) op rhs;                      \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, signed int>::result_type                               \
+operator op (const Bits<N, T>& lhs, signed int rhs)                                            \
+{                                                                                              \
+    return lhs op Bits<N, typename Bits<N, T>::signed_value_type>(rhs);                        \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, signed int>::result_type                               \
+operator op (signed int lhs, const Bits<N, T>& rhs)                                            \
+{                                                                                              \
+    return Bits<N, typename Bits<N, T>::signed_value_type>(lhs) op rhs;                        \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, unsigned int>::result_type                             \
+operator op (const Bits<N, T>& lhs, unsigned int rhs)                                          \
+{                                                                                              \
+    return lhs op Bits<N, typename Bits<N, T>::unsigned_value_type>(rhs);                      \
+}                                                                                              \
+                                                                                               \
+template<int N, typename T>                                                                    \
+inline typename detail::Result<N, N, T, unsigned int>::result_type                             \
+operator op (unsigned int lhs, const Bits<N, T>& rhs)                                          \
+{                                                                                              \
+    return Bits<N, typename Bits<N, T>::unsigned_value_type>(lhs) op rhs;                      \
+}
+
+
+EMATTSAN_BITS_DEFINE_OP(+)
+EMATTSAN_BITS_DEFINE_OP(-)
+EMATTSAN_BITS_DEFINE_OP(*)
+EMATTSAN_BITS_DEFINE_OP(/)
+EMATTSAN_BITS_DEFINE_OP(%)
+EMATTSAN_BITS_DEFINE_OP(|)
+EMATTSAN_BITS_DEFINE_OP(&)
+EMATTSAN_BITS_DEFINE_OP(^)
+
+#undef EMATTSAN_BITS_DEFINE_OP
+
+//----------------------------------------------------------------------
+
+// lazy(a) * b + lazy(c) * d - e evaluates the whole expression and trims once, when it is stored
+// into a Bits or converted to a value; the results are the same as those of the operators above.
+// +, -, *, |, & and ^ are computed in a wide unsigned type, since their low bits do not depend on
+// the high bits of the operands; only an operand narrower than its result is trimmed on the way.
+// / and % need exact operands, so they use the operators above.
+// on MultiByte values +, -, |, & and ^ are computed block by block into the destination; + and -
+// carry from the blocks below, so a block recomputes the blocks under it. * does not compile on them.
+// an expression refers to its Bits operands; store it before the end of the full expression
+
+namespace detail
+{
+
+typedef unsigned long LazyWide;
+
+// block K from the least significant of value; primitive values are sign extended
+template<typename V>
+struct LazyBlock
+{
+    static const int BlockSize = std::numeric_limits<unsigned char>::digits;
+    static const int Blocks    = sizeof(LazyWide);
+
+    static unsigned char at(const V& value, int k)
+    {
+        const LazyWide wide = static_cast<LazyWide>(value);
+        return (k < Blocks) ? static_cast<unsigned char>(wide >> (k * BlockSize))
+             : (std::numeric_limits<V>::is_signed && ((wide >> (Blocks * BlockSize - 1)) != 0)) ? static_cast<unsigned char>(~0u) : 0;
+    }
+};
+
+template<int N>
+struct LazyBlock<MultiByte<N> >
+{
+    static unsigned char at(const MultiByte<N>& value, int k)
+    {
+        return (k < MultiByte<N>::Length) ? value.value_[MultiByte<N>::Length - k - 1] : 0;
+    }
+};
+
+template<typename V, bool EXACT>
+struct LazyStore
+{
+    // a narrower destination trims the wide value directly
+    template<int N, typename E>
+    static V value(const E& expression)
+    {
+        return (N <= E::Size) ? static_cast<V>(expression.wide()) : static_cast<V>(expression.exact().get());
+    }
+};
+
+// a saturating destination clamps the exact value
+template<typename V>
+struct LazyStore<V, true>
+{
+    template<int N, typename E>
+    static V value(const E& expression)
+    {
+        return static_cast<V>(expression.exact().get());
+    }
+};
+
+template<int M>
+struct LazyStore<MultiByte<M>, false>
+{
+    template<int N, typename E>
+    static MultiByte<M> value(const E& expression)
+    {
+        MultiByte<M> result;
+        for(int k = 0; k < MultiByte<M>::Length; ++k)
+        {
+            result.value_[MultiByte<M>::Length - k - 1] = expression.block(k);
+        }
+        return result;
+    }
+};
+
+// E as an operand of a result of SIZE bits
+template<typename E, int SIZE>
+inline LazyWide lazy_operand(const E& expression)
+{
+    return (E::Size == SIZE) ? expression.wide() : static_cast<LazyWide>(expression.exact().get());
+}
+
+// how a leaf holds its Bits; REF: refers to it, otherwise holds a copy (a converted scalar)
+template<typename B, bool REF> struct LazyHold           { typedef const B& type; };
+template<typename B>           struct LazyHold<B, false> { typedef B        type; };
+
+template<int N, typename T, bool REF = true>
+class LazyLeaf
+{
+public:
+    typedef Bits<N, T> result_type;
+    typedef T          sign_param;
+
+    static const int Size = N;
+
+    explicit LazyLeaf(const result_type& bits) : bits_(bits)
+    {
+    }
+
+    LazyWide wide() const
+    {
+        return static_cast<LazyWide>(bits_.get());
+    }
+
+    const result_type& exact() const
+    {
+        return bits_;
+    }
+
+    unsigned char block(int k) const
+    {
+        return LazyBlock<typename result_type::value_type>::at(bits_.get(), k);
+    }
+
+private:
+    typename LazyHold<result_type, REF>::type bits_;
+};
+
+template<typename L, typename R>
+struct LazyResult
+{
+    typedef typename Result<L::Size, R::Size, typename L::sign_param, typename R::sign_param>::result_type result_type;
+    typedef typename result_type::value_type                                                               value_type;
+};
+
+// a block of OP from the blocks of its operands and the carry from the block below;
+// the bitwise operators do not carry
+template<typename OP>
+struct LazyCarry
+{
+    static const bool Valid   = true;
+    static const bool Carries = false;
+
+    static unsigned int apply(unsigned int lhs, unsigned int rhs, unsigned int&)
+    {
+        return OP::apply(lhs, rhs);
+    }
+};
+
+// the block of a node of OP; a MultiByte result combines the blocks of its operands
+template<typename V>
+struct LazyRingBlock
+{
+    template<typename OP, typename E>
+    static unsigned char at(const E& expression, int k)
+    {
+        return LazyBlock<V>::at(expression.exact().get(), k);
+    }
+};
+
+template<int M>
+struct LazyRingBlock<MultiByte<M> >
+{
+    static const int Top = (M - 1) % MultiByte<M>::BlockSize + 1;
+
+    template<typename OP, typename E>
+    static unsigned char at(const E& expression, int k)
+    {
+        static_cast<void>(sizeof(ERROR__lazy_CAN_NOT_MULTIPLY_MultiByte__USE_THE_OPERATORS_OF_Bits<LazyCarry<OP>::Valid>));
+
+        unsigned int carry = 0;
+        for(int j = 0; LazyCarry<OP>::Carries && (j < k); ++j)
+        {
+            LazyCarry<OP>::apply(expression.lhs().block(j), expression.rhs().block(j), carry);
+        }
+        const unsigned char block = static_cast<unsigned char>(LazyCarry<OP>::apply(expression.lhs().block(k), expression.rhs().block(k), carry));
+        return (k < MultiByte<M>::Length - 1) ? block : (k == MultiByte<M>::Length - 1) ? (block & Mask<unsigned char, Top>::value) : 0;
+    }
+};
+
+// +, -, *, |, &, ^; the result is trimmed only when it is needed exactly
+template<typename OP, typename L, typename R>
+class LazyRing
+{
+public:
+    typedef typename LazyResult<L, R>::result_type result_type;
+    typedef typename LazyResult<L, R>::value_type  sign_param;
+
+    static const int Size = result_type::Size;
+
+    LazyRing(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs)
+    {
+    }
+
+    LazyWide wide() const
+    {
+        return OP::apply(lazy_operand<L, Size>(lhs_), lazy_operand<R, Size>(rhs_));
+    }
+
+    result_type exact() const
+    {
+        return result_type(LazyStore<sign_param>::template value<Size>(*this));
+    }
+
+    unsigned char block(int k) const
+    {
+        return LazyRingBlock<sign_param>::template at<OP>(*this, k);
+    }
+
+    const L& lhs() const { return lhs_; }
+    const R& rhs() const { return rhs_; }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+// /, %; exact operands, the operators above
+template<typename OP, typename L, typename R>
+class LazyDivide
+{
+public:
+    typedef typename LazyResult<L, R>::result_type result_type;
+    typedef typename LazyResult<L, R>::value_type  sign_param;
+
+    static const int Size = result_type::Size;
+
+    LazyDivide(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs)
+    {
+    }
+
+    LazyWide wide() const
+    {
+        return static_cast<LazyWide>(exact().get());
+    }
+
+    result_type exact() const
+    {
+        return OP::template exact<result_type>(lhs_.exact(), rhs_.exact());
+    }
+
+    unsigned char block(int k) const
+    {
+        return LazyBlock<sign_param>::at(exact().get(), k);
+    }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+#define EMATTSAN_BITS_DEFINE_LAZY_RING(name, op)                                                       \
+struct name                                                                                            \
+{                                                                                                      \
+    template<typename V>                                                                               \
+    static V apply(V lhs, V rhs) { return lhs op rhs; }                                                \
+};
+
+#define EMATTSAN_BITS_DEFINE_LAZY_DIVIDE(name, op)                                                     \
+struct name                                                                                            \
+{                                                                                                      \
+    template<typename RESULT, typename L, typename R>                                                  \
+    static RESULT exact(const L& lhs, const R& rhs) { return lhs op rhs; }                             \
+};
+
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazyAdd, +)
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazySub, -)
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazyMul, *)
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazyOr,  |)
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazyAnd, &)
+EMATTSAN_BITS_DEFINE_LAZY_RING(LazyXor, ^)
+EMATTSAN_BITS_DEFINE_LAZY_DIVIDE(LazyDiv, /)
+EMATTSAN_BITS_DEFINE_LAZY_DIVIDE(LazyMod, %)
+
+#undef EMATTSAN_BITS_DEFINE_LAZY_RING
+#undef EMATTSAN_BITS_DEFINE_LAZY_DIVIDE
+
+template<>
+struct LazyCarry<LazyAdd>
+{
+    static const bool Valid   = true;
+    static const bool Carries = true;
+
+    static unsigned int apply(unsigned int lhs, unsigned int rhs, unsigned int& carry)
+    {
+        const unsigned int sum = lhs + rhs + carry;
+        carry = sum >> std::numeric_limits<unsigned char>::digits;
+        return sum;
+    }
+};
+
+template<>
+struct LazyCarry<LazySub>
+{
+    static const bool Valid   = true;
+    static const bool Carries = true;
+
+    static unsigned int apply(unsigned int lhs, unsigned int rhs, unsigned int& borrow)
+    {
+        const unsigned int difference = lhs - rhs - borrow;
+        borrow = (difference >> std::numeric_limits<unsigned char>::digits) & 1;
+        return difference;
+    }
+};
+
+// a product needs every block below; a MultiByte result rejects it
+template<>
+struct LazyCarry<LazyMul>
+{
+    static const bool Valid   = false;
+    static const bool Carries = false;
+
+    static unsigned int apply(unsigned int, unsigned int, unsigned int&)
+    {
+        return 0;
+    }
+};
+
+} // namespace detail
+
+template<typename E>
+class Lazy
+{
+public:
+    typedef typename E::result_type       result_type;
+    typedef typename result_type::value_type value_type;
+
+    static const int Size = E::Size;
+
+    explicit Lazy(const E& node) : node_(node)
+    {
+    }
+
+    const E& node() const
+    {
+        return node_;
+    }
+
+    operator value_type () const
+    {
+        return result_type(*this).get();
+    }
+
+private:
+    E node_;
+};
+
+template<int N, typename T>
+inline Lazy<detail::LazyLeaf<N, T> > lazy(const Bits<N, T>& bits)
+{
+    static_cast<void>(sizeof(detail::ERROR__lazy_CAN_NOT_SATURATE__USE_THE_OPERATORS_OF_Bits<!detail::Saturating<T>::value>));
+    return Lazy<detail::LazyLeaf<N, T> >(detail::LazyLeaf<N, T>(bits));
+}
+
+#define EMATTSAN_BITS_DEFINE_LAZY_OP(op, NODE, NAME)                                                          \
+                                                                                                              \
+template<typename E, typename F>                                                                              \
+inline Lazy<detail::NODE<detail::NAME, E, F> > operator op (const Lazy<E>& lhs, const Lazy<F>& rhs)           \
+{                                                                                                             \
+    return Lazy<detail::NODE<detail::NAME, E, F> >(detail::NODE<detail::NAME, E, F>(lhs.node(), rhs.node())); \
+}                                                                                                             \
+                                                                                                              \
+template<typename E, int M, typename U>                                                                       \
+inline Lazy<detail::NODE<detail::NAME, E, detail::LazyLeaf<M, U> > >                                          \
+operator op (const Lazy<E>& lhs, const Bits<M, U>& rhs)                                                       \
+{                                                                                                             \
+    return lhs op lazy(rhs);                                                                                  \
+}                                                                                                             \
+                                                                                                              \
+template<int N, typename T, typename F>                                                                       \
+inline Lazy<detail::NODE<detail::NAME, detail::LazyLeaf<N, T>, F> >                                           \
+operator op (const Bits<N, T>& lhs, const Lazy<F>& rhs)                                                       \
+{                                                                                                             \
+    return lazy(lhs) op rhs;                                                                                  \
+}                                                                                                             \
+                                                                                                              \
+template<typename E>                                                                                          \
+inline Lazy<detail::NODE<detail::NAME, E, detail::LazyLeaf<E::Size, typename E::result_type::signed_value_type, false> > > \
+operator op (const Lazy<E>& lhs, signed int rhs)                                                              \
+{                                                                                                             \
+    typedef detail::LazyLeaf<E::Size, typename E::result_type::signed_value_type, false> leaf;                \
+    return lhs op Lazy<leaf>(leaf(Bits<E::Size, typename E::result_type::signed_value_type>(rhs)));           \
+}                                                                                                             \
+                                                                                                              \
+template<typename F>                                                                                          \
+inline Lazy<detail::NODE<detail::NAME, detail::LazyLeaf<F::Size, typename F::result_type::signed_value_type, false>, F> > \
+operator op (signed int lhs, const Lazy<F>& rhs)                                                              \
+{                                                                                                             \
+    typedef detail::LazyLeaf<F::Size, typename F::result_type::signed_value_type, false> leaf;                \
+    return Lazy<leaf>(leaf(Bits<F::Size, typename F::result_type::signed_value_type>(lhs))) op rhs;           \
+}                                                                                                             \
+                                                                                                              \
+template<typename E>                                                                                          \
+inline Lazy<detail::NODE<detail::NAME, E, detail::LazyLeaf<E::Size, typename E::result_type::unsigned_value_type, false> > > \
+operator op (const Lazy<E>& lhs, unsigned int rhs)                                                            \
+{                                                                                                             \
+    typedef detail::LazyLeaf<E::Size, typename E::result_type::unsigned_value_type, false> leaf;              \
+    return lhs op Lazy<leaf>(leaf(Bits<E::Size, typename E::result_type::unsigned_value_type>(rhs)));         \
+}                                                                                                             \
+                                                                                                              \
+template<typename F>                                                                                          \
+inline Lazy<detail::NODE<detail::NAME, detail::LazyLeaf<F::Size, typename F::result_type::unsigned_value_type, false>, F> > \
+operator op (unsigned int lhs, const Lazy<F>& rhs)                                                            \
+{                                                                                                             \
+    typedef detail::LazyLeaf<F::Size, typename F::result_type::unsigned_value_type, false> leaf;              \
+    return Lazy<leaf>(leaf(Bits<F::Size, typename F::result_type::unsigned_value_type>(lhs))) op rhs;         \
+}
+
+EMATTSAN_BITS_DEFINE_LAZY_OP(+, LazyRing,   LazyAdd)
+EMATTSAN_BITS_DEFINE_LAZY_OP(-, LazyRing,   LazySub)
+EMATTSAN_BITS_DEFINE_LAZY_OP(*, LazyRing,   LazyMul)
+EMATTSAN_BITS_DEFINE_LAZY_OP(/, LazyDivide, LazyDiv)
+EMATTSAN_BITS_DEFINE_LAZY_OP(%, LazyDivide, LazyMod)
+EMATTSAN_BITS_DEFINE_LAZY_OP(|, LazyRing,   LazyOr)
+EMATTSAN_BITS_DEFINE_LAZY_OP(&, LazyRing,   LazyAnd)
+EMATTSAN_BITS_DEFINE_LAZY_OP(^, LazyRing,   LazyXor)
+
+#undef EMATTSAN_BITS_DEFINE_LAZY_OP
+
+//----------------------------------------------------------------------
+
+// Wide<N, S> is an N bit value of sign S (Signed or Unsigned) which is never trimmed: the result
+// of an operation is as wide as its range, e.g. Bits<5> + Bits<5> => Wide<6>, Bits<5> * Bits<5> => Wide<10>,
+// Bits<5> - Bits<5> => Wide<6, Signed>. only an explicit conversion to Bits trims:
+//
+//   Bits<16, signed> y(wide(x0) * c0 + wide(x1) * c1); // trims once
+//
+// a result wider than unsigned long is a compile error.
+
+namespace detail
+{
+
+// only declaration; for error message when a conversion to Wide would lose bits
+template<bool VALID> struct ERROR__NARROWING_CONVERSION_TO_Wide__USE_Bits_TO_TRIM;
+template<>           struct ERROR__NARROWING_CONVERSION_TO_Wide__USE_Bits_TO_TRIM<true> { static const int value = 1; };
+
+// the smallest primitive type which holds N bits of sign S
+template<int N, typename S>
+struct WideStorage
+{
+    static const int Rank = ((std::numeric_limits<unsigned char >::digits < N) +
+                             (std::numeric_limits<unsigned short>::digits < N) +
+                             (std::numeric_limits<unsigned int  >::digits < N)) *
+                            ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<
+                                (0 < N) && (N <= std::numeric_limits<unsigned long>::digits)>::value;
+
+    typedef typename FitPrimitive<Rank, S>::value_type value_type;
+};
+
+// the width of an N bit value of sign S as a signed value
+template<int N, typename S> struct WideSigned              { static const int Size = N; };
+template<int N>             struct WideSigned<N, Unsigned> { static const int Size = N + 1; };
+
+template<int N, int M> struct WideMax { static const int Size = (N < M) ? M : N; };
+
+// an N bit value of sign S fits in a Wide<M, T>
+template<int N, typename S, int M, typename T> struct WideFits                          { static const bool value = WideSigned<N, S>::Size <= M; };
+template<int N, int M>                         struct WideFits<N, Unsigned, M, Unsigned> { static const bool value = N <= M; };
+template<int N, int M>                         struct WideFits<N, Signed,   M, Unsigned> { static const bool value = false; };
+
+template<int N, typename S, int M, typename T>
+struct WideSum
+{
+    typedef Wide<WideMax<WideSigned<N, S>::Size, WideSigned<M, T>::Size>::Size + 1, Signed> type;
+};
+
+template<int N, int M>
+struct WideSum<N, Unsigned, M, Unsigned>
+{
+    typedef Wide<WideMax<N, M>::Size + 1, Unsigned> type;
+};
+
+template<int N, typename S, int M, typename T>
+struct WideDifference : WideSum<N, S, M, T> {};
+
+template<int N, int M>
+struct WideDifference<N, Unsigned, M, Unsigned>
+{
+    typedef Wide<WideMax<N, M>::Size + 1, Signed> type;
+};
+
+template<int N, typename S, int M, typename T>
+struct WideProduct
+{
+    typedef Wide<N + M, Signed> type;
+};
+
+template<int N, int M>
+struct WideProduct<N, Unsigned, M, Unsigned>
+{
+    typedef Wide<N + M, Unsigned> type;
+};
+
+// builds a Wide of a value in its range
+struct WideAccess
+{
+    template<typename W>
+    static W make(typename W::value_type value)
+    {
+        return W(value, static_cast<WideAccess*>(0));
+    }
+};
+
+} // namespace detail
+
+template<int SIZE, typename S = Unsigned>
+class Wide
+{
+public:
+    typedef typename detail::WideStorage<SIZE, S>::value_type value_type;
+    typedef S                                                 sign_type;
+
+    static const int Size = SIZE;
+
+    static int size()
+    {
+        return Size;
+    }
+
+    Wide() : value_()
+    {
+    }
+
+    // widening only; narrow with Bits
+    template<int N, typename T>
+    Wide(const Bits<N, T>& bits) : value_(bits.get())
+    {
+        static_cast<void>(sizeof(detail::ERROR__NARROWING_CONVERSION_TO_Wide__USE_Bits_TO_TRIM<
+            detail::WideFits<N, typename Bits<N, T>::sign_type, SIZE, S>::value>));
+    }
+
+    template<int N, typename T>
+    Wide(const Wide<N, T>& other) : value_(other.get())
+    {
+        static_cast<void>(sizeof(detail::ERROR__NARROWING_CONVERSION_TO_Wide__USE_Bits_TO_TRIM<
+            detail::WideFits<N, T, SIZE, S>::value>));
+    }
+
+    value_type get() const
+    {
+        return value_;
+    }
+
+    Wide<SIZE + 1, Signed> operator - () const
+    {
+        typedef Wide<SIZE + 1, Signed> result_type;
+
+        return detail::WideAccess::make<result_type>(-static_cast<typename result_type::value_type>(value_));
+    }
+
+private:
+    friend struct detail::WideAccess;
+
+    Wide(value_type value, detail::WideAccess*) : value_(value)
+    {
+    }
+
+    value_type value_;
+};
+
+template<int N, typename T>
+inline Wide<N, typename Bits<N, T>::sign_type> wide(const Bits<N, T>& bits)
+{
+    return Wide<N, typename Bits<N, T>::sign_type>(bits);
+}
+
+// the operands are converted to the type of the result, in which the result can not overflow
+#define EMATTSAN_BITS_DEFINE_WIDE_OP(op, result)                                                      \
+                                                                                                      \
+template<int N, typename S, int M, typename T>                                                        \
+inline typename detail::result<N, S, M, T>::type operator op (const Wide<N, S>& lhs, const Wide<M, T>& rhs) \
+{                                                                                                     \
+    typedef typename detail::result<N, S, M, T>::type result_type;                                    \
+    typedef typename result_type::value_type          value_type;                                     \
+    return detail::WideAccess::make<result_type>(                                                     \
+        static_cast<value_type>(static_cast<value_type>(lhs.get()) op static_cast<value_type>(rhs.get()))); \
+}                                                                                                     \
+                                                                                                      \
+template<int N, typename S, int M, typename T>                                                        \
+inline typename detail::result<N, S, M, typename Bits<M, T>::sign_type>::type                        \
+operator op (const Wide<N, S>& lhs, const Bits<M, T>& rhs)                                            \
+{                                                                                                     \
+    return lhs op wide(rhs);                                                                          \
+}                                                                                                     \
+                                                                                                      \
+template<int N, typename S, int M, typename T>                                                        \
+inline typename detail::result<M, typename Bits<M, T>::sign_type, N, S>::type                        \
+operator op (const Bits<M, T>& lhs, const Wide<N, S>& rhs)                                            \
+{                                                                                                     \
+    return wide(lhs) op rhs;                                                                          \
+}
+
+EMATTSAN_BITS_DEFINE_WIDE_OP(+, WideSum)
+EMATTSAN_BITS_DEFINE_WIDE_OP(-, WideDifference)
+EMATTSAN_BITS_DEFINE_WIDE_OP(*, WideProduct)
+
+#undef EMATTSAN_BITS_DEFINE_WIDE_OP
+
+//----------------------------------------------------------------------
+
+template<int N, typename T, int M, typename U>
+Pack<Bits<N, T>, Bits<M, U> > operator , (Bits<N, T>& lhs, Bits<M, U>& rhs)
+{
+    return Pack<Bits<N, T>, Bits<M, U> >(lhs, rhs);
+}
 
 template<int N, typename T, int M>
 Pack<Bits<N, T>, void (*)(detail::Reserved<M>*)> operator , (Bits<N, T>& lhs, void (*rhs)(detail::Reserved<M>*))
@@ -1067,12 +2322,458 @@ ConstPack<Bits<N, T>, void (*)(detail::Reserved<M>*)> operator , (const Bits<N,
     return ConstPack<Bits<N, T>, void (*)(detail::Reserved<M>*)>(lhs, rhs);
 }
 
+template<int N, typename T, typename B, int HI, int LO>
+Pack<Bits<N, T>, BitSlice<B, HI, LO> > operator , (Bits<N, T>& lhs, const BitSlice<B, HI, LO>& rhs)
+{
+    return Pack<Bits<N, T>, BitSlice<B, HI, LO> >(lhs, rhs);
+}
+
+template<int N, typename T, typename B, int HI, int LO>
+ConstPack<Bits<N, T>, BitSlice<B, HI, LO> > operator , (const Bits<N, T>& lhs, const BitSlice<B, HI, LO>& rhs)
+{
+    return ConstPack<Bits<N, T>, BitSlice<B, HI, LO> >(lhs, rhs);
+}
+
 //----------------------------------------------------------------------
 
 template<int N> void reserve(detail::Reserved<N>*) {}
 
 //----------------------------------------------------------------------
 
+// bit utilities on the N bit sequence of Bits; a signed value counts as its N bit two's complement.
+// primitive values go through the builtins of unsigned long, which become POPCNT, LZCNT, TZCNT and
+// BSWAP given the matching -m flags, or through their shift and mask fallbacks without builtins;
+// MultiByte values are counted and moved block by block
+
+namespace detail
+{
+
+// only declaration; for error message when bswap is given bits which are not whole bytes
+template<bool VALID> struct ERROR__bswap_ONLY_CAN_USE_A_MULTIPLE_OF_8_BITS;
+template<>           struct ERROR__bswap_ONLY_CAN_USE_A_MULTIPLE_OF_8_BITS<true> { static const int value = 1; };
+
+typedef unsigned long BitWord;
+
+const int BitWordSize = std::numeric_limits<BitWord>::digits;
+
+// byte swap and bit reversal of a whole BitWord of L bits
+template<int L> struct WordOps;
+
+template<>
+struct WordOps<32>
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    static BitWord bswap(BitWord w)
+    {
+        return __builtin_bswap32(static_cast<unsigned int>(w));
+    }
+#endif
+
+#if defined(EMATTSAN_BITS_HAS_BITREVERSE)
+    static BitWord reverse(BitWord w)
+    {
+        return __builtin_bitreverse32(static_cast<unsigned int>(w));
+    }
+#endif
+};
+
+template<>
+struct WordOps<64>
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    static BitWord bswap(BitWord w)
+    {
+        return __builtin_bswap64(w);
+    }
+#endif
+
+#if defined(EMATTSAN_BITS_HAS_BITREVERSE)
+    static BitWord reverse(BitWord w)
+    {
+        return __builtin_bitreverse64(w);
+    }
+#endif
+};
+
+// the fields of s bits swapped in pairs; ~0 / (2^s + 1) is 0..01..1 repeated, s zeros and s ones
+inline BitWord swapFields(BitWord w, int s)
+{
+    const BitWord mask = ~static_cast<BitWord>(0) / ((static_cast<BitWord>(1) << s) + 1);
+    return ((w >> s) & mask) | ((w & mask) << s);
+}
+
+inline int popcountWord(BitWord w)
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    return __builtin_popcountl(w);
+#else
+    // counts of 2, 4 and 8 bits, then the bytes summed into the highest one
+    w = w - ((w >> 1) & (~static_cast<BitWord>(0) / 3));
+    w = (w & (~static_cast<BitWord>(0) / 5)) + ((w >> 2) & (~static_cast<BitWord>(0) / 5));
+    w = (w + (w >> 4)) & (~static_cast<BitWord>(0) / 17);
+    return static_cast<int>((w * (~static_cast<BitWord>(0) / 255)) >> (BitWordSize - 8));
+#endif
+}
+
+// w != 0
+inline int clzWord(BitWord w)
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    return __builtin_clzl(w);
+#else
+    int n = 0;
+    for(int s = BitWordSize / 2; s > 0; s /= 2)
+    {
+        if((w >> (BitWordSize - s)) == 0)
+        {
+            n += s;
+            w <<= s;
+        }
+    }
+    return n;
+#endif
+}
+
+// w != 0
+inline int ctzWord(BitWord w)
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    return __builtin_ctzl(w);
+#else
+    int n = 0;
+    for(int s = BitWordSize / 2; s > 0; s /= 2)
+    {
+        if((w & ((static_cast<BitWord>(1) << s) - 1)) == 0)
+        {
+            n += s;
+            w >>= s;
+        }
+    }
+    return n;
+#endif
+}
+
+inline BitWord bswapWord(BitWord w)
+{
+#if defined(EMATTSAN_BITS_HAS_BUILTINS)
+    return WordOps<BitWordSize>::bswap(w);
+#else
+    for(int s = 8; s < BitWordSize; s *= 2)
+    {
+        w = swapFields(w, s);
+    }
+    return w;
+#endif
+}
+
+inline BitWord reverseWord(BitWord w)
+{
+#if defined(EMATTSAN_BITS_HAS_BITREVERSE)
+    return WordOps<BitWordSize>::reverse(w);
+#else
+    // bytes swapped, then nibbles, pairs and bits of every byte
+    return swapFields(swapFields(swapFields(bswapWord(w), 4), 2), 1);
+#endif
+}
+
+// zero counts of an N bit word; below the width of BitWord a sentinel bit stops the count at N, so
+// that 0 needs no branch
+template<int N, bool FULL = (N == std::numeric_limits<BitWord>::digits)>
+struct ZeroCount
+{
+    static const int Spare = std::numeric_limits<BitWord>::digits - N;
+
+    static int leading(BitWord w)
+    {
+        return clzWord((w << Spare) | (static_cast<BitWord>(1) << (Spare - 1)));
+    }
+
+    static int trailing(BitWord w)
+    {
+        return ctzWord(w | (static_cast<BitWord>(1) << N));
+    }
+};
+
+template<int N>
+struct ZeroCount<N, true>
+{
+    static int leading(BitWord w)
+    {
+        return (w == 0) ? N : clzWord(w);
+    }
+
+    static int trailing(BitWord w)
+    {
+        return (w == 0) ? N : ctzWord(w);
+    }
+};
+
+// the utilities on an N bit sequence held in V; rotl takes 0 <= r < N
+template<typename V, int N>
+struct BitOps
+{
+    static const int Spare = std::numeric_limits<BitWord>::digits - N;
+
+    static BitWord word(V value)
+    {
+        return static_cast<BitWord>(static_cast<typename Traits<V>::unsigned_value_type>(value)) & Mask<BitWord, N>::value;
+    }
+
+    static int popcount(V value)
+    {
+        return popcountWord(word(value));
+    }
+
+    static int clz(V value)
+    {
+        return ZeroCount<N>::leading(word(value));
+    }
+
+    static int ctz(V value)
+    {
+        return ZeroCount<N>::trailing(word(value));
+    }
+
+    static V rotl(V value, int r)
+    {
+        const BitWord w = word(value);
+        return static_cast<V>(((w << r) | (w >> ((N - r) % N))) & Mask<BitWord, N>::value);
+    }
+
+    static V reverse(V value)
+    {
+        return static_cast<V>(reverseWord(word(value)) >> Spare);
+    }
+
+    static V bswap(V value)
+    {
+        return static_cast<V>(bswapWord(word(value)) >> Spare);
+    }
+};
+
+// value_[0] is the most significant block, and its Spare high bits are 0
+template<int N>
+struct BitOps<MultiByte<N>, N>
+{
+    typedef MultiByte<N>                  multibyte;
+    typedef typename multibyte::block_type block_type;
+
+    static const int BlockSize = multibyte::BlockSize;
+    static const int Length    = multibyte::Length;
+    static const int Spare     = multibyte::Capacity - N;
+
+    static int popcount(const multibyte& value)
+    {
+        int count = 0;
+        for(int k = 0; k < Length; ++k)
+        {
+            count += popcountWord(value.value_[k]);
+        }
+        return count;
+    }
+
+    static int clz(const multibyte& value)
+    {
+        for(int k = 0; k < Length; ++k)
+        {
+            if(value.value_[k] != 0)
+            {
+                return k * BlockSize + clzWord(value.value_[k]) - (BitWordSize - BlockSize) - Spare;
+            }
+        }
+        return N;
+    }
+
+    static int ctz(const multibyte& value)
+    {
+        for(int k = 0; k < Length; ++k)
+        {
+            if(value.value_[Length - k - 1] != 0)
+            {
+                return k * BlockSize + ctzWord(value.value_[Length - k - 1]);
+            }
+        }
+        return N;
+    }
+
+    static multibyte rotl(const multibyte& value, int r)
+    {
+        multibyte result;
+        move(result, r, value, 0, N - r);
+        move(result, 0, value, N - r, r);
+        return result;
+    }
+
+    static multibyte reverse(const multibyte& value)
+    {
+        multibyte reversed;
+        for(int k = 0; k < Length; ++k)
+        {
+            reversed.value_[k] = static_cast<block_type>(reverseWord(value.value_[Length - k - 1]) >> (BitWordSize - BlockSize));
+        }
+        multibyte result;
+        move(result, 0, reversed, Spare, N);
+        return result;
+    }
+
+    static multibyte bswap(const multibyte& value)
+    {
+        multibyte result;
+        for(int k = 0; k < Length; ++k)
+        {
+            result.value_[k] = value.value_[Length - k - 1];
+        }
+        return result;
+    }
+
+private:
+    // width bits of from at bit from_pos into to at bit to_pos
+    static void move(multibyte& to, int to_pos, const multibyte& from, int from_pos, int width)
+    {
+        for(int k = 0; k < width; k += BlockSize)
+        {
+            SliceBlock<multibyte>::put(to, to_pos + k, SliceBlock<multibyte>::at(from, from_pos + k), (width - k < BlockSize) ? width - k : BlockSize);
+        }
+    }
+};
+
+template<typename B>
+inline B fromSequence(typename B::const_arg_type value)
+{
+    B result;
+    result.setSequence(value);
+    return result;
+}
+
+} // namespace detail
+
+// the number of 1 bits
+template<int N, typename T>
+inline int popcount(const Bits<N, T>& bits)
+{
+    return detail::BitOps<typename Bits<N, T>::value_type, N>::popcount(bits.getSequence());
+}
+
+// the number of 0 bits above the highest 1 bit; N for 0
+template<int N, typename T>
+inline int clz(const Bits<N, T>& bits)
+{
+    return detail::BitOps<typename Bits<N, T>::value_type, N>::clz(bits.getSequence());
+}
+
+// the number of 0 bits below the lowest 1 bit; N for 0
+template<int N, typename T>
+inline int ctz(const Bits<N, T>& bits)
+{
+    return detail::BitOps<typename Bits<N, T>::value_type, N>::ctz(bits.getSequence());
+}
+
+// rotated n bits toward the most significant bit within N bits; n may be negative, or N or more
+template<int N, typename T>
+inline Bits<N, T> rotl(const Bits<N, T>& bits, int n)
+{
+    return detail::fromSequence<Bits<N, T> >(detail::BitOps<typename Bits<N, T>::value_type, N>::rotl(bits.getSequence(), ((n % N) + N) % N));
+}
+
+template<int N, typename T>
+inline Bits<N, T> rotr(const Bits<N, T>& bits, int n)
+{
+    return rotl(bits, -(n % N));
+}
+
+// bit N - 1 - i of the result is bit i
+template<int N, typename T>
+inline Bits<N, T> bitreverse(const Bits<N, T>& bits)
+{
+    return detail::fromSequence<Bits<N, T> >(detail::BitOps<typename Bits<N, T>::value_type, N>::reverse(bits.getSequence()));
+}
+
+// the bytes in reverse order; N is a multiple of 8
+template<int N, typename T>
+inline Bits<N, T> bswap(const Bits<N, T>& bits)
+{
+    typedef detail::BitOps<typename Bits<N, T>::value_type, N * detail::ERROR__bswap_ONLY_CAN_USE_A_MULTIPLE_OF_8_BITS<(N % 8) == 0>::value> ops;
+
+    return detail::fromSequence<Bits<N, T> >(ops::bswap(bits.getSequence()));
+}
+
+//----------------------------------------------------------------------
+
+#if defined(EMATTSAN_BITS_TRIM_TELEMETRY)
+
+namespace detail
+{
+
+// the container counting the trims of Bits<SIZE, T>
+template<int SIZE, typename T>
+struct CountedContainer
+{
+    typedef Container<SIZE, typename Bits<SIZE, T>::value_type> type;
+};
+
+template<int SIZE, typename S>
+struct CountedContainer<SIZE, Saturate<S> >
+{
+    typedef Container<SIZE, Saturate<S> > type;
+};
+
+} // namespace detail
+
+// define EMATTSAN_BITS_TRIM_TELEMETRY before including Bits.h to count the values which did not fit,
+// e.g. Bits<4, signed> s(8); // s => -8, counted.
+// the counts are per container type; Bits<N, T> share the counter of Bits<N, Bits<N, T>::value_type>.
+// Bits<N, Saturate<S> > count the values they clamp, apart from the wrapping types
+namespace telemetry
+{
+
+struct Record
+{
+    int           size;
+    int           capacity;
+    bool          isSigned;
+    bool          saturating;
+    unsigned long count;
+};
+
+// trims of Bits<SIZE, T> which changed the value, summed over all threads
+template<int SIZE, typename T>
+unsigned long trimmed()
+{
+    typedef typename detail::CountedContainer<SIZE, T>::type container;
+
+    return detail::TrimRegistry<>::total(detail::TrimCounter<container>::type);
+}
+
+template<int SIZE>
+unsigned long trimmed()
+{
+    return trimmed<SIZE, Unsigned>();
+}
+
+// calls f(const Record&) for every type which has trimmed a value since the start of the program
+template<typename F>
+F for_each(F f)
+{
+    for(const detail::TrimType* type = __atomic_load_n(&detail::TrimRegistry<>::types, __ATOMIC_ACQUIRE); type != 0; type = type->next)
+    {
+        const Record record = { type->size, type->capacity, type->isSigned, type->saturating, detail::TrimRegistry<>::total(*type) };
+        f(record);
+    }
+    return f;
+}
+
+// sets all counts to 0; trims of other threads running meanwhile may be lost
+inline void reset()
+{
+    detail::TrimRegistry<>::reset();
+}
+
+} // namespace telemetry
+
+#endif//EMATTSAN_BITS_TRIM_TELEMETRY
+
+//----------------------------------------------------------------------
+
 } // namespace bits
 
 //----------------------------------------------------------------------
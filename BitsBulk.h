@@ -0,0 +1,571 @@
+#ifndef EMATTSAN_BITS_BULK_H
+#define EMATTSAN_BITS_BULK_H
+
+//----------------------------------------------------------------------
+
+#include "Bits.h"
+
+#include <cstddef>
+
+// the saturating instructions of SSE2, and of AVX2 and AVX-512BW when they are available, compute 8 and 16
+// bit elements; define EMATTSAN_BITS_BULK_SCALAR to leave every element to the branch free scalar loop
+// instead, which the compiler may vectorize itself (see sample/bench/saturate_bench.cpp)
+#if !defined(EMATTSAN_BITS_BULK_SCALAR) && !defined(EMATTSAN_BITS_BULK_SSE2) && defined(__SSE2__)
+#define EMATTSAN_BITS_BULK_SSE2
+#endif
+
+#if !defined(EMATTSAN_BITS_BULK_SCALAR) && !defined(EMATTSAN_BITS_BULK_AVX2) && defined(__AVX2__)
+#define EMATTSAN_BITS_BULK_AVX2
+#endif
+
+#if !defined(EMATTSAN_BITS_BULK_SCALAR) && !defined(EMATTSAN_BITS_BULK_AVX512) && defined(__AVX512BW__)
+#define EMATTSAN_BITS_BULK_AVX512
+#endif
+
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(EMATTSAN_BITS_BULK_AVX2) || defined(EMATTSAN_BITS_BULK_AVX512)
+#include <immintrin.h>
+#endif
+
+//----------------------------------------------------------------------
+
+namespace emattsan
+{
+
+//----------------------------------------------------------------------
+
+namespace bits
+{
+
+//----------------------------------------------------------------------
+
+// + - * of Bits<N, Saturate<S> > over arrays of their values, each held in the type a Bits<N, Saturate<S> >
+// stores it in (Element<N, S>::type); result[i] is the value of Bits<N, Saturate<S> >(lhs[i]) op Bits<N, Saturate<S> >(rhs[i]).
+// values of 8 or 16 bit elements are computed 64 or 32 at a time with the saturating instructions of AVX-512BW,
+// 32 or 16 at a time with those of AVX2, 16 or 8 at a time with those of SSE2, the rest one at a time,
+// with the branch free clamps of Bits. result may be lhs or rhs, but may not overlap them otherwise
+
+namespace bulk
+{
+
+template<int N, typename S>
+struct Element
+{
+    typedef typename detail::Container<N, Saturate<S> >::storage_type type;
+};
+
+} // namespace bulk
+
+//----------------------------------------------------------------------
+
+namespace detail
+{
+
+struct BulkAdd
+{
+    template<typename B> static B apply(const B& lhs, const B& rhs) { return lhs + rhs; }
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+    template<typename K> static typename K::vector apply(const K& lanes, typename K::vector lhs, typename K::vector rhs) { return lanes.add(lhs, rhs); }
+#endif
+};
+
+struct BulkSub
+{
+    template<typename B> static B apply(const B& lhs, const B& rhs) { return lhs - rhs; }
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+    template<typename K> static typename K::vector apply(const K& lanes, typename K::vector lhs, typename K::vector rhs) { return lanes.sub(lhs, rhs); }
+#endif
+};
+
+struct BulkMul
+{
+    template<typename B> static B apply(const B& lhs, const B& rhs) { return lhs * rhs; }
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+    template<typename K> static typename K::vector apply(const K& lanes, typename K::vector lhs, typename K::vector rhs) { return lanes.mul(lhs, rhs); }
+#endif
+};
+
+// one element at a time
+template<typename OP, int N, typename S, typename V>
+inline void bulk_scalar(const V* lhs, const V* rhs, V* result, std::size_t count)
+{
+    typedef Bits<N, Saturate<typename Sign<S, S>::sign_type> > bits;
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = static_cast<V>(OP::apply(bits(lhs[i]), bits(rhs[i])).get());
+    }
+}
+
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+
+// lanes of N bit values in elements of V in a vector of BITS bits; operands are clamped before they are given
+template<int N, typename V, int BITS> class BulkLanes;
+
+template<int BITS> struct BulkMemory;
+
+template<>
+struct BulkMemory<128>
+{
+    typedef __m128i vector;
+
+    template<typename V> static __m128i load(const V* p)           { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    template<typename V> static void    store(V* p, __m128i value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), value); }
+};
+
+template<int N>
+class BulkLanes<N, signed short, 128>
+{
+public:
+    typedef __m128i vector;
+
+    BulkLanes() : min_(_mm_set1_epi16(static_cast<short>(Container<N, Saturate<Signed> >::min))),
+                  max_(_mm_set1_epi16(static_cast<short>(Container<N, Saturate<Signed> >::max)))
+    {
+    }
+
+    __m128i clamp(__m128i x) const
+    {
+        return _mm_min_epi16(_mm_max_epi16(x, min_), max_);
+    }
+
+    __m128i add(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_adds_epi16(lhs, rhs));
+    }
+
+    __m128i sub(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_subs_epi16(lhs, rhs));
+    }
+
+    // 32 bit products, packed with saturation to 16 bits
+    __m128i mul(__m128i lhs, __m128i rhs) const
+    {
+        const __m128i low  = _mm_mullo_epi16(lhs, rhs);
+        const __m128i high = _mm_mulhi_epi16(lhs, rhs);
+        return clamp(_mm_packs_epi32(_mm_unpacklo_epi16(low, high), _mm_unpackhi_epi16(low, high)));
+    }
+
+private:
+    __m128i min_;
+    __m128i max_;
+};
+
+template<int N>
+class BulkLanes<N, unsigned short, 128>
+{
+public:
+    typedef __m128i vector;
+
+    BulkLanes() : max_(_mm_set1_epi16(static_cast<short>(Container<N, Saturate<Unsigned> >::max)))
+    {
+    }
+
+    // min(x, max) without SSE4.1: x - (x -sat max)
+    __m128i clamp(__m128i x) const
+    {
+        return _mm_sub_epi16(x, _mm_subs_epu16(x, max_));
+    }
+
+    __m128i add(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_adds_epu16(lhs, rhs));
+    }
+
+    __m128i sub(__m128i lhs, __m128i rhs) const
+    {
+        return _mm_subs_epu16(lhs, rhs);
+    }
+
+    // a product with high bits saturates to all ones
+    __m128i mul(__m128i lhs, __m128i rhs) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i over = _mm_xor_si128(_mm_cmpeq_epi16(_mm_mulhi_epu16(lhs, rhs), zero), _mm_cmpeq_epi16(zero, zero));
+        return clamp(_mm_or_si128(_mm_mullo_epi16(lhs, rhs), over));
+    }
+
+private:
+    __m128i max_;
+};
+
+template<int N>
+class BulkLanes<N, signed char, 128>
+{
+public:
+    typedef __m128i vector;
+
+    BulkLanes() : min_(_mm_set1_epi8(static_cast<char>(Container<N, Saturate<Signed> >::min ^ Bias))),
+                  max_(_mm_set1_epi8(static_cast<char>(Container<N, Saturate<Signed> >::max ^ Bias))),
+                  bias_(_mm_set1_epi8(static_cast<char>(Bias)))
+    {
+    }
+
+    // SSE2 has min and max of unsigned bytes only; biased values compare as signed ones
+    __m128i clamp(__m128i x) const
+    {
+        return _mm_xor_si128(_mm_min_epu8(_mm_max_epu8(_mm_xor_si128(x, bias_), min_), max_), bias_);
+    }
+
+    __m128i add(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_adds_epi8(lhs, rhs));
+    }
+
+    __m128i sub(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_subs_epi8(lhs, rhs));
+    }
+
+    // 16 bit products, which do not overflow, packed with saturation to 8 bits
+    __m128i mul(__m128i lhs, __m128i rhs) const
+    {
+        const __m128i low  = _mm_mullo_epi16(widen(_mm_unpacklo_epi8(lhs, lhs)), widen(_mm_unpacklo_epi8(rhs, rhs)));
+        const __m128i high = _mm_mullo_epi16(widen(_mm_unpackhi_epi8(lhs, lhs)), widen(_mm_unpackhi_epi8(rhs, rhs)));
+        return clamp(_mm_packs_epi16(low, high));
+    }
+
+private:
+    static const int Bias = 0x80;
+
+    // a byte doubled into a 16 bit lane, sign extended
+    static __m128i widen(__m128i doubled)
+    {
+        return _mm_srai_epi16(doubled, 8);
+    }
+
+    __m128i min_;
+    __m128i max_;
+    __m128i bias_;
+};
+
+template<int N>
+class BulkLanes<N, unsigned char, 128>
+{
+public:
+    typedef __m128i vector;
+
+    BulkLanes() : max_(_mm_set1_epi8(static_cast<char>(Container<N, Saturate<Unsigned> >::max))),
+                  byte_(_mm_set1_epi16(0xff))
+    {
+    }
+
+    __m128i clamp(__m128i x) const
+    {
+        return _mm_min_epu8(x, max_);
+    }
+
+    __m128i add(__m128i lhs, __m128i rhs) const
+    {
+        return clamp(_mm_adds_epu8(lhs, rhs));
+    }
+
+    __m128i sub(__m128i lhs, __m128i rhs) const
+    {
+        return _mm_subs_epu8(lhs, rhs);
+    }
+
+    // 16 bit products, clamped to a byte before packing, since packus_epi16 takes signed words
+    __m128i mul(__m128i lhs, __m128i rhs) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low  = _mm_mullo_epi16(_mm_unpacklo_epi8(lhs, zero), _mm_unpacklo_epi8(rhs, zero));
+        const __m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(lhs, zero), _mm_unpackhi_epi8(rhs, zero));
+        return clamp(_mm_packus_epi16(_mm_sub_epi16(low, _mm_subs_epu16(low, byte_)), _mm_sub_epi16(high, _mm_subs_epu16(high, byte_))));
+    }
+
+private:
+    __m128i max_;
+    __m128i byte_;
+};
+
+#endif//EMATTSAN_BITS_BULK_SSE2
+
+// the lanes above in BITS bits (256: AVX2, 512: AVX-512BW), with min and max of signed bytes, which SSE2
+// lacks; unpack and pack work within each 128 bit part, so the products stay in order. an unsigned 16 bit
+// product with high bits saturates to all ones: 0 - min(high, 1)
+#define EMATTSAN_BITS_DEFINE_BULK_LANES(BITS)                                                                      \
+                                                                                                                   \
+template<>                                                                                                         \
+struct BulkMemory<BITS>                                                                                            \
+{                                                                                                                  \
+    typedef __m##BITS##i vector;                                                                                   \
+                                                                                                                   \
+    template<typename V> static vector load(const V* p)          { return _mm##BITS##_loadu_si##BITS(reinterpret_cast<const vector*>(p)); } \
+    template<typename V> static void   store(V* p, vector value) { _mm##BITS##_storeu_si##BITS(reinterpret_cast<vector*>(p), value); } \
+};                                                                                                                 \
+                                                                                                                   \
+template<int N>                                                                                                    \
+class BulkLanes<N, signed short, BITS>                                                                             \
+{                                                                                                                  \
+public:                                                                                                            \
+    typedef __m##BITS##i vector;                                                                                   \
+                                                                                                                   \
+    BulkLanes() : min_(_mm##BITS##_set1_epi16(static_cast<short>(Container<N, Saturate<Signed> >::min))),          \
+                  max_(_mm##BITS##_set1_epi16(static_cast<short>(Container<N, Saturate<Signed> >::max)))           \
+    {                                                                                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    vector clamp(vector x) const                                                                                   \
+    {                                                                                                              \
+        return _mm##BITS##_min_epi16(_mm##BITS##_max_epi16(x, min_), max_);                                        \
+    }                                                                                                              \
+                                                                                                                   \
+    vector add(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_adds_epi16(lhs, rhs));                                                            \
+    }                                                                                                              \
+                                                                                                                   \
+    vector sub(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_subs_epi16(lhs, rhs));                                                            \
+    }                                                                                                              \
+                                                                                                                   \
+    vector mul(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        const vector low  = _mm##BITS##_mullo_epi16(lhs, rhs);                                                     \
+        const vector high = _mm##BITS##_mulhi_epi16(lhs, rhs);                                                     \
+        return clamp(_mm##BITS##_packs_epi32(_mm##BITS##_unpacklo_epi16(low, high), _mm##BITS##_unpackhi_epi16(low, high))); \
+    }                                                                                                              \
+                                                                                                                   \
+private:                                                                                                           \
+    vector min_;                                                                                                   \
+    vector max_;                                                                                                   \
+};                                                                                                                 \
+                                                                                                                   \
+template<int N>                                                                                                    \
+class BulkLanes<N, unsigned short, BITS>                                                                           \
+{                                                                                                                  \
+public:                                                                                                            \
+    typedef __m##BITS##i vector;                                                                                   \
+                                                                                                                   \
+    BulkLanes() : max_(_mm##BITS##_set1_epi16(static_cast<short>(Container<N, Saturate<Unsigned> >::max))),        \
+                  one_(_mm##BITS##_set1_epi16(1))                                                                  \
+    {                                                                                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    vector clamp(vector x) const                                                                                   \
+    {                                                                                                              \
+        return _mm##BITS##_min_epu16(x, max_);                                                                     \
+    }                                                                                                              \
+                                                                                                                   \
+    vector add(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_adds_epu16(lhs, rhs));                                                            \
+    }                                                                                                              \
+                                                                                                                   \
+    vector sub(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return _mm##BITS##_subs_epu16(lhs, rhs);                                                                   \
+    }                                                                                                              \
+                                                                                                                   \
+    vector mul(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        const vector over = _mm##BITS##_sub_epi16(_mm##BITS##_setzero_si##BITS(), _mm##BITS##_min_epu16(_mm##BITS##_mulhi_epu16(lhs, rhs), one_)); \
+        return clamp(_mm##BITS##_or_si##BITS(_mm##BITS##_mullo_epi16(lhs, rhs), over));                            \
+    }                                                                                                              \
+                                                                                                                   \
+private:                                                                                                           \
+    vector max_;                                                                                                   \
+    vector one_;                                                                                                   \
+};                                                                                                                 \
+                                                                                                                   \
+template<int N>                                                                                                    \
+class BulkLanes<N, signed char, BITS>                                                                              \
+{                                                                                                                  \
+public:                                                                                                            \
+    typedef __m##BITS##i vector;                                                                                   \
+                                                                                                                   \
+    BulkLanes() : min_(_mm##BITS##_set1_epi8(static_cast<char>(Container<N, Saturate<Signed> >::min))),            \
+                  max_(_mm##BITS##_set1_epi8(static_cast<char>(Container<N, Saturate<Signed> >::max)))             \
+    {                                                                                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    vector clamp(vector x) const                                                                                   \
+    {                                                                                                              \
+        return _mm##BITS##_min_epi8(_mm##BITS##_max_epi8(x, min_), max_);                                          \
+    }                                                                                                              \
+                                                                                                                   \
+    vector add(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_adds_epi8(lhs, rhs));                                                             \
+    }                                                                                                              \
+                                                                                                                   \
+    vector sub(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_subs_epi8(lhs, rhs));                                                             \
+    }                                                                                                              \
+                                                                                                                   \
+    vector mul(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        const vector low  = _mm##BITS##_mullo_epi16(widen(_mm##BITS##_unpacklo_epi8(lhs, lhs)), widen(_mm##BITS##_unpacklo_epi8(rhs, rhs))); \
+        const vector high = _mm##BITS##_mullo_epi16(widen(_mm##BITS##_unpackhi_epi8(lhs, lhs)), widen(_mm##BITS##_unpackhi_epi8(rhs, rhs))); \
+        return clamp(_mm##BITS##_packs_epi16(low, high));                                                          \
+    }                                                                                                              \
+                                                                                                                   \
+private:                                                                                                           \
+    static vector widen(vector doubled)                                                                            \
+    {                                                                                                              \
+        return _mm##BITS##_srai_epi16(doubled, 8);                                                                 \
+    }                                                                                                              \
+                                                                                                                   \
+    vector min_;                                                                                                   \
+    vector max_;                                                                                                   \
+};                                                                                                                 \
+                                                                                                                   \
+template<int N>                                                                                                    \
+class BulkLanes<N, unsigned char, BITS>                                                                            \
+{                                                                                                                  \
+public:                                                                                                            \
+    typedef __m##BITS##i vector;                                                                                   \
+                                                                                                                   \
+    BulkLanes() : max_(_mm##BITS##_set1_epi8(static_cast<char>(Container<N, Saturate<Unsigned> >::max))),          \
+                  byte_(_mm##BITS##_set1_epi16(0xff))                                                              \
+    {                                                                                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    vector clamp(vector x) const                                                                                   \
+    {                                                                                                              \
+        return _mm##BITS##_min_epu8(x, max_);                                                                      \
+    }                                                                                                              \
+                                                                                                                   \
+    vector add(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return clamp(_mm##BITS##_adds_epu8(lhs, rhs));                                                             \
+    }                                                                                                              \
+                                                                                                                   \
+    vector sub(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        return _mm##BITS##_subs_epu8(lhs, rhs);                                                                    \
+    }                                                                                                              \
+                                                                                                                   \
+    vector mul(vector lhs, vector rhs) const                                                                       \
+    {                                                                                                              \
+        const vector zero = _mm##BITS##_setzero_si##BITS();                                                        \
+        const vector low  = _mm##BITS##_mullo_epi16(_mm##BITS##_unpacklo_epi8(lhs, zero), _mm##BITS##_unpacklo_epi8(rhs, zero)); \
+        const vector high = _mm##BITS##_mullo_epi16(_mm##BITS##_unpackhi_epi8(lhs, zero), _mm##BITS##_unpackhi_epi8(rhs, zero)); \
+        return clamp(_mm##BITS##_packus_epi16(_mm##BITS##_min_epu16(low, byte_), _mm##BITS##_min_epu16(high, byte_))); \
+    }                                                                                                              \
+                                                                                                                   \
+private:                                                                                                           \
+    vector max_;                                                                                                   \
+    vector byte_;                                                                                                  \
+};
+
+#if defined(EMATTSAN_BITS_BULK_AVX2)
+EMATTSAN_BITS_DEFINE_BULK_LANES(256)
+#endif
+
+#if defined(EMATTSAN_BITS_BULK_AVX512)
+EMATTSAN_BITS_DEFINE_BULK_LANES(512)
+#endif
+
+#undef EMATTSAN_BITS_DEFINE_BULK_LANES
+
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+
+// the elements of whole vectors of BITS bits from I on; returns up to where
+template<int BITS, typename OP, int N, typename V>
+inline std::size_t bulk_lanes(const V* lhs, const V* rhs, V* result, std::size_t i, std::size_t count)
+{
+    typedef BulkMemory<BITS>         memory;
+    typedef typename memory::vector  vector;
+
+    static const std::size_t Lanes = sizeof(vector) / sizeof(V);
+
+    const BulkLanes<N, V, BITS> lanes;
+
+    for(; i + Lanes <= count; i += Lanes)
+    {
+        const vector l = lanes.clamp(memory::load(lhs + i));
+        const vector r = lanes.clamp(memory::load(rhs + i));
+        memory::store(result + i, OP::apply(lanes, l, r));
+    }
+    return i;
+}
+
+// the elements of whole vectors, the widest first; returns how many
+template<typename OP, int N, typename V>
+inline std::size_t bulk_vector(const V* lhs, const V* rhs, V* result, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(EMATTSAN_BITS_BULK_AVX512)
+    i = bulk_lanes<512, OP, N>(lhs, rhs, result, i, count);
+#endif
+#if defined(EMATTSAN_BITS_BULK_AVX2)
+    i = bulk_lanes<256, OP, N>(lhs, rhs, result, i, count);
+#endif
+    return bulk_lanes<128, OP, N>(lhs, rhs, result, i, count);
+}
+
+#endif//EMATTSAN_BITS_BULK_SSE2
+
+template<typename OP, int N, typename V>
+struct BulkVector
+{
+    static std::size_t run(const V*, const V*, V*, std::size_t)
+    {
+        return 0;
+    }
+};
+
+#if defined(EMATTSAN_BITS_BULK_SSE2)
+
+template<typename OP, int N> struct BulkVector<OP, N, signed short>   { static std::size_t run(const signed short*   lhs, const signed short*   rhs, signed short*   result, std::size_t count) { return bulk_vector<OP, N>(lhs, rhs, result, count); } };
+template<typename OP, int N> struct BulkVector<OP, N, unsigned short> { static std::size_t run(const unsigned short* lhs, const unsigned short* rhs, unsigned short* result, std::size_t count) { return bulk_vector<OP, N>(lhs, rhs, result, count); } };
+template<typename OP, int N> struct BulkVector<OP, N, signed char>    { static std::size_t run(const signed char*    lhs, const signed char*    rhs, signed char*    result, std::size_t count) { return bulk_vector<OP, N>(lhs, rhs, result, count); } };
+template<typename OP, int N> struct BulkVector<OP, N, unsigned char>  { static std::size_t run(const unsigned char*  lhs, const unsigned char*  rhs, unsigned char*  result, std::size_t count) { return bulk_vector<OP, N>(lhs, rhs, result, count); } };
+
+#endif//EMATTSAN_BITS_BULK_SSE2
+
+template<typename OP, int N, typename S>
+inline void bulk(const typename bulk::Element<N, S>::type* lhs, const typename bulk::Element<N, S>::type* rhs, typename bulk::Element<N, S>::type* result, std::size_t count)
+{
+    typedef typename bulk::Element<N, S>::type value_type;
+
+    const std::size_t done = BulkVector<OP, N, value_type>::run(lhs, rhs, result, count);
+    bulk_scalar<OP, N, S>(lhs + done, rhs + done, result + done, count - done);
+}
+
+} // namespace detail
+
+//----------------------------------------------------------------------
+
+namespace bulk
+{
+
+template<int N, typename S>
+inline void add(const typename Element<N, S>::type* lhs, const typename Element<N, S>::type* rhs, typename Element<N, S>::type* result, std::size_t count)
+{
+    detail::bulk<detail::BulkAdd, N, S>(lhs, rhs, result, count);
+}
+
+template<int N, typename S>
+inline void sub(const typename Element<N, S>::type* lhs, const typename Element<N, S>::type* rhs, typename Element<N, S>::type* result, std::size_t count)
+{
+    detail::bulk<detail::BulkSub, N, S>(lhs, rhs, result, count);
+}
+
+template<int N, typename S>
+inline void mul(const typename Element<N, S>::type* lhs, const typename Element<N, S>::type* rhs, typename Element<N, S>::type* result, std::size_t count)
+{
+    detail::bulk<detail::BulkMul, N, S>(lhs, rhs, result, count);
+}
+
+} // namespace bulk
+
+//----------------------------------------------------------------------
+
+} // namespace bits
+
+//----------------------------------------------------------------------
+
+} // namespace emattsan
+
+//----------------------------------------------------------------------
+
+#endif//EMATTSAN_BITS_BULK_H
@@ -35,6 +35,29 @@ void test()
 
     Bits<std::numeric_limits<unsigned char>::digits, signed char> s10; // OK
 //    Bits<std::numeric_limits<unsigned char>::digits + 1, unsigned char> s11; // compile error: can not use greater than container's digits size
+
+    Wide<std::numeric_limits<unsigned long>::digits> w1; // OK
+//    Wide<std::numeric_limits<unsigned long>::digits + 1> w2; // compile error: can not use greater than unsigned long's digits size
+
+    Wide<5> w3(u1); // OK
+//    Wide<5> w4(s1);         // compile error: a signed value does not fit in Wide<5, Unsigned>
+//    Wide<1, Signed> w5(u1); // compile error: an unsigned 1 bit value needs Wide<2, Signed>
+
+    Bits<std::numeric_limits<long>::digits / 2 + 1, Saturate<signed> > a1(1); // OK
+//    Bits<std::numeric_limits<long>::digits / 2 + 2, Saturate<signed> > a2(1); // compile error: a product of two values must fit in long
+    Bits<std::numeric_limits<long>::digits / 2, Saturate<unsigned> > a4(1); // OK
+//    Bits<std::numeric_limits<long>::digits / 2 + 1, Saturate<unsigned> > a5(1); // compile error: a product of two values must fit in long
+//    Bits<4> a3(lazy(Bits<4, Saturate<signed> >()) + u1); // compile error: lazy expressions wrap
+
+    Bits<40> m1(lazy(Bits<40>()) + Bits<40>()); // OK
+//    Bits<40> m2(lazy(Bits<40>()) * Bits<40>()); // compile error: a lazy product of MultiByte values is not computed
+
+    u4.slice<31, 0>() = 1; // OK
+//    u4.slice<32, 0>() = 1; // compile error: can not slice beyond the bits
+//    u4.slice<3, 4>() = 1;  // compile error: can not slice from lower to higher bit
+
+    bswap(Bits<24>()); // OK
+//    bswap(Bits<12>()); // compile error: can not swap the bytes of bits which are not whole bytes
 }
 
 int main(int, char* [])
@@ -0,0 +1,192 @@
+// compile: g++ -Wall -o BitsTelemetryTest BitsTelemetryTest.cpp -lgtest -lpthread
+// need Google Test (see: http://code.google.com/p/googletest/ )
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+
+#define EMATTSAN_BITS_TRIM_TELEMETRY
+#include "Bits.h"
+
+using namespace emattsan::bits;
+
+class TrimTelemetryTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        telemetry::reset();
+    }
+};
+
+// 値が変わらない切り詰めは数えないこと
+TEST_F(TrimTelemetryTest, UnchangedTest)
+{
+    Bits<4, signed> s(7);
+    s = -8;
+    s = -1;
+
+    Bits<4> u(15);
+    u = 0;
+
+    ASSERT_EQ(0u, (telemetry::trimmed<4, signed>()));
+    ASSERT_EQ(0u, telemetry::trimmed<4>());
+}
+
+// 値が変わった切り詰めを型ごとに数えること
+TEST_F(TrimTelemetryTest, ChangedTest)
+{
+    Bits<4, signed> s(8);
+    ASSERT_EQ(-8, s.get());
+    s = 15;
+    ASSERT_EQ(-1, s.get());
+
+    Bits<4> u(16);
+    ASSERT_EQ(0, u.get());
+
+    ASSERT_EQ(2u, (telemetry::trimmed<4, signed>()));
+    ASSERT_EQ(1u, telemetry::trimmed<4>());
+    ASSERT_EQ(0u, telemetry::trimmed<5>());
+}
+
+// 演算のあふれも数えること
+TEST_F(TrimTelemetryTest, OverflowTest)
+{
+    Bits<4> u(15);
+    ++u;
+    ASSERT_EQ(0, u.get());
+
+    Bits<4> v(u - Bits<4>(1));
+    ASSERT_EQ(15, v.get());
+
+    v <<= 1;
+    ASSERT_EQ(14, v.get());
+
+    ASSERT_EQ(3u, telemetry::trimmed<4>());
+}
+
+// 多バイトのビット列も数えること
+TEST_F(TrimTelemetryTest, MultiByteTest)
+{
+    typedef Bits<36>::value_type multibyte;
+
+    multibyte m;
+    m.value_[0] = 0x0f;
+    Bits<36> b1(m);
+    ASSERT_EQ(0u, telemetry::trimmed<36>());
+
+    m.value_[0] = 0xff;
+    Bits<36> b2(m);
+    ASSERT_EQ(0x0f, b2.get().value_[0]);
+    ASSERT_EQ(1u, telemetry::trimmed<36>());
+}
+
+namespace
+{
+
+struct SaturateCollect
+{
+    int           types;
+    unsigned long count;
+
+    void operator () (const telemetry::Record& record)
+    {
+        if((record.size == 6) && record.saturating)
+        {
+            ++types;
+            count += record.count;
+        }
+    }
+};
+
+} // namespace
+
+// 飽和した値を、折り返す型とは別に数えること
+TEST_F(TrimTelemetryTest, SaturateTest)
+{
+    Bits<6, Saturate<signed> > s(31);
+    s = -32;
+    ASSERT_EQ(0u, (telemetry::trimmed<6, Saturate<signed> >()));
+
+    s = 100;
+    ASSERT_EQ(31, s.get());
+    s += 1;
+    ASSERT_EQ(31, s.get());
+
+    Bits<6, Saturate<unsigned> > u(-1);
+    ASSERT_EQ(0, u.get());
+    --u;
+
+    ASSERT_EQ(2u, (telemetry::trimmed<6, Saturate<signed> >()));
+    ASSERT_EQ(2u, (telemetry::trimmed<6, Saturate<unsigned> >()));
+    ASSERT_EQ(0u, (telemetry::trimmed<6, signed>()));
+    ASSERT_EQ(0u, telemetry::trimmed<6>());
+
+    SaturateCollect collect = { 0, 0 };
+    collect = telemetry::for_each(collect);
+    ASSERT_EQ(2, collect.types);
+    ASSERT_EQ(4u, collect.count);
+}
+
+namespace
+{
+
+const int TrimsPerThread = 1000;
+
+void* trim_in_thread(void*)
+{
+    for(int i = 0; i < TrimsPerThread; ++i)
+    {
+        Bits<5> u(32 + i % 32);
+    }
+    return 0;
+}
+
+struct Collect
+{
+    int           types;
+    unsigned long count;
+
+    void operator () (const telemetry::Record& record)
+    {
+        if((record.size == 5) && !record.isSigned)
+        {
+            ++types;
+            count += record.count;
+        }
+    }
+};
+
+} // namespace
+
+// スレッドごとに数え、終了したスレッドの分も合計されること
+TEST_F(TrimTelemetryTest, ThreadTest)
+{
+    const int ThreadCount = 4;
+
+    pthread_t threads[ThreadCount];
+    for(int i = 0; i < ThreadCount; ++i)
+    {
+        ASSERT_EQ(0, pthread_create(&threads[i], 0, trim_in_thread, 0));
+    }
+    for(int i = 0; i < ThreadCount; ++i)
+    {
+        ASSERT_EQ(0, pthread_join(threads[i], 0));
+    }
+
+    ASSERT_EQ(static_cast<unsigned long>(ThreadCount * TrimsPerThread), telemetry::trimmed<5>());
+
+    Collect collect = { 0, 0 };
+    collect = telemetry::for_each(collect);
+    ASSERT_EQ(1, collect.types);
+    ASSERT_EQ(static_cast<unsigned long>(ThreadCount * TrimsPerThread), collect.count);
+
+    telemetry::reset();
+    ASSERT_EQ(0u, telemetry::trimmed<5>());
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
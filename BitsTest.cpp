@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include "Bits.h"
+#include "BitsBulk.h"
 
 using namespace emattsan::bits;
 
@@ -2349,6 +2350,606 @@ TEST(ContaminationTest, Test1)
     c = (a, b);
 }
 
+// 遅延評価の式が、演算子ごとに切り詰める式と同じ結果になること
+TEST(LazyTest, SameAsEagerTest)
+{
+    for(int i = 0; i < 16; ++i)
+    {
+        for(int j = 0; j < 16; ++j)
+        {
+            for(int k = 0; k < 8; ++k)
+            {
+                const Bits<4, signed> a(i);
+                const Bits<4>         b(j);
+                const Bits<3>         c(k);
+                const Bits<5, signed> d(i * 2 + k);
+
+                ASSERT_EQ((a * b + c * d - a).get(), Bits<5>(lazy(a) * b + lazy(c) * d - a).get());
+                ASSERT_EQ((a * a + d).get(),         (Bits<5, signed>(lazy(a) * a + d).get()));
+                ASSERT_EQ(((a ^ b) | (c & d)).get(), Bits<5>((lazy(a) ^ b) | (lazy(c) & d)).get());
+                ASSERT_EQ((c - a - b).get(),         Bits<4>(lazy(c) - a - b).get());
+            }
+        }
+    }
+}
+
+// 除算と剰余は切り詰めた値で計算すること
+TEST(LazyTest, DivideTest)
+{
+    for(int i = 0; i < 16; ++i)
+    {
+        for(int j = 1; j < 16; ++j)
+        {
+            const Bits<4, signed> a(i);
+            const Bits<4, signed> b(j);
+            const Bits<6, signed> c(i * 3);
+
+            ASSERT_EQ((a * a / b).get(), (Bits<4, signed>(lazy(a) * a / b).get()));
+            ASSERT_EQ((c % b + a).get(), (Bits<6, signed>(lazy(c) % b + a).get()));
+            ASSERT_EQ((a - c / b).get(), (Bits<6, signed>(lazy(a) - c / lazy(b)).get()));
+        }
+    }
+}
+
+// 整数との演算、代入と変換で切り詰めること
+TEST(LazyTest, AssignTest)
+{
+    Bits<8>         a(200);
+    Bits<8>         b(3);
+    Bits<4>         r;
+    Bits<4, signed> s(7);
+
+    r = lazy(a) * b + 1;
+    ASSERT_EQ(Bits<4>(a * b + 1).get(), r.get());
+
+    s = lazy(s) + 1u;
+    ASSERT_EQ(-8, s.get());
+
+    int n = lazy(a) + b;
+    ASSERT_EQ(203, n);
+
+    n = 2 * lazy(a);
+    ASSERT_EQ(144, n);
+}
+
+// 多バイトのビット列のビット演算を、ブロックごとに計算すること
+TEST(LazyTest, MultiByteTest)
+{
+    Bits<36>        m;
+    Bits<8>         u(0xf0);
+    Bits<8, signed> s(-1);
+
+    Bits<36> r1((lazy(m) | u) ^ s);
+    ASSERT_EQ(0x0f, r1.get().value_[0]);
+    ASSERT_EQ(0xff, r1.get().value_[1]);
+    ASSERT_EQ(0x0f, r1.get().value_[4]);
+
+    Bits<36> r2(lazy(r1) & u);
+    ASSERT_EQ(0x00, r2.get().value_[0]);
+    ASSERT_EQ(0x00, r2.get().value_[3]);
+    ASSERT_EQ(0x00, r2.get().value_[4]);
+
+    Bits<36> r3((lazy(r1) ^ r1) | u);
+    ASSERT_EQ(0x00, r3.get().value_[0]);
+    ASSERT_EQ(0xf0, r3.get().value_[4]);
+}
+
+// 多バイトのビット列の加算・減算で、桁上がり・桁借りがブロックをまたぐこと
+TEST(LazyTest, MultiByteCarryTest)
+{
+    Bits<40> a;
+    Bits<40> b;
+    a.slice<7, 0>() = 0xff;
+    b.slice<7, 0>() = 0x01;
+
+    Bits<40> sum(lazy(a) + b);
+    ASSERT_EQ(0x00, sum.get().value_[4]);
+    ASSERT_EQ(0x01, sum.get().value_[3]);
+    ASSERT_EQ(0x00, sum.get().value_[0]);
+
+    Bits<40> difference(lazy(b) - a);
+    ASSERT_EQ(0x02, difference.get().value_[4]);
+    ASSERT_EQ(0xff, difference.get().value_[3]);
+    ASSERT_EQ(0xff, difference.get().value_[0]);
+
+    // 0xffffffffff + 1 は 0 に、0 - 1 は 0xffffffffff になる
+    Bits<40> ones(lazy(difference) | a);
+    Bits<40> wrapped(lazy(ones) + Bits<8>(1));
+    for(int i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(0x00, wrapped.get().value_[i]);
+    }
+    Bits<40> borrowed(lazy(wrapped) - Bits<8>(1));
+    for(int i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(0xff, borrowed.get().value_[i]);
+    }
+
+    // 入れ子の式でも、桁上がりは下のブロックから伝わる
+    Bits<40> nested((lazy(a) + b) - (lazy(b) - a));
+    ASSERT_EQ(0xfe, nested.get().value_[4]);
+    ASSERT_EQ(0x01, nested.get().value_[3]);
+    ASSERT_EQ(0x00, nested.get().value_[2]);
+}
+
+// 値の範囲から演算結果のビット数が決まること
+TEST(WideTest, SizeTest)
+{
+    Bits<5>         u;
+    Bits<3>         v;
+    Bits<5, signed> s;
+
+    ASSERT_EQ(6,  (wide(u) + u).size());
+    ASSERT_EQ(6,  (wide(u) + v).size());
+    ASSERT_EQ(10, (wide(u) * u).size());
+    ASSERT_EQ(8,  (wide(u) * v).size());
+    ASSERT_EQ(6,  (wide(u) - u).size());
+    ASSERT_EQ(7,  (wide(s) + u).size());
+    ASSERT_EQ(10, (wide(s) * u).size());
+    ASSERT_EQ(6,  (-wide(s)).size());
+    ASSERT_EQ(14, (wide(u) * u + wide(u) * u * v).size());
+
+    ASSERT_FALSE((std::numeric_limits<Wide<6>::value_type>::is_signed));
+    ASSERT_TRUE((std::numeric_limits<Wide<6, Signed>::value_type>::is_signed));
+    ASSERT_EQ(typeid(unsigned char), typeid((wide(u) + u).get()));
+    ASSERT_EQ(typeid(signed short),  typeid((wide(s) * u).get()));
+}
+
+// 切り詰めずに正確な値を保つこと
+TEST(WideTest, ValueTest)
+{
+    for(int i = 0; i < 32; ++i)
+    {
+        for(int j = 0; j < 32; ++j)
+        {
+            const Bits<5>         u1(i);
+            const Bits<5>         u2(j);
+            const Bits<5, signed> s1(i);
+            const Bits<5, signed> s2(j);
+
+            ASSERT_EQ(u1.get() + u2.get(), (wide(u1) + u2).get());
+            ASSERT_EQ(u1.get() - u2.get(), (wide(u1) - u2).get());
+            ASSERT_EQ(u1.get() * u2.get(), (wide(u1) * u2).get());
+            ASSERT_EQ(s1.get() + u2.get(), (wide(s1) + u2).get());
+            ASSERT_EQ(u1.get() - s2.get(), (u1 - wide(s2)).get());
+            ASSERT_EQ(s1.get() * s2.get(), (wide(s1) * s2).get());
+            ASSERT_EQ(s1.get() * u2.get(), (wide(s1) * u2).get());
+            ASSERT_EQ(-s1.get(),           (-wide(s1)).get());
+        }
+    }
+}
+
+// Bits への明示的な変換でだけ切り詰めること
+TEST(WideTest, NarrowTest)
+{
+    Bits<5>         u(31);
+    Bits<5, signed> s(-16);
+
+    Bits<6> r1(wide(u) + u);
+    ASSERT_EQ(62, r1.get());
+
+    Bits<8> r2(wide(u) * u);
+    ASSERT_EQ(961 & 0xff, r2.get());
+
+    Bits<8, signed> r3;
+    r3 = wide(s) * u;
+    ASSERT_EQ(static_cast<signed char>(-496), r3.get());
+
+    Wide<12, Signed> w(wide(u) + u);
+    ASSERT_EQ(62, w.get());
+}
+
+namespace
+{
+
+long clamp(long n, long min, long max)
+{
+    return (n < min) ? min : (max < n) ? max : n;
+}
+
+} // namespace
+
+// + - * の結果がビット幅の範囲に飽和すること
+TEST(SaturateTest, ValueTest)
+{
+    typedef Bits<5, Saturate<signed> >   sbits;
+    typedef Bits<5, Saturate<unsigned> > ubits;
+
+    for(int i = -16; i < 16; ++i)
+    {
+        for(int j = -16; j < 16; ++j)
+        {
+            ASSERT_EQ(clamp(i + j, -16, 15), (sbits(i) + sbits(j)).get());
+            ASSERT_EQ(clamp(i - j, -16, 15), (sbits(i) - sbits(j)).get());
+            ASSERT_EQ(clamp(i * j, -16, 15), (sbits(i) * sbits(j)).get());
+        }
+    }
+    for(int i = 0; i < 32; ++i)
+    {
+        for(int j = 0; j < 32; ++j)
+        {
+            ASSERT_EQ(clamp(i + j, 0, 31), (ubits(i) + ubits(j)).get());
+            ASSERT_EQ(clamp(i - j, 0, 31), (ubits(i) - ubits(j)).get());
+            ASSERT_EQ(clamp(i * j, 0, 31), (ubits(i) * ubits(j)).get());
+        }
+    }
+
+    // 代入、複合代入、単項マイナスも飽和すること
+    sbits s(100);
+    ASSERT_EQ(15, s.get());
+    s = -100;
+    ASSERT_EQ(-16, s.get());
+    ASSERT_EQ(15, (-s).get());
+    s -= 1;
+    ASSERT_EQ(-16, s.get());
+
+    ubits u(-1);
+    ASSERT_EQ(0, u.get());
+    --u;
+    ASSERT_EQ(0, u.get());
+
+    Bits<31, Saturate<unsigned> > big(0x7fffffff);
+    ASSERT_EQ(0x7fffffff, (big * big).get());
+
+    Bits<32, Saturate<signed> > smallest(-0x7fffffffL - 1);
+    ASSERT_EQ(0x7fffffffL,       (smallest * smallest).get());
+    ASSERT_EQ(-0x7fffffffL - 1,  (smallest + smallest).get());
+    ASSERT_EQ(0x7fffffffL,       (-smallest).get());
+}
+
+// 飽和するビット列も、ビット幅に合う最小の型に格納されること
+TEST(SaturateTest, StorageTest)
+{
+    ASSERT_EQ(1, sizeof(Bits<5, Saturate<signed> >));
+    ASSERT_EQ(2, sizeof(Bits<12, Saturate<signed> >));
+    ASSERT_EQ(2, sizeof(Bits<16, Saturate<unsigned> >));
+    ASSERT_EQ(4, sizeof(Bits<24, Saturate<signed> >));
+    ASSERT_EQ(4, sizeof(Bits<32, Saturate<signed> >));
+
+    // 格納される型より広い値が、切り捨てられずに飽和すること
+    Bits<16, Saturate<signed> > s(70000);
+    ASSERT_EQ(32767, s.get());
+    s = -70000;
+    ASSERT_EQ(-32768, s.get());
+    ASSERT_EQ(32767, (s * s).get());
+
+    Bits<16, Saturate<unsigned> > u(65535);
+    ASSERT_EQ(65535, (u + u).get());
+    ASSERT_EQ(0,     (u - (u + u)).get());
+}
+
+// 飽和する被演算子があれば結果も飽和すること
+TEST(SaturateTest, ResultTest)
+{
+    Bits<4, Saturate<signed> > s(7);
+    Bits<8, signed>            t(127);
+    Bits<8>                    u(250);
+
+    ASSERT_EQ(127, (s + t).get());
+    ASSERT_EQ(255, (u + s).get());
+    ASSERT_EQ(7,   (s + 1).get());
+    ASSERT_EQ(-8,  (-1 - s * 2).get());
+
+    ASSERT_TRUE((std::numeric_limits<Bits<8, Saturate<Signed> >::value_type>::is_signed));
+    ASSERT_EQ(typeid(Bits<8, Saturate<Signed> >),   typeid(s + t));
+    ASSERT_EQ(typeid(Bits<8, Saturate<Unsigned> >), typeid(u + s));
+
+    // 遅延評価の式や Wide からは正確な値を飽和させること
+    Bits<8, Saturate<unsigned> > r1(lazy(u) + u);
+    ASSERT_EQ((250 + 250) & 0xff, r1.get());
+    Bits<8, Saturate<unsigned> > r2(wide(u) + u);
+    ASSERT_EQ(255, r2.get());
+}
+
+// パックの読み書きでは飽和せずビット列のまま扱うこと
+TEST(SaturateTest, PackTest)
+{
+    Bits<4, Saturate<signed> > s;
+    Bits<4>                    u;
+
+    (s, u) = 0xf5;
+    ASSERT_EQ(-1, s.get());
+    ASSERT_EQ(5,  u.get());
+    ASSERT_EQ(0xf5, (s, u));
+
+    s = 100;
+    ASSERT_EQ(0x75, (s, u));
+}
+
+namespace
+{
+
+template<int N, typename S>
+void checkBulk(int seed)
+{
+    typedef typename bulk::Element<N, S>::type element;
+    typedef Bits<N, Saturate<S> >              bits;
+
+    // 64、32、16 要素ずつの SIMD 演算に端数が残る長さ
+    const std::size_t Count = 1000 + 13;
+
+    element lhs[Count];
+    element rhs[Count];
+    element sum[Count];
+    element difference[Count];
+    element product[Count];
+
+    unsigned int x = seed;
+    for(std::size_t i = 0; i < Count; ++i)
+    {
+        x = x * 1103515245u + 12345u;
+        lhs[i] = static_cast<element>(x >> 8);
+        rhs[i] = static_cast<element>(x >> 16);
+    }
+
+    bulk::add<N, S>(lhs, rhs, sum, Count);
+    bulk::sub<N, S>(lhs, rhs, difference, Count);
+    bulk::mul<N, S>(lhs, rhs, product, Count);
+    for(std::size_t i = 0; i < Count; ++i)
+    {
+        ASSERT_EQ((bits(lhs[i]) + bits(rhs[i])).get(), sum[i]);
+        ASSERT_EQ((bits(lhs[i]) - bits(rhs[i])).get(), difference[i]);
+        ASSERT_EQ((bits(lhs[i]) * bits(rhs[i])).get(), product[i]);
+    }
+
+    // 結果を被演算子に上書きできること
+    bulk::add<N, S>(lhs, rhs, lhs, Count);
+    ASSERT_EQ(0, std::memcmp(lhs, sum, sizeof(lhs)));
+}
+
+} // namespace
+
+// 配列の一括演算がスカラの演算と同じ結果になること
+TEST(SaturateTest, BulkTest)
+{
+    checkBulk<3,  signed>(1);
+    checkBulk<8,  signed>(2);
+    checkBulk<12, signed>(3);
+    checkBulk<16, signed>(4);
+    checkBulk<20, signed>(5);
+    checkBulk<3,  unsigned>(6);
+    checkBulk<8,  unsigned>(7);
+    checkBulk<12, unsigned>(8);
+    checkBulk<16, unsigned>(9);
+    checkBulk<20, unsigned>(10);
+}
+
+// ビット列の一部を、一時オブジェクトなしで読み書きできること
+TEST(SliceTest, GetSetTest)
+{
+    Bits<16> bits(0xabcd);
+
+    ASSERT_EQ(0x5e, (bits.slice<11, 5>().get()));
+    ASSERT_EQ(0xa,  static_cast<int>(bits.slice<15, 12>()));
+    ASSERT_EQ(7,    (bits.slice<11, 5>().size()));
+
+    // 範囲外のビットは変化しないこと
+    bits.slice<11, 5>() = 0x7f;
+    ASSERT_EQ(0xafed, bits.get());
+    bits.slice<11, 5>() = 3;
+    ASSERT_EQ(0xa06d, bits.get());
+
+    // スライスのスライス
+    ASSERT_EQ(0xd, (bits.slice<7, 0>().slice<3, 0>().get()));
+
+    // 他のスライスを代入できること
+    Bits<8> other;
+    other.slice<7, 4>() = bits.slice<3, 0>();
+    ASSERT_EQ(0xd0, other.get());
+}
+
+// 符号付きのビット列のスライスは符号なしのビット列として扱うこと
+TEST(SliceTest, SignedTest)
+{
+    Bits<8, signed> bits(-1);
+
+    ASSERT_EQ(0xf, (bits.slice<7, 4>().get()));
+
+    bits.slice<7, 7>() = 0;
+    ASSERT_EQ(127, bits.get());
+
+    const Bits<8, signed> constant(-128);
+    ASSERT_EQ(1, (constant.slice<7, 7>().get()));
+}
+
+// スライスをパックに連結できること
+TEST(SliceTest, PackTest)
+{
+    Bits<16> bits(0xa06d);
+    Bits<8>  other(0x5a);
+
+    (bits.slice<15, 12>(), other, bits.slice<3, 0>()) = 0x1234;
+    ASSERT_EQ(0x1064, bits.get());
+    ASSERT_EQ(0x23,   other.get());
+
+    (other.slice<3, 0>(), reserve<2>, bits.slice<1, 0>()) = 0xfe;
+    ASSERT_EQ(0x2f,   other.get());
+    ASSERT_EQ(0x1066, bits.get());
+
+    const Bits<16> constant(0x1234);
+    ASSERT_EQ(0x41,  static_cast<int>(constant.slice<3, 0>(), constant.slice<15, 12>()));
+    ASSERT_EQ(0x4f1, static_cast<int>(constant.slice<3, 0>(), other.slice<3, 0>(), constant.slice<15, 12>()));
+
+    // パックのスライス
+    Bits<4> high(1);
+    Bits<4> low(2);
+    (high, low).slice<5, 2>() = 0xf;
+    ASSERT_EQ(0x3, high.get());
+    ASSERT_EQ(0xe, low.get());
+    ASSERT_EQ(0xf, static_cast<int>((high, low).slice<5, 2>()));
+}
+
+// 多バイトのビット列のスライスを読み書きできること
+TEST(SliceTest, MultiByteTest)
+{
+    Bits<40> bits;
+
+    bits.slice<39, 36>() = 0xa;
+    bits.slice<35, 4>()  = 0x12345678u;
+    bits.slice<3, 0>()   = 0x5;
+    ASSERT_EQ(0xa1,       (bits.slice<39, 32>().get()));
+    ASSERT_EQ(0x23456785, (bits.slice<31, 0>().get()));
+    ASSERT_EQ(0x8,        (bits.slice<7, 4>().get()));
+    ASSERT_EQ(0xa1,       bits.get().value_[0]);
+    ASSERT_EQ(0x85,       bits.get().value_[4]);
+
+    // 多バイトのスライス
+    Bits<100> wide;
+    wide.slice<99, 60>() = bits;
+    ASSERT_EQ(0xa,       wide.get().value_[0]);
+    ASSERT_EQ(0x12,      wide.get().value_[1]);
+    ASSERT_EQ(0x50,      wide.get().value_[5]);
+    ASSERT_EQ(0x1234567, (wide.slice<95, 68>().get()));
+
+    Bits<40> other(wide.slice<99, 60>());
+    ASSERT_EQ(0xa1,       (other.slice<39, 32>().get()));
+    ASSERT_EQ(0x23456785, (other.slice<31, 0>().get()));
+}
+
+// ビット数の範囲で 1 のビットと、上位・下位の 0 のビットを数えること
+TEST(BitOpsTest, CountTest)
+{
+    for(int n = 0; n < 0x1000; ++n)
+    {
+        const Bits<12> bits(n);
+
+        int ones     = 0;
+        int leading  = 12;
+        int trailing = 12;
+        for(int i = 0; i < 12; ++i)
+        {
+            if((n >> i) & 1)
+            {
+                ++ones;
+                leading  = 11 - i;
+                trailing = (trailing == 12) ? i : trailing;
+            }
+        }
+        ASSERT_EQ(ones,     popcount(bits));
+        ASSERT_EQ(leading,  clz(bits));
+        ASSERT_EQ(trailing, ctz(bits));
+    }
+
+    // 符号付きは N ビットの 2 の補数として数えること
+    const Bits<5, signed> s(-1);
+    ASSERT_EQ(5, popcount(s));
+    ASSERT_EQ(0, clz(s));
+    ASSERT_EQ(0, ctz(s));
+
+    // コンテナと同じビット数
+    const Bits<std::numeric_limits<unsigned long>::digits, unsigned long> zero(0);
+    const Bits<std::numeric_limits<unsigned long>::digits, unsigned long> one(1);
+    ASSERT_EQ(std::numeric_limits<unsigned long>::digits,     clz(zero));
+    ASSERT_EQ(std::numeric_limits<unsigned long>::digits,     ctz(zero));
+    ASSERT_EQ(std::numeric_limits<unsigned long>::digits - 1, clz(one));
+    ASSERT_EQ(0,                                              ctz(one));
+}
+
+// unsigned long の幅いっぱいのビット列でも数え、並べ替えること
+TEST(BitOpsTest, WordTest)
+{
+    typedef Bits<std::numeric_limits<unsigned long>::digits, unsigned long> word;
+
+    const int     digits = std::numeric_limits<unsigned long>::digits;
+    unsigned long x      = 0x9e3779b9ul;
+    for(int n = 0; n < 1000; ++n)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const unsigned long value = x >> (n % digits);
+
+        int           ones      = 0;
+        int           leading   = digits;
+        int           trailing  = digits;
+        unsigned long reversed  = 0;
+        unsigned long swapped   = 0;
+        for(int i = 0; i < digits; ++i)
+        {
+            const unsigned long bit = (value >> i) & 1;
+            ones     += static_cast<int>(bit);
+            leading   = bit ? digits - 1 - i : leading;
+            trailing  = (bit && (trailing == digits)) ? i : trailing;
+            reversed |= bit << (digits - 1 - i);
+        }
+        for(int i = 0; i < digits; i += 8)
+        {
+            swapped |= ((value >> i) & 0xff) << (digits - 8 - i);
+        }
+
+        const word bits(value);
+        ASSERT_EQ(ones,     popcount(bits));
+        ASSERT_EQ(leading,  clz(bits));
+        ASSERT_EQ(trailing, ctz(bits));
+        ASSERT_EQ(reversed, bitreverse(bits).get());
+        ASSERT_EQ(swapped,  bswap(bits).get());
+    }
+}
+
+// ビット数の範囲で回転すること
+TEST(BitOpsTest, RotateTest)
+{
+    const Bits<12> bits(0x801);
+
+    ASSERT_EQ(0x003, rotl(bits, 1).get());
+    ASSERT_EQ(0xc00, rotr(bits, 1).get());
+    ASSERT_EQ(0x00c, rotl(bits, 15).get());
+    ASSERT_EQ(0x00c, rotr(bits, -15).get());
+    ASSERT_EQ(0x801, rotl(bits, 12).get());
+    ASSERT_EQ(0x801, rotr(bits, 0).get());
+
+    // 回転したビット列は符号拡張されること
+    const Bits<4, signed> s(3);
+    ASSERT_EQ(-7, rotr(s, 1).get());
+}
+
+// ビットの並びとバイトの並びを反転すること
+TEST(BitOpsTest, ReverseTest)
+{
+    ASSERT_EQ(0xc02, bitreverse(Bits<12>(0x403)).get());
+    ASSERT_EQ(0x80,  bitreverse(Bits<8>(1)).get());
+    ASSERT_EQ(-16,   bitreverse(Bits<5, signed>(1)).get());
+
+    ASSERT_EQ(0x78563412u, bswap(Bits<32>(0x12345678)).get());
+    ASSERT_EQ(0x563412u,   bswap(Bits<24>(0x123456)).get());
+    ASSERT_EQ(-32750,      bswap(Bits<16, signed>(0x1280)).get());
+}
+
+// 多バイトのビット列をブロックごとに扱うこと
+TEST(BitOpsTest, MultiByteTest)
+{
+    Bits<40> bits;
+    bits.slice<39, 32>() = 0x0a;
+    bits.slice<31, 0>()  = 0x12345670u;
+
+    ASSERT_EQ(14, popcount(bits));
+    ASSERT_EQ(4,  clz(bits));
+    ASSERT_EQ(4,  ctz(bits));
+    ASSERT_EQ(40, clz(Bits<40>()));
+    ASSERT_EQ(40, ctz(Bits<40>()));
+
+    const Bits<40> left(rotl(bits, 12));
+    ASSERT_EQ(0x23,        (left.slice<39, 32>().get()));
+    ASSERT_EQ(0x456700a1u, (left.slice<31, 0>().get()));
+    ASSERT_EQ(0x23,        (rotr(bits, 28).slice<39, 32>().get()));
+
+    const Bits<40> reversed(bitreverse(bits));
+    ASSERT_EQ(0x0e,        (reversed.slice<39, 32>().get()));
+    ASSERT_EQ(0x6a2c4850u, (reversed.slice<31, 0>().get()));
+
+    const Bits<40> swapped(bswap(bits));
+    ASSERT_EQ(0x70,        (swapped.slice<39, 32>().get()));
+    ASSERT_EQ(0x5634120au, (swapped.slice<31, 0>().get()));
+
+    // 最上位のブロックに端数のあるビット列
+    Bits<100> wide;
+    wide.slice<99, 99>() = 1;
+    ASSERT_EQ(0,  clz(wide));
+    ASSERT_EQ(99, ctz(wide));
+    ASSERT_EQ(1,  (bitreverse(wide).slice<0, 0>().get()));
+    ASSERT_EQ(1,  (rotl(wide, 1).slice<0, 0>().get()));
+}
+
 // entry point
 int main(int argc, char* argv[])
 {
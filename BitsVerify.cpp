@@ -0,0 +1,344 @@
+// exhaustive differential verification of the Bits operators; see Makefile (make verify)
+//
+// for every width N up to --max-width, every operator of EMATTSAN_BITS_DEFINE_OP (+ - * / % | & ^)
+// and every pair of operand kinds
+//   Bits<N>, Bits<N, signed>          both ways round
+//   Bits<N>, Bits<N, signed> with int  on either side
+// all 2^N x 2^N operand patterns are evaluated and compared with a reference model:
+// the operation on the values as 64 bit integers, wrapped to N bits, signed when both operands are.
+// division and remainder by 0 are skipped.
+//
+// the pairs are cut into small tasks handed to the threads on demand (OpenMP dynamic schedule),
+// so that the few large widths do not leave threads idle; set OMP_NUM_THREADS to limit the threads.
+//
+// options:
+//   --max-width=N  largest width (1..16, default 12; 16 takes minutes on a single core)
+
+#include "Bits.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <stdint.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+const int MaxWidth = 16;
+
+// operand kinds
+struct U {};
+struct S {};
+struct I {};
+
+inline long long sign_extend(uint32_t pattern, int width)
+{
+    const long long value = pattern & ((1u << width) - 1);
+    return ((value >> (width - 1)) & 1) ? value - (1LL << width) : value;
+}
+
+inline long long wrap(long long value, int width, bool isSigned)
+{
+    const uint32_t pattern = static_cast<uint32_t>(static_cast<unsigned long long>(value) & ((1u << width) - 1));
+    return isSigned ? sign_extend(pattern, width) : static_cast<long long>(pattern);
+}
+
+template<int N, typename K>
+struct Operand;
+
+template<int N>
+struct Operand<N, U>
+{
+    typedef Bits<N> type;
+    static const bool Signed = false;
+    static const char* name() { return "Bits<N>"; }
+    static type make(uint32_t pattern) { return type(pattern); }
+    static long long value(uint32_t pattern) { return pattern; }
+};
+
+template<int N>
+struct Operand<N, S>
+{
+    typedef Bits<N, signed> type;
+    static const bool Signed = true;
+    static const char* name() { return "Bits<N, signed>"; }
+    static type make(uint32_t pattern) { return type(pattern); }
+    static long long value(uint32_t pattern) { return sign_extend(pattern, N); }
+};
+
+template<int N>
+struct Operand<N, I>
+{
+    typedef int type;
+    static const bool Signed = true;
+    static const char* name() { return "int"; }
+    static type make(uint32_t pattern) { return static_cast<int>(sign_extend(pattern, N)); }
+    static long long value(uint32_t pattern) { return sign_extend(pattern, N); }
+};
+
+struct Value
+{
+    long long value;
+    int       width;
+    bool      isSigned;
+};
+
+template<int N, typename T>
+inline Value value_of(const Bits<N, T>& bits)
+{
+    const Value value = { bits.get(), N, std::numeric_limits<typename Bits<N, T>::value_type>::is_signed };
+    return value;
+}
+
+#define VERIFY_DEFINE_OP(Name, op, divides)                                      \
+struct Name                                                                      \
+{                                                                                \
+    static const bool Divides = divides;                                         \
+    static const char* name() { return #op; }                                    \
+    template<typename L, typename R>                                             \
+    static Value apply(const L& lhs, const R& rhs) { return value_of(lhs op rhs); } \
+    static long long reference(long long lhs, long long rhs) { return lhs op rhs; } \
+};
+
+VERIFY_DEFINE_OP(Add, +, false)
+VERIFY_DEFINE_OP(Sub, -, false)
+VERIFY_DEFINE_OP(Mul, *, false)
+VERIFY_DEFINE_OP(Div, /, true)
+VERIFY_DEFINE_OP(Mod, %, true)
+VERIFY_DEFINE_OP(Or,  |, false)
+VERIFY_DEFINE_OP(And, &, false)
+VERIFY_DEFINE_OP(Xor, ^, false)
+
+#undef VERIFY_DEFINE_OP
+
+struct Failure
+{
+    uint32_t lhs;
+    uint32_t rhs;
+    Value    actual;
+    Value    expected;
+};
+
+// checks lhs patterns [lhsBegin, lhsEnd) against every rhs pattern; returns the number of mismatches
+typedef unsigned long (*Checker)(uint32_t lhsBegin, uint32_t lhsEnd, Failure& first);
+
+template<int N, typename L, typename R, typename Op>
+struct Check
+{
+    static unsigned long run(uint32_t lhsBegin, uint32_t lhsEnd, Failure& first)
+    {
+        typedef Operand<N, L> Lhs;
+        typedef Operand<N, R> Rhs;
+
+        const bool    isSigned = Lhs::Signed && Rhs::Signed;
+        unsigned long count    = 0;
+        for(uint32_t a = lhsBegin; a < lhsEnd; ++a)
+        {
+            const typename Lhs::type lhs = Lhs::make(a);
+            for(uint32_t b = 0; b < (1u << N); ++b)
+            {
+                if(Op::Divides && (Rhs::value(b) == 0))
+                {
+                    continue;
+                }
+
+                const Value actual   = Op::apply(lhs, Rhs::make(b));
+                const Value expected = { wrap(Op::reference(Lhs::value(a), Rhs::value(b)), N, isSigned), N, isSigned };
+                if((actual.value != expected.value) || (actual.width != expected.width) || (actual.isSigned != expected.isSigned))
+                {
+                    if(count == 0)
+                    {
+                        const Failure failure = { a, b, actual, expected };
+                        first = failure;
+                    }
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+};
+
+struct Job
+{
+    int         width;
+    const char* lhs;
+    const char* rhs;
+    const char* op;
+    Checker     checker;
+};
+
+template<int N, typename L, typename R, typename Op>
+void add_job(std::vector<Job>& jobs)
+{
+    const Job job = { N, Operand<N, L>::name(), Operand<N, R>::name(), Op::name(), &Check<N, L, R, Op>::run };
+    jobs.push_back(job);
+}
+
+template<int N, typename L, typename R>
+void add_operators(std::vector<Job>& jobs)
+{
+    add_job<N, L, R, Add>(jobs);
+    add_job<N, L, R, Sub>(jobs);
+    add_job<N, L, R, Mul>(jobs);
+    add_job<N, L, R, Div>(jobs);
+    add_job<N, L, R, Mod>(jobs);
+    add_job<N, L, R, Or >(jobs);
+    add_job<N, L, R, And>(jobs);
+    add_job<N, L, R, Xor>(jobs);
+}
+
+template<int N>
+struct Widths
+{
+    static void add(std::vector<Job>& jobs, int maxWidth)
+    {
+        Widths<N - 1>::add(jobs, maxWidth);
+        if(N <= maxWidth)
+        {
+            add_operators<N, U, U>(jobs);
+            add_operators<N, U, S>(jobs);
+            add_operators<N, S, U>(jobs);
+            add_operators<N, S, S>(jobs);
+            add_operators<N, U, I>(jobs);
+            add_operators<N, I, U>(jobs);
+            add_operators<N, S, I>(jobs);
+            add_operators<N, I, S>(jobs);
+        }
+    }
+};
+
+template<>
+struct Widths<0>
+{
+    static void add(std::vector<Job>&, int) {}
+};
+
+// a part of the lhs patterns of a job, about 2^16 pairs
+struct Task
+{
+    std::size_t   job;
+    uint32_t      lhsBegin;
+    uint32_t      lhsEnd;
+    unsigned long mismatches;
+    Failure       first;
+};
+
+const int TaskPairsLog2 = 16;
+
+double now()
+{
+#if defined(_OPENMP)
+    return omp_get_wtime();
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+int threads()
+{
+#if defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+std::ostream& operator << (std::ostream& out, const Value& value)
+{
+    return out << value.value << " (" << value.width << " bits, " << (value.isSigned ? "signed" : "unsigned") << ")";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int maxWidth = 12;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strncmp(argv[i], "--max-width=", 12) == 0)
+        {
+            maxWidth = std::atoi(argv[i] + 12);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--max-width=N]" << std::endl;
+            return 1;
+        }
+    }
+    if((maxWidth < 1) || (MaxWidth < maxWidth))
+    {
+        std::cerr << "--max-width must be 1.." << MaxWidth << std::endl;
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+    Widths<MaxWidth>::add(jobs, maxWidth);
+
+    std::vector<Task> tasks;
+    for(std::size_t j = 0; j < jobs.size(); ++j)
+    {
+        const int      width = jobs[j].width;
+        const uint32_t step  = (2 * width <= TaskPairsLog2) ? (1u << width) : (1u << (TaskPairsLog2 - width));
+        for(uint32_t a = 0; a < (1u << width); a += step)
+        {
+            const Task task = { j, a, a + step, 0, Failure() };
+            tasks.push_back(task);
+        }
+    }
+
+    const double start = now();
+
+    const long taskCount = static_cast<long>(tasks.size());
+#pragma omp parallel for schedule(dynamic)
+    for(long t = 0; t < taskCount; ++t)
+    {
+        Task& task = tasks[t];
+        task.mismatches = jobs[task.job].checker(task.lhsBegin, task.lhsEnd, task.first);
+    }
+
+    const double seconds = now() - start;
+
+    // the tasks of a job are consecutive, in lhs order
+    unsigned long long pairs    = 0;
+    std::size_t        failures = 0;
+    for(std::size_t t = 0; t < tasks.size();)
+    {
+        const Job&    job        = jobs[tasks[t].job];
+        unsigned long mismatches = 0;
+        const Task*   first      = 0;
+        for(; (t < tasks.size()) && (&jobs[tasks[t].job] == &job); ++t)
+        {
+            if((tasks[t].mismatches != 0) && (first == 0))
+            {
+                first = &tasks[t];
+            }
+            mismatches += tasks[t].mismatches;
+        }
+        pairs += 1ull << (2 * job.width);
+
+        if(mismatches != 0)
+        {
+            ++failures;
+            std::cout << "FAIL " << job.lhs << " " << job.op << " " << job.rhs << ", N = " << job.width
+                      << ": " << mismatches << " mismatches; first: patterns " << first->first.lhs << " " << job.op << " " << first->first.rhs
+                      << " => " << first->first.actual << ", expected " << first->first.expected << std::endl;
+        }
+    }
+
+    std::cout << (failures == 0 ? "OK" : "FAILED") << ": " << jobs.size() << " operator/width/kind combinations, "
+              << pairs << " operand pairs, widths 1.." << maxWidth << ", "
+              << threads() << " threads, " << seconds << " s" << std::endl;
+
+    return (failures == 0) ? 0 : 1;
+}
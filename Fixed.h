@@ -0,0 +1,285 @@
+#ifndef EMATTSAN_FIXED_H
+#define EMATTSAN_FIXED_H
+
+//----------------------------------------------------------------------
+
+#include "Bits.h"
+
+#include <cmath>
+
+//----------------------------------------------------------------------
+
+namespace emattsan
+{
+
+//----------------------------------------------------------------------
+
+namespace bits
+{
+
+//----------------------------------------------------------------------
+
+// Fixed<I, F, S> is a fixed point number of I integer and F fraction bits, e.g. Fixed<1, 15> is Q15.
+// the raw value is a Bits<I + F, S>, so that it wraps as Bits does; S may be Saturate<Signed> to clamp.
+// products and quotients are computed in int, or in long when they need more than 32 bits, and rounded
+// to nearest, ties to even, as are conversions from double, to integers and between Q formats.
+// a Fixed holds at most 32 bits (a product of MultiByte values can not be computed)
+
+namespace detail
+{
+
+// n / 2^SHIFT rounded to nearest, ties to even: a tie reaches the next multiple only from an odd quotient.
+// n is shifted arithmetically, as in TrimShift; W has room for n + 2^(SHIFT - 1), since n is a product
+// of two values of at most half the width of W, or a value of at most 32 bits in a long
+template<int SHIFT>
+struct FixedRound
+{
+    template<typename W>
+    static W apply(W n)
+    {
+        return (n + ((static_cast<W>(1) << (SHIFT - 1)) - 1) + ((n >> SHIFT) & 1)) >> SHIFT;
+    }
+};
+
+template<>
+struct FixedRound<0>
+{
+    template<typename W>
+    static W apply(W n)
+    {
+        return n;
+    }
+};
+
+// n * 2^SHIFT for SHIFT >= 0, n / 2^-SHIFT rounded otherwise
+template<int SHIFT, bool LEFT = (0 <= SHIFT)>
+struct FixedScale
+{
+    template<typename W>
+    static W apply(W n)
+    {
+        return static_cast<W>(static_cast<typename TraitsPrimitive<W>::unsigned_value_type>(n) << SHIFT);
+    }
+};
+
+template<int SHIFT>
+struct FixedScale<SHIFT, false>
+{
+    template<typename W>
+    static W apply(W n)
+    {
+        return FixedRound<-SHIFT>::apply(n);
+    }
+};
+
+// the type of a product of two N bit values of sign S
+template<int N, typename S>
+struct FixedWide
+{
+    typedef typename FitPrimitive<2 + (std::numeric_limits<unsigned int>::digits < 2 * N), S>::value_type type;
+};
+
+} // namespace detail
+
+template<int I, int F, typename S = Signed>
+class Fixed
+{
+public:
+    typedef Bits<I + F, S>                  bits_type;
+    typedef typename bits_type::value_type  value_type;
+    typedef typename bits_type::sign_type   sign_type;
+
+    typedef typename detail::FixedWide<I + F, sign_type>::type wide_type;
+    typedef typename detail::FitPrimitive<3, sign_type>::value_type integer_type;
+
+    static const int IntBits  = I;
+    static const int FracBits = F;
+    static const int Size     = (I + F) *
+        detail::ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<
+            (0 <= I) && (0 <= F) && (I + F <= std::numeric_limits<unsigned int>::digits)>::value;
+
+    static int size()
+    {
+        return Size;
+    }
+
+    Fixed() : bits_()
+    {
+    }
+
+    // the raw value, i.e. the value * 2^F
+    explicit Fixed(const bits_type& bits) : bits_(bits)
+    {
+    }
+
+    explicit Fixed(int n) : bits_(fromInteger(n))
+    {
+    }
+
+    explicit Fixed(double x) : bits_(fromDouble(x))
+    {
+    }
+
+    // rescales between Q formats at compile time
+    template<int J, int G, typename T>
+    explicit Fixed(const Fixed<J, G, T>& other) : bits_(static_cast<value_type>(detail::FixedScale<F - G>::apply(static_cast<integer_type>(other.get()))))
+    {
+    }
+
+    value_type get() const
+    {
+        return bits_.get();
+    }
+
+    const bits_type& bits() const
+    {
+        return bits_;
+    }
+
+    integer_type toInteger() const
+    {
+        return detail::FixedRound<F>::apply(static_cast<integer_type>(get()));
+    }
+
+    double toDouble() const
+    {
+        return get() * (1.0 / (static_cast<unsigned long>(1) << F));
+    }
+
+    float toFloat() const
+    {
+        return static_cast<float>(toDouble());
+    }
+
+    const Fixed& operator + () const
+    {
+        return *this;
+    }
+
+    Fixed operator - () const
+    {
+        return Fixed(bits_type(-get()));
+    }
+
+    Fixed& operator += (const Fixed& rhs)
+    {
+        return *this = *this + rhs;
+    }
+
+    Fixed& operator -= (const Fixed& rhs)
+    {
+        return *this = *this - rhs;
+    }
+
+    Fixed& operator *= (const Fixed& rhs)
+    {
+        return *this = *this * rhs;
+    }
+
+    Fixed& operator /= (const Fixed& rhs)
+    {
+        return *this = *this / rhs;
+    }
+
+    friend inline Fixed operator + (const Fixed& lhs, const Fixed& rhs)
+    {
+        return Fixed(bits_type(lhs.get() + rhs.get()));
+    }
+
+    friend inline Fixed operator - (const Fixed& lhs, const Fixed& rhs)
+    {
+        return Fixed(bits_type(lhs.get() - rhs.get()));
+    }
+
+    friend inline Fixed operator * (const Fixed& lhs, const Fixed& rhs)
+    {
+        return Fixed(bits_type(static_cast<value_type>(detail::FixedRound<F>::apply(static_cast<wide_type>(lhs.get()) * static_cast<wide_type>(rhs.get())))));
+    }
+
+    // rhs must not be 0; rounds the magnitude of the quotient
+    friend inline Fixed operator / (const Fixed& lhs, const Fixed& rhs)
+    {
+        const wide_type numerator = detail::FixedScale<F>::apply(static_cast<wide_type>(lhs.get()));
+        const wide_type divisor   = rhs.get();
+        const wide_type quotient  = numerator / divisor;
+        const wide_type twice     = magnitude(numerator % divisor) * 2;
+        const bool      up        = (magnitude(divisor) < twice) | ((twice == magnitude(divisor)) & (quotient & 1));
+        const wide_type step      = ((numerator < 0) != (divisor < 0)) ? -1 : 1;
+        return Fixed(bits_type(static_cast<value_type>(quotient + up * step)));
+    }
+
+    friend inline bool operator == (const Fixed& lhs, const Fixed& rhs) { return lhs.get() == rhs.get(); }
+    friend inline bool operator != (const Fixed& lhs, const Fixed& rhs) { return lhs.get() != rhs.get(); }
+    friend inline bool operator <  (const Fixed& lhs, const Fixed& rhs) { return lhs.get() <  rhs.get(); }
+    friend inline bool operator <= (const Fixed& lhs, const Fixed& rhs) { return lhs.get() <= rhs.get(); }
+    friend inline bool operator >  (const Fixed& lhs, const Fixed& rhs) { return lhs.get() >  rhs.get(); }
+    friend inline bool operator >= (const Fixed& lhs, const Fixed& rhs) { return lhs.get() >= rhs.get(); }
+
+private:
+    static wide_type magnitude(wide_type n)
+    {
+        return (n < 0) ? -n : n;
+    }
+
+    // n * 2^F wraps (or clamps) to the raw value as an integer of Size bits would
+    static value_type fromInteger(integer_type n)
+    {
+        return static_cast<value_type>(detail::FixedScale<F>::apply(n));
+    }
+
+    // x * 2^F out of range wraps as an integer would (the remainder modulo 2^Size is exact), or clamps
+    // when S saturates, before the cast to integer_type; NaN and, unless S saturates, infinities are 0
+    static value_type fromDouble(double x)
+    {
+        const double scaled = x * (static_cast<unsigned long>(1) << F);
+        double       n      = std::floor(scaled);
+        const double rest   = scaled - n;
+        if((0.5 < rest) || ((rest == 0.5) && (std::fmod(n, 2.0) != 0)))
+        {
+            n += 1;
+        }
+
+        const double range    = static_cast<double>(static_cast<unsigned long>(1) << Size);
+        const bool   isSigned = std::numeric_limits<integer_type>::is_signed;
+        if(n != n)
+        {
+            n = 0;
+        }
+        else if(detail::Saturating<S>::value)
+        {
+            const double lower = isSigned ? -range / 2 : 0;
+            const double upper = (isSigned ? range / 2 : range) - 1;
+            n = (n < lower) ? lower : ((upper < n) ? upper : n);
+        }
+        else
+        {
+            n = (std::fabs(n) <= std::numeric_limits<double>::max()) ? std::fmod(n, range) : 0;
+            if(!isSigned && (n < 0))
+            {
+                n += range;
+            }
+        }
+        return static_cast<value_type>(static_cast<integer_type>(n));
+    }
+
+    bits_type bits_;
+};
+
+template<int I, int F, typename S> const int Fixed<I, F, S>::IntBits;
+template<int I, int F, typename S> const int Fixed<I, F, S>::FracBits;
+template<int I, int F, typename S> const int Fixed<I, F, S>::Size;
+
+typedef Fixed<1, 15> Q15;
+typedef Fixed<1, 31> Q31;
+
+//----------------------------------------------------------------------
+
+} // namespace bits
+
+//----------------------------------------------------------------------
+
+} // namespace emattsan
+
+//----------------------------------------------------------------------
+
+#endif//EMATTSAN_FIXED_H
@@ -0,0 +1,208 @@
+// compile: g++ -Wall -o FixedTest FixedTest.cpp -lgtest
+// need Google Test (see: http://code.google.com/p/googletest/ )
+
+#include <gtest/gtest.h>
+
+#include "Fixed.h"
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// x を最も近い整数に丸める (同距離なら偶数)
+long round_even(double x)
+{
+    const double n = std::floor(x);
+    const double rest = x - n;
+    return static_cast<long>(((0.5 < rest) || ((rest == 0.5) && (std::fmod(n, 2.0) != 0))) ? n + 1 : n);
+}
+
+// n を size ビットの値に切り詰める
+long wrap(long n, int size, bool isSigned)
+{
+    const long mask  = (1L << size) - 1;
+    const long value = n & mask;
+    return (isSigned && ((value >> (size - 1)) != 0)) ? value - (1L << size) : value;
+}
+
+} // namespace
+
+// サイズと格納する型が Bits と同じであること
+TEST(FixedTest, SizeTest)
+{
+    ASSERT_EQ(16, Q15::size());
+    ASSERT_EQ(32, Q31::size());
+    ASSERT_EQ(8,  (Fixed<4, 4>::size()));
+    ASSERT_EQ(15, (Fixed<1, 15>::FracBits));
+
+    ASSERT_EQ(sizeof(short), sizeof(Q15));
+    ASSERT_EQ(sizeof(int),   sizeof(Q31));
+    ASSERT_EQ(sizeof(char),  sizeof(Fixed<4, 4>));
+    ASSERT_EQ(typeid(Bits<16, Signed>), typeid(Q15().bits()));
+}
+
+// 浮動小数点数や整数との変換で最も近い値に丸めること
+TEST(FixedTest, ConversionTest)
+{
+    ASSERT_EQ(16384,  Q15(0.5).get());
+    ASSERT_EQ(-32768, Q15(-1.0).get());
+    ASSERT_EQ(0.5,    Q15(0.5).toDouble());
+    ASSERT_EQ(-0.25f, Q15(-0.25f).toFloat());
+
+    // 同距離なら偶数に丸めること
+    ASSERT_EQ(0,  (Fixed<4, 1>(0.25).get()));
+    ASSERT_EQ(2,  (Fixed<4, 1>(0.75).get()));
+    ASSERT_EQ(-2, (Fixed<4, 1>(-0.75).get()));
+    ASSERT_EQ(2,  (Fixed<4, 1>(2.5).toInteger()));
+    ASSERT_EQ(4,  (Fixed<4, 1>(3.5).toInteger()));
+    ASSERT_EQ(-2, (Fixed<4, 1>(-1.5).toInteger()));
+
+    // 範囲外の値は Bits と同じく切り詰めること
+    ASSERT_EQ(-1.0, Q15(1.0).toDouble());
+    ASSERT_EQ(3,    (Fixed<4, 4>(3).toInteger()));
+    ASSERT_EQ(-7,   (Fixed<4, 4>(9).toInteger()));
+    ASSERT_EQ(7,    (Fixed<4, 4, Unsigned>(-9).toInteger()));
+}
+
+// 加減算と比較
+TEST(FixedTest, AddTest)
+{
+    Q15 a(0.5);
+    Q15 b(0.25);
+
+    ASSERT_EQ(0.75,  (a + b).toDouble());
+    ASSERT_EQ(0.25,  (a - b).toDouble());
+    ASSERT_EQ(-0.5,  (-a).toDouble());
+    ASSERT_EQ(-1.0,  (a + a).toDouble());
+
+    a -= b;
+    ASSERT_TRUE(a == b);
+    a += b;
+    ASSERT_TRUE(b < a);
+    ASSERT_TRUE(a != b);
+    ASSERT_TRUE(-a <= b);
+}
+
+// 乗算が正しく丸めた積を切り詰めること
+TEST(FixedTest, MultiplyTest)
+{
+    typedef Fixed<3, 5>           sfixed;
+    typedef Fixed<3, 5, Unsigned> ufixed;
+
+    for(int i = 0; i < 256; ++i)
+    {
+        for(int j = 0; j < 256; ++j)
+        {
+            const sfixed s1((Bits<8, Signed>(i)));
+            const sfixed s2((Bits<8, Signed>(j)));
+            const long   sp = s1.get() * s2.get();
+            ASSERT_EQ(wrap(round_even(sp / 32.0), 8, true), (s1 * s2).get());
+
+            const ufixed u1((Bits<8, Unsigned>(i)));
+            const ufixed u2((Bits<8, Unsigned>(j)));
+            const long   up = u1.get() * u2.get();
+            ASSERT_EQ(wrap(round_even(up / 32.0), 8, false), (u1 * u2).get());
+        }
+    }
+
+    Q31 q(0.5);
+    q *= Q31(-0.5);
+    ASSERT_EQ(-0.25, q.toDouble());
+    ASSERT_EQ(1, (Q31(Bits<32, Signed>(1)) * Q31(0.75)).get());
+}
+
+// 除算が正しく丸めた商を切り詰めること
+TEST(FixedTest, DivideTest)
+{
+    typedef Fixed<3, 5>           sfixed;
+    typedef Fixed<3, 5, Unsigned> ufixed;
+
+    for(int i = 0; i < 256; ++i)
+    {
+        for(int j = 1; j < 256; ++j)
+        {
+            const sfixed s1((Bits<8, Signed>(i)));
+            const sfixed s2((Bits<8, Signed>(j)));
+            if(s2.get() != 0)
+            {
+                const double sq = s1.get() * 32.0 / s2.get();
+                ASSERT_EQ(wrap(round_even(sq), 8, true), (s1 / s2).get()) << i << " / " << j;
+            }
+
+            const ufixed u1((Bits<8, Unsigned>(i)));
+            const ufixed u2((Bits<8, Unsigned>(j)));
+            const double uq = u1.get() * 32.0 / u2.get();
+            ASSERT_EQ(wrap(round_even(uq), 8, false), (u1 / u2).get()) << i << " / " << j;
+        }
+    }
+
+    Q15 q(0.25);
+    q /= Q15(0.5);
+    ASSERT_EQ(0.5, q.toDouble());
+}
+
+// Q 形式の間の変換で小数部を丸めること
+TEST(FixedTest, RescaleTest)
+{
+    const Fixed<8, 8> x(3.75);
+
+    ASSERT_EQ(3.75, (Fixed<4, 12>(x).toDouble()));
+    ASSERT_EQ(4.0,  (Fixed<12, 0>(x).toDouble()));
+    ASSERT_EQ(3.5,  (Fixed<8, 1>(Fixed<8, 8>(3.375)).toDouble()));
+    ASSERT_EQ(3.0,  (Fixed<8, 1>(Fixed<8, 8>(3.25)).toDouble()));
+    ASSERT_EQ(4.0,  (Fixed<8, 1>(Fixed<8, 8>(3.75)).toDouble()));
+    ASSERT_EQ(-4.0, (Fixed<8, 0>(Fixed<8, 8>(-3.5)).toDouble()));
+
+    ASSERT_EQ(1 << 16, Q31(Q15(Bits<16, Signed>(1))).get());
+    ASSERT_EQ(0,       Q15(Q31(Bits<32, Signed>(1 << 15))).get());
+    ASSERT_EQ(2,       Q15(Q31(Bits<32, Signed>((1 << 16) + (1 << 15)))).get());
+    ASSERT_EQ(2,       Q15(Q31(Bits<32, Signed>((3 << 15) + 1))).get());
+}
+
+// Saturate を指定すると範囲外の値が飽和すること
+TEST(FixedTest, SaturateTest)
+{
+    typedef Fixed<1, 15, Saturate<Signed> > q15;
+
+    ASSERT_EQ(32767,  (q15(-1) * q15(-1)).get());
+    ASSERT_EQ(32767,  (q15(0.75) + q15(0.75)).get());
+    ASSERT_EQ(-32768, (q15(-0.75) - q15(0.75)).get());
+    ASSERT_EQ(32767,  (q15(0.5) / q15(0.25)).get());
+    ASSERT_EQ(32767,  q15(2.0).get());
+}
+
+// 整数の範囲を超える値や NaN も未定義動作にならないこと
+TEST(FixedTest, OutOfRangeDoubleTest)
+{
+    typedef Fixed<1, 15, Saturate<Signed> >   q15;
+    typedef Fixed<4, 4, Saturate<Unsigned> > u8;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // 切り詰める型は 2^Size を法とした剰余になること
+    ASSERT_EQ(wrap(round_even(1e12 * 32768), 16, true),  Q15(1e12).get());
+    ASSERT_EQ(wrap(round_even(-1e12 * 32768), 16, true), Q15(-1e12).get());
+    ASSERT_EQ(0,   Q15(1e300).get());
+    ASSERT_EQ(0,   Q15(nan).get());
+    ASSERT_EQ(0,   Q15(inf).get());
+    ASSERT_EQ(0,   Q31(-1e20).get());
+    ASSERT_EQ(112, (Fixed<4, 4, Unsigned>(-9.0).get()));
+
+    // 飽和する型は範囲の端に張り付くこと
+    ASSERT_EQ(32767,  q15(1e12).get());
+    ASSERT_EQ(-32768, q15(-1e12).get());
+    ASSERT_EQ(32767,  q15(inf).get());
+    ASSERT_EQ(-32768, q15(-inf).get());
+    ASSERT_EQ(0,      q15(nan).get());
+    ASSERT_EQ(255,    u8(1e12).get());
+    ASSERT_EQ(0,      u8(-1e12).get());
+}
+
+// entry point
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
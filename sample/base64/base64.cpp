@@ -0,0 +1,106 @@
+#include "base64.h"
+#include "Bits.h"
+
+using namespace emattsan::bits;
+
+static const char Table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+// Table reversed; 0 for chars not in Table (including '=')
+static const struct Reverse
+{
+    unsigned char value[256];
+
+    Reverse()
+    {
+        for(int i = 0; i < 256; ++i)
+        {
+            value[i] = 0;
+        }
+        for(int i = 0; i < 64; ++i)
+        {
+            value[static_cast<unsigned char>(Table[i])] = static_cast<unsigned char>(i);
+        }
+    }
+} reverse;
+
+static void encode_group(const char* src, char* dst)
+{
+    Bits<6> a, b, c, d;
+    (a, b, c, d) = (Bits<8>(src[0]), Bits<8>(src[1]), Bits<8>(src[2]));
+    dst[0] = Table[a];
+    dst[1] = Table[b];
+    dst[2] = Table[c];
+    dst[3] = Table[d];
+}
+
+std::size_t encode_base64(const char* src, std::size_t n, char* dst)
+{
+    char* d = dst;
+    std::size_t i = 0;
+    for(; i + 3 <= n; i += 3, d += 4)
+    {
+        encode_group(src + i, d);
+    }
+
+    if(i < n)
+    {
+        const char last[3] = { src[i], (i + 1 < n) ? src[i + 1] : '\0', '\0' };
+        encode_group(last, d);
+        d[3] = '=';
+        if(i + 1 == n)
+        {
+            d[2] = '=';
+        }
+        d += 4;
+    }
+
+    return d - dst;
+}
+
+std::size_t decode_base64(const char* src, std::size_t n, char* dst)
+{
+    char* d = dst;
+    for(std::size_t i = 0; i + 4 <= n; i += 4, d += 3)
+    {
+        Bits<8> r1, r2, r3;
+        (r1, r2, r3) = (Bits<6>(reverse.value[static_cast<unsigned char>(src[i    ])]),
+                        Bits<6>(reverse.value[static_cast<unsigned char>(src[i + 1])]),
+                        Bits<6>(reverse.value[static_cast<unsigned char>(src[i + 2])]),
+                        Bits<6>(reverse.value[static_cast<unsigned char>(src[i + 3])]));
+        d[0] = r1;
+        d[1] = r2;
+        d[2] = r3;
+    }
+
+    // padding; at most 2 chars of the last group
+    const std::size_t length = n / 4 * 4;
+    if((length > 0) && (src[length - 1] == '='))
+    {
+        d -= (src[length - 2] == '=') ? 2 : 1;
+    }
+
+    return d - dst;
+}
+
+std::string encode_base64(const std::string& s)
+{
+    std::string result((s.size() + 2) / 3 * 4, '\0');
+    if( ! s.empty())
+    {
+        encode_base64(s.data(), s.size(), &result[0]);
+    }
+    return result;
+}
+
+std::string decode_base64(const std::string& s)
+{
+    std::string result(s.size() / 4 * 3, '\0');
+    if( ! result.empty())
+    {
+        result.resize(decode_base64(s.data(), s.size(), &result[0]));
+    }
+    return result;
+}
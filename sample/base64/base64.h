@@ -0,0 +1,16 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <cstddef>
+#include <string>
+
+std::string encode_base64(const std::string& s);
+std::string decode_base64(const std::string& s);
+
+// without allocation; dst holds (n + 2) / 3 * 4 chars for encoding and n / 4 * 3 bytes for decoding.
+// decoding reads whole groups of 4 chars only, takes chars not in the alphabet as 'A' and '=' in the last
+// 2 chars as padding. return the number of chars (bytes) written
+std::size_t encode_base64(const char* src, std::size_t n, char* dst);
+std::size_t decode_base64(const char* src, std::size_t n, char* dst);
+
+#endif//BASE64_H
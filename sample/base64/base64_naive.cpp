@@ -0,0 +1,99 @@
+#include "base64_naive.h"
+
+static const char Table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+static const struct Reverse
+{
+    unsigned char value[256];
+
+    Reverse()
+    {
+        for(int i = 0; i < 256; ++i)
+        {
+            value[i] = 0;
+        }
+        for(int i = 0; i < 64; ++i)
+        {
+            value[static_cast<unsigned char>(Table[i])] = static_cast<unsigned char>(i);
+        }
+    }
+} reverse;
+
+static void encode_group(const char* src, char* dst)
+{
+    const unsigned int n = (static_cast<unsigned char>(src[0]) << 16) | (static_cast<unsigned char>(src[1]) << 8) | static_cast<unsigned char>(src[2]);
+    dst[0] = Table[(n >> 18) & 0x3f];
+    dst[1] = Table[(n >> 12) & 0x3f];
+    dst[2] = Table[(n >>  6) & 0x3f];
+    dst[3] = Table[ n        & 0x3f];
+}
+
+std::size_t encode_base64_naive(const char* src, std::size_t n, char* dst)
+{
+    char* d = dst;
+    std::size_t i = 0;
+    for(; i + 3 <= n; i += 3, d += 4)
+    {
+        encode_group(src + i, d);
+    }
+
+    if(i < n)
+    {
+        const char last[3] = { src[i], (i + 1 < n) ? src[i + 1] : '\0', '\0' };
+        encode_group(last, d);
+        d[3] = '=';
+        if(i + 1 == n)
+        {
+            d[2] = '=';
+        }
+        d += 4;
+    }
+
+    return d - dst;
+}
+
+std::size_t decode_base64_naive(const char* src, std::size_t n, char* dst)
+{
+    char* d = dst;
+    for(std::size_t i = 0; i + 4 <= n; i += 4, d += 3)
+    {
+        const unsigned int v = (reverse.value[static_cast<unsigned char>(src[i    ])] << 18) |
+                               (reverse.value[static_cast<unsigned char>(src[i + 1])] << 12) |
+                               (reverse.value[static_cast<unsigned char>(src[i + 2])] <<  6) |
+                                reverse.value[static_cast<unsigned char>(src[i + 3])];
+        d[0] = static_cast<char>((v >> 16) & 0xff);
+        d[1] = static_cast<char>((v >>  8) & 0xff);
+        d[2] = static_cast<char>( v        & 0xff);
+    }
+
+    const std::size_t length = n / 4 * 4;
+    if((length > 0) && (src[length - 1] == '='))
+    {
+        d -= (src[length - 2] == '=') ? 2 : 1;
+    }
+
+    return d - dst;
+}
+
+std::string encode_base64_naive(const std::string& s)
+{
+    std::string result((s.size() + 2) / 3 * 4, '\0');
+    if( ! s.empty())
+    {
+        encode_base64_naive(s.data(), s.size(), &result[0]);
+    }
+    return result;
+}
+
+std::string decode_base64_naive(const std::string& s)
+{
+    std::string result(s.size() / 4 * 3, '\0');
+    if( ! result.empty())
+    {
+        result.resize(decode_base64_naive(s.data(), s.size(), &result[0]));
+    }
+    return result;
+}
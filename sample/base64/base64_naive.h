@@ -0,0 +1,13 @@
+#ifndef BASE64_NAIVE_H
+#define BASE64_NAIVE_H
+
+#include <cstddef>
+#include <string>
+
+std::string encode_base64_naive(const std::string& s);
+std::string decode_base64_naive(const std::string& s);
+
+std::size_t encode_base64_naive(const char* src, std::size_t n, char* dst);
+std::size_t decode_base64_naive(const char* src, std::size_t n, char* dst);
+
+#endif//BASE64_NAIVE_H
@@ -0,0 +1,120 @@
+// g++ -ansi -Wall -O3 -I../.. -o base64_test base64_test.cpp base64.cpp base64_naive.cpp
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+#include "base64_naive.h"
+
+// RFC 4648 section 10
+const char* const Vectors[][2] =
+{
+    { "",       ""         },
+    { "f",      "Zg=="     },
+    { "fo",     "Zm8="     },
+    { "foo",    "Zm9v"     },
+    { "foob",   "Zm9vYg==" },
+    { "fooba",  "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" }
+};
+
+const int VectorCount = sizeof(Vectors) / sizeof(Vectors[0]);
+
+void compare_vectors()
+{
+    std::cout << "compare_vectors:";
+
+    for(int i = 0; i < VectorCount; ++i)
+    {
+        const std::string plain(Vectors[i][0]);
+        const std::string encoded(Vectors[i][1]);
+        assert(encode_base64(plain) == encoded);
+        assert(decode_base64(encoded) == plain);
+        assert(encode_base64_naive(plain) == encoded);
+        assert(decode_base64_naive(encoded) == plain);
+
+        // the functions without allocation write exactly the documented sizes
+        std::vector<char> buffer(encoded.size() + 1, '#');
+        assert(encode_base64(plain.data(), plain.size(), &buffer[0]) == encoded.size());
+        assert(std::string(&buffer[0], encoded.size()) == encoded);
+        assert(buffer[encoded.size()] == '#');
+        assert(decode_base64(encoded.data(), encoded.size(), &buffer[0]) == plain.size());
+        assert(std::string(&buffer[0], plain.size()) == plain);
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_roundtrip()
+{
+    std::cout << "compare_roundtrip:";
+
+    // every byte value at every position of a group, and every length of the last group
+    unsigned int x = 2463534242u;
+    std::string  s;
+    for(int n = 0; n < 300; ++n)
+    {
+        const std::string encoded = encode_base64(s);
+        assert(encoded == encode_base64_naive(s));
+        assert(encoded.size() == (s.size() + 2) / 3 * 4);
+        assert(decode_base64(encoded) == s);
+        assert(decode_base64_naive(encoded) == s);
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        s += static_cast<char>((n < 256) ? n : (x & 0xff));
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_malformed()
+{
+    std::cout << "compare_malformed:";
+
+    // decoding reads whole groups of 4 chars only; a truncated group is ignored
+    assert(decode_base64(std::string("Zm9vYg")) == "foo");
+    assert(decode_base64(std::string("Zm9vY")) == "foo");
+    assert(decode_base64(std::string("Zm9")) == "");
+    assert(decode_base64(std::string("Z")) == "");
+
+    // only the last 2 chars are padding; more '=' never drop bytes of the groups before
+    assert(decode_base64(std::string("====")) == std::string("\0", 1));
+    assert(decode_base64(std::string("Zm9v====")) == std::string("foo\0", 4));
+    assert(decode_base64(std::string("Zm9v===")) == "foo");
+
+    // chars not in the alphabet count as 'A' (0), padding included when it is not at the end
+    assert(decode_base64(std::string("Zm9v!!!!")) == std::string("foo\0\0\0", 6));
+    assert(decode_base64(std::string("Zg==Zm9v")) == std::string("f\0\0foo", 6));
+    assert(decode_base64(std::string("Zm\n9v")) == "f`=");
+
+    // the naive twins behave the same on every malformed input
+    const char* const malformed[] =
+    {
+        "Zm9vYg", "Zm9vY", "Zm9", "Z", "====", "Zm9v====", "Zm9v===", "Zm9v!!!!", "Zg==Zm9v", "Zm\n9v", "=Zm9", "Z=m9v="
+    };
+    for(unsigned int i = 0; i < sizeof(malformed) / sizeof(malformed[0]); ++i)
+    {
+        const std::string s(malformed[i]);
+        assert(decode_base64(s) == decode_base64_naive(s));
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+void test()
+{
+    compare_vectors();
+    compare_roundtrip();
+    compare_malformed();
+}
+
+int main(int, char* [])
+{
+    test();
+
+    return 0;
+}
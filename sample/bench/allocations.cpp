@@ -0,0 +1,160 @@
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <cerrno>
+#include <malloc.h>
+#endif
+
+namespace
+{
+
+std::size_t allocationCount = 0;
+std::size_t allocationBytes = 0;
+
+void record(std::size_t bytes)
+{
+    __sync_fetch_and_add(&allocationCount, 1);
+    __sync_fetch_and_add(&allocationBytes, bytes);
+}
+
+} // namespace
+
+namespace bench
+{
+
+Allocations allocations()
+{
+    const Allocations result = { __sync_fetch_and_add(&allocationCount, 0), __sync_fetch_and_add(&allocationBytes, 0) };
+    return result;
+}
+
+} // namespace bench
+
+#if defined(__GLIBC__)
+
+// glibc exports its allocator under these names, so that malloc can be replaced by forwarding to them;
+// operator new calls malloc and is counted here
+extern "C"
+{
+
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+void* __libc_memalign(std::size_t, std::size_t);
+void  __libc_free(void*);
+
+void* malloc(std::size_t n)
+{
+    record(n);
+    return __libc_malloc(n);
+}
+
+void* calloc(std::size_t count, std::size_t n)
+{
+    record(count * n);
+    return __libc_calloc(count, n);
+}
+
+void* realloc(void* p, std::size_t n)
+{
+    record(n);
+    return __libc_realloc(p, n);
+}
+
+void* memalign(std::size_t alignment, std::size_t n)
+{
+    record(n);
+    return __libc_memalign(alignment, n);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t n)
+{
+    record(n);
+    return __libc_memalign(alignment, n);
+}
+
+int posix_memalign(void** p, std::size_t alignment, std::size_t n)
+{
+    if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    record(n);
+    *p = __libc_memalign(alignment, n);
+    return (*p != 0) ? 0 : ENOMEM;
+}
+
+void free(void* p)
+{
+    __libc_free(p);
+}
+
+} // extern "C"
+
+bool bench::tracks_malloc()
+{
+    return true;
+}
+
+#define BENCH_RECORD_NEW(n)
+
+#else
+
+bool bench::tracks_malloc()
+{
+    return false;
+}
+
+#define BENCH_RECORD_NEW(n) record(n)
+
+#endif
+
+void* operator new(std::size_t n)
+{
+    BENCH_RECORD_NEW(n);
+    void* p = std::malloc((n != 0) ? n : 1);
+    if(p == 0)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t n)
+{
+    return operator new(n);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) throw()
+{
+    BENCH_RECORD_NEW(n);
+    return std::malloc((n != 0) ? n : 1);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t& nothrow) throw()
+{
+    return operator new(n, nothrow);
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw()
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw()
+{
+    std::free(p);
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_ALLOCATIONS_H
+#define BENCH_ALLOCATIONS_H
+
+#include <cstddef>
+
+namespace bench
+{
+
+struct Allocations
+{
+    std::size_t count;
+    std::size_t bytes;
+};
+
+// allocations of all threads since the program started; operator new and, with glibc, malloc
+// and its relatives are interposed by allocations.cpp (link it into the program)
+Allocations allocations();
+
+// true if malloc is interposed, not only operator new
+bool tracks_malloc();
+
+} // namespace bench
+
+#endif//BENCH_ALLOCATIONS_H
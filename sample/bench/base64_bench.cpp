@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include "base64.h"
+#include "base64_naive.h"
+
+#include <string>
+
+namespace
+{
+
+template<std::size_t SIZE>
+const std::string& plain()
+{
+    static std::string s;
+    if(s.empty())
+    {
+        for(std::size_t i = 0; i < SIZE; ++i)
+        {
+            s += static_cast<char>((i * 131 + 7) & 0xff);
+        }
+    }
+    return s;
+}
+
+template<std::size_t SIZE>
+const std::string& encoded()
+{
+    static const std::string s = encode_base64_naive(plain<SIZE>());
+    return s;
+}
+
+template<std::string (*F)(const std::string&), const std::string& (*Input)()>
+void run(std::size_t iterations)
+{
+    const std::string& in = Input();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        const std::string out = F(in);
+        bench::do_not_optimize(out);
+    }
+}
+
+// the inner loops on buffers; these must not allocate
+template<std::size_t (*F)(const char*, std::size_t, char*), const std::string& (*Input)()>
+void run_buffer(std::size_t iterations)
+{
+    static char        out[8192];
+    const std::string& in = Input();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        bench::do_not_optimize(F(in.data(), in.size(), out));
+        bench::clobber_memory();
+    }
+}
+
+const std::size_t Short = 48;
+const std::size_t Long  = 3072;
+
+} // namespace
+
+// width is the size of the plain text; items are input bytes
+BENCH("encode_base64",       (run<encode_base64,       plain<Short> >),   Short, Short,         Short + Short / 3 * 4);
+BENCH("encode_base64_naive", (run<encode_base64_naive, plain<Short> >),   Short, Short,         Short + Short / 3 * 4);
+BENCH("decode_base64",       (run<decode_base64,       encoded<Short> >), Short, Short / 3 * 4, Short + Short / 3 * 4);
+BENCH("decode_base64_naive", (run<decode_base64_naive, encoded<Short> >), Short, Short / 3 * 4, Short + Short / 3 * 4);
+
+BENCH("encode_base64",       (run<encode_base64,       plain<Long> >),    Long,  Long,          Long + Long / 3 * 4);
+BENCH("encode_base64_naive", (run<encode_base64_naive, plain<Long> >),    Long,  Long,          Long + Long / 3 * 4);
+BENCH("decode_base64",       (run<decode_base64,       encoded<Long> >),  Long,  Long / 3 * 4,  Long + Long / 3 * 4);
+BENCH("decode_base64_naive", (run<decode_base64_naive, encoded<Long> >),  Long,  Long / 3 * 4,  Long + Long / 3 * 4);
+
+BENCH_NO_ALLOC("encode_base64_buffer",       (run_buffer<encode_base64,       plain<Long> >),   Long, Long,         Long + Long / 3 * 4);
+BENCH_NO_ALLOC("encode_base64_buffer_naive", (run_buffer<encode_base64_naive, plain<Long> >),   Long, Long,         Long + Long / 3 * 4);
+BENCH_NO_ALLOC("decode_base64_buffer",       (run_buffer<decode_base64,       encoded<Long> >), Long, Long / 3 * 4, Long + Long / 3 * 4);
+BENCH_NO_ALLOC("decode_base64_buffer_naive", (run_buffer<decode_base64_naive, encoded<Long> >), Long, Long / 3 * 4, Long + Long / 3 * 4);
@@ -0,0 +1,354 @@
+#include "baseline.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace bench
+{
+
+namespace
+{
+
+// just enough JSON for results files
+struct Value
+{
+    enum Type
+    {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type                                       type;
+    double                                     number;
+    std::string                                string;
+    std::vector<Value>                         array;
+    std::vector<std::pair<std::string, Value> > object;
+
+    Value() : type(NUL), number(0)
+    {
+    }
+
+    const Value* find(const std::string& key) const
+    {
+        for(std::size_t i = 0; i < object.size(); ++i)
+        {
+            if(object[i].first == key)
+            {
+                return &object[i].second;
+            }
+        }
+        return 0;
+    }
+};
+
+class Parser
+{
+public:
+    explicit Parser(const std::string& text) : text_(text), pos_(0)
+    {
+    }
+
+    bool parse(Value& value)
+    {
+        return parse_value(value) && (skip(), pos_ == text_.size());
+    }
+
+private:
+    void skip()
+    {
+        while(pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+        {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c)
+    {
+        skip();
+        if(pos_ < text_.size() && text_[pos_] == c)
+        {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(const char* word)
+    {
+        const std::string w(word);
+        if(text_.compare(pos_, w.size(), w) == 0)
+        {
+            pos_ += w.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool parse_string(std::string& s)
+    {
+        if( ! consume('"'))
+        {
+            return false;
+        }
+        while(pos_ < text_.size() && text_[pos_] != '"')
+        {
+            if(text_[pos_] == '\\' && pos_ + 1 < text_.size())
+            {
+                ++pos_;
+                switch(text_[pos_])
+                {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'u': s += '?'; pos_ += 4; break; // not used by results files
+                default:  s += text_[pos_]; break;
+                }
+                ++pos_;
+            }
+            else
+            {
+                s += text_[pos_++];
+            }
+        }
+        return consume('"');
+    }
+
+    bool parse_value(Value& value)
+    {
+        skip();
+        if(pos_ >= text_.size())
+        {
+            return false;
+        }
+
+        const char c = text_[pos_];
+        if(c == '{')
+        {
+            value.type = Value::OBJECT;
+            ++pos_;
+            if(consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                std::pair<std::string, Value> member;
+                if( ! parse_string(member.first) || ! consume(':') || ! parse_value(member.second))
+                {
+                    return false;
+                }
+                value.object.push_back(member);
+            }
+            while(consume(','));
+            return consume('}');
+        }
+        if(c == '[')
+        {
+            value.type = Value::ARRAY;
+            ++pos_;
+            if(consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                value.array.push_back(Value());
+                if( ! parse_value(value.array.back()))
+                {
+                    return false;
+                }
+            }
+            while(consume(','));
+            return consume(']');
+        }
+        if(c == '"')
+        {
+            value.type = Value::STRING;
+            return parse_string(value.string);
+        }
+        if(literal("null"))
+        {
+            value.type = Value::NUL;
+            return true;
+        }
+        if(literal("true"))
+        {
+            value.type   = Value::BOOLEAN;
+            value.number = 1;
+            return true;
+        }
+        if(literal("false"))
+        {
+            value.type = Value::BOOLEAN;
+            return true;
+        }
+
+        const char* begin = text_.c_str() + pos_;
+        char*       end;
+        value.type   = Value::NUMBER;
+        value.number = std::strtod(begin, &end);
+        pos_ += end - begin;
+        return end != begin;
+    }
+
+    const std::string& text_;
+    std::size_t        pos_;
+};
+
+} // namespace
+
+bool load_baselines(const std::string& path, std::vector<Baseline>& baselines, std::string& error)
+{
+    std::ifstream in(path.c_str());
+    if( ! in)
+    {
+        error = "can not open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+
+    Value root;
+    if( ! Parser(text.str()).parse(root) || root.type != Value::OBJECT)
+    {
+        error = path + " is not a results file";
+        return false;
+    }
+
+    const Value* benchmarks = root.find("benchmarks");
+    if(benchmarks == 0 || benchmarks->type != Value::ARRAY)
+    {
+        error = path + " has no benchmarks";
+        return false;
+    }
+
+    for(std::size_t i = 0; i < benchmarks->array.size(); ++i)
+    {
+        const Value& entry    = benchmarks->array[i];
+        const Value* function = entry.find("function");
+        const Value* width    = entry.find("width");
+        const Value* cpu      = entry.find("cpu");
+        const Value* samples  = entry.find("samples");
+        if(function == 0 || width == 0 || cpu == 0 || samples == 0 || samples->type != Value::ARRAY)
+        {
+            continue;
+        }
+
+        Baseline baseline;
+        baseline.function = function->string;
+        baseline.width    = width->number;
+        baseline.cpu      = cpu->string;
+        for(std::size_t j = 0; j < samples->array.size(); ++j)
+        {
+            baseline.samples.push_back(samples->array[j].number);
+        }
+        baselines.push_back(baseline);
+    }
+    return true;
+}
+
+double mann_whitney(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const double n1 = static_cast<double>(a.size());
+    const double n2 = static_cast<double>(b.size());
+    if(n1 == 0 || n2 == 0)
+    {
+        return 1;
+    }
+
+    // (value, from a)
+    std::vector<std::pair<double, int> > all;
+    for(std::size_t i = 0; i < a.size(); ++i)
+    {
+        all.push_back(std::make_pair(a[i], 1));
+    }
+    for(std::size_t i = 0; i < b.size(); ++i)
+    {
+        all.push_back(std::make_pair(b[i], 0));
+    }
+    std::sort(all.begin(), all.end());
+
+    // rank sum of a with average ranks for ties
+    const double n     = n1 + n2;
+    double       r1   = 0;
+    double       ties = 0; // sum of t^3 - t
+    for(std::size_t i = 0; i < all.size(); )
+    {
+        std::size_t j = i;
+        while(j < all.size() && all[j].first == all[i].first)
+        {
+            ++j;
+        }
+        const double rank = (i + 1 + j) / 2.0;
+        for(std::size_t k = i; k < j; ++k)
+        {
+            r1 += all[k].second * rank;
+        }
+        const double t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    const double u        = r1 - n1 * (n1 + 1) / 2;
+    const double mean     = n1 * n2 / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if(variance <= 0)
+    {
+        return 1;
+    }
+
+    // continuity correction
+    const double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    return (z <= 0) ? 1 : std::erfc(z / std::sqrt(2.0));
+}
+
+std::string cpu_name()
+{
+    std::ifstream in("/proc/cpuinfo");
+    std::string   line;
+    while(std::getline(in, line))
+    {
+        if(line.compare(0, 10, "model name") == 0)
+        {
+            const std::string::size_type colon = line.find(':');
+            if(colon != std::string::npos && colon + 2 <= line.size())
+            {
+                return line.substr(colon + 2);
+            }
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int brand[12];
+    if(__get_cpuid(0x80000000, &brand[0], &brand[1], &brand[2], &brand[3]) && brand[0] >= 0x80000004)
+    {
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            __get_cpuid(0x80000002 + i, &brand[i * 4], &brand[i * 4 + 1], &brand[i * 4 + 2], &brand[i * 4 + 3]);
+        }
+        std::string name(reinterpret_cast<const char*>(brand), sizeof(brand));
+        name = name.substr(0, name.find('\0'));
+        const std::string::size_type first = name.find_first_not_of(' ');
+        if(first != std::string::npos)
+        {
+            return name.substr(first);
+        }
+    }
+#endif
+
+    return "unknown";
+}
+
+} // namespace bench
@@ -0,0 +1,30 @@
+#ifndef BENCH_BASELINE_H
+#define BENCH_BASELINE_H
+
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+// measured ns/op of one benchmark, as stored in a results file
+struct Baseline
+{
+    std::string         function;
+    double              width;
+    std::string         cpu;
+    std::vector<double> samples;
+};
+
+// reads the "benchmarks" of a results file written with --output
+bool load_baselines(const std::string& path, std::vector<Baseline>& baselines, std::string& error);
+
+// two-sided p-value of the Mann-Whitney U test; normal approximation with tie correction
+double mann_whitney(const std::vector<double>& a, const std::vector<double>& b);
+
+// model name of the CPU, or "unknown"
+std::string cpu_name();
+
+} // namespace bench
+
+#endif//BENCH_BASELINE_H
@@ -0,0 +1,652 @@
+// benchmark runner; see Makefile (make bench)
+//
+// options:
+//   --filter=TEXT      run only benchmarks whose name contains TEXT
+//   --warmup=N         runs discarded before measuring (default 3)
+//   --repetitions=N    measured runs (default 15)
+//   --min-time=MS      minimum duration of one run in milliseconds (default 20)
+//   --counters         also collect hardware performance counters per operation (see counters.h)
+//   --format=FORMAT    table (default), json or csv
+//   --output=FILE      also write the results as json to FILE (a baseline for later runs)
+//   --baseline=FILE    compare with the results in FILE of the same function, width and CPU
+//   --alpha=P          significance level of the comparison (default 0.01)
+//   --max-slowdown=PCT exit with 2 if a significant slowdown exceeds PCT percent
+//   --check-allocations  run every benchmark once without timing and report its allocations;
+//                        exit with 3 if a BENCH_NO_ALLOC benchmark allocates (timed runs check it too)
+
+#include "bench.h"
+#include "allocations.h"
+#include "baseline.h"
+#include "counters.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench
+{
+
+namespace
+{
+
+std::vector<Benchmark>& registry()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Options
+{
+    std::string filter;
+    int         warmup;
+    int         repetitions;
+    double      minTime; // seconds
+    bool        counters;
+    std::string format;
+    std::string output;
+    std::string baseline;
+    double      alpha;
+    double      maxSlowdown; // percent; negative if not checked
+    bool        checkAllocations;
+};
+
+struct Result
+{
+    std::string         name;
+    double              width;
+    std::vector<double> samples; // ns/op of every repetition
+    std::size_t         iterations;
+    double      nsPerItem;     // median
+    double      mad;           // median absolute deviation of nsPerItem
+    double      bytesPerCycle; // 0 if the time stamp counter is not available
+    double      allocationsPerItem;
+    double      allocatedBytesPerItem;
+    bool        noAlloc;
+    double      events[Counters::EVENT_COUNT]; // per operation, median; valid only if counted
+    bool        counted[Counters::EVENT_COUNT];
+};
+
+double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// time stamp counter; it counts reference cycles, not core cycles
+double ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<double>(__rdtsc());
+#else
+    return 0;
+#endif
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const std::size_t n = values.size();
+    return (n % 2 == 1) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+double mad(const std::vector<double>& values, double m)
+{
+    std::vector<double> deviations(values.size());
+    for(std::size_t i = 0; i < values.size(); ++i)
+    {
+        deviations[i] = (values[i] < m) ? (m - values[i]) : (values[i] - m);
+    }
+    return median(deviations);
+}
+
+// the smallest iteration count of which one run takes minTime or more
+std::size_t calibrate(const Benchmark& benchmark, const Options& options)
+{
+    std::size_t iterations = 1;
+    for(;;)
+    {
+        const double start = now();
+        benchmark.function(iterations);
+        const double elapsed = now() - start;
+        if(elapsed >= options.minTime)
+        {
+            return iterations;
+        }
+
+        const double scale = (elapsed > 0) ? (options.minTime / elapsed * 1.2) : 10;
+        iterations = static_cast<std::size_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+    }
+}
+
+void count_allocations(const Benchmark& benchmark, std::size_t iterations, Result& result)
+{
+    const Allocations before = allocations();
+    benchmark.function(iterations);
+    const Allocations after  = allocations();
+
+    const double items = benchmark.items * iterations;
+    result.allocationsPerItem    = (after.count - before.count) / items;
+    result.allocatedBytesPerItem = (after.bytes - before.bytes) / items;
+    result.noAlloc               = benchmark.noAlloc;
+}
+
+Result measure(const Benchmark& benchmark, const Options& options, Counters* counters)
+{
+    Result result;
+    result.name       = benchmark.name;
+    result.width      = benchmark.width;
+    result.iterations = calibrate(benchmark, options);
+
+    for(int i = 0; i < options.warmup; ++i)
+    {
+        benchmark.function(result.iterations);
+    }
+
+    const double        items = benchmark.items * result.iterations;
+    std::vector<double> nsPerItem;
+    std::vector<double> cycles;
+    std::vector<double> events[Counters::EVENT_COUNT];
+    for(int i = 0; i < options.repetitions; ++i)
+    {
+        if(counters != 0)
+        {
+            counters->start();
+        }
+        const double startTicks = ticks();
+        const double start      = now();
+        benchmark.function(result.iterations);
+        const double elapsed    = now() - start;
+        const double tickCount  = ticks() - startTicks;
+        if(counters != 0)
+        {
+            counters->stop();
+            for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+            {
+                events[e].push_back(counters->value(static_cast<Counters::Event>(e)) / items);
+            }
+        }
+
+        nsPerItem.push_back(elapsed * 1e9 / items);
+        cycles.push_back(tickCount);
+    }
+
+    result.samples   = nsPerItem;
+    result.nsPerItem = median(nsPerItem);
+    result.mad       = mad(nsPerItem, result.nsPerItem);
+
+    const double c = median(cycles);
+    result.bytesPerCycle = (c > 0) ? (benchmark.bytes * result.iterations / c) : 0;
+
+    for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+    {
+        result.counted[e] = (counters != 0) && counters->available(static_cast<Counters::Event>(e));
+        result.events[e]  = result.counted[e] ? median(events[e]) : 0;
+    }
+
+    count_allocations(benchmark, result.iterations, result);
+
+    return result;
+}
+
+// the benchmark runs once before, so that lazily initialized data is not counted
+Result check_allocations(const Benchmark& benchmark)
+{
+    Result result;
+    result.name          = benchmark.name;
+    result.width         = benchmark.width;
+    result.iterations    = 1;
+    result.nsPerItem     = 0;
+    result.mad           = 0;
+    result.bytesPerCycle = 0;
+    for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+    {
+        result.counted[e] = false;
+        result.events[e]  = 0;
+    }
+
+    benchmark.function(1);
+    count_allocations(benchmark, 1, result);
+    return result;
+}
+
+void print_table_header(bool counters)
+{
+    std::cout
+        << std::left  << std::setw(28) << "benchmark"
+        << std::right << std::setw(8)  << "width"
+        << std::right << std::setw(12) << "ns/op"
+        << std::right << std::setw(12) << "MAD"
+        << std::right << std::setw(8)  << "MAD%"
+        << std::right << std::setw(14) << "bytes/cycle"
+        << std::right << std::setw(12) << "allocs/op"
+        << std::right << std::setw(12) << "alloc B/op";
+    if(counters)
+    {
+        for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+        {
+            std::cout << std::right << std::setw(15) << Counters::name(static_cast<Counters::Event>(e));
+        }
+        std::cout << std::right << std::setw(8) << "IPC";
+    }
+    std::cout << std::endl;
+}
+
+void print_table(const Result& result, bool counters)
+{
+    std::cout
+        << std::left  << std::setw(28) << result.name
+        << std::fixed << std::setprecision(0)
+        << std::right << std::setw(8)  << result.width
+        << std::setprecision(3)
+        << std::right << std::setw(12) << result.nsPerItem
+        << std::right << std::setw(12) << result.mad
+        << std::setprecision(1)
+        << std::right << std::setw(7)  << (result.mad * 100 / result.nsPerItem) << "%"
+        << std::setprecision(3)
+        << std::right << std::setw(14) << result.bytesPerCycle
+        << std::setprecision(4)
+        << std::right << std::setw(12) << result.allocationsPerItem
+        << std::setprecision(1)
+        << std::right << std::setw(12) << result.allocatedBytesPerItem;
+    if(result.noAlloc && result.allocationsPerItem > 0)
+    {
+        std::cout << "  ALLOCATES";
+    }
+    if(counters)
+    {
+        for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+        {
+            if(result.counted[e])
+            {
+                std::cout << std::right << std::setw(15) << result.events[e];
+            }
+            else
+            {
+                std::cout << std::right << std::setw(15) << "-";
+            }
+        }
+
+        const bool ipc = result.counted[Counters::CYCLES] && result.counted[Counters::INSTRUCTIONS] && result.events[Counters::CYCLES] > 0;
+        if(ipc)
+        {
+            std::cout << std::right << std::setw(8) << (result.events[Counters::INSTRUCTIONS] / result.events[Counters::CYCLES]);
+        }
+        else
+        {
+            std::cout << std::right << std::setw(8) << "-";
+        }
+    }
+    std::cout << std::endl;
+}
+
+void print_csv_header()
+{
+    std::cout << "benchmark,width,iterations,ns_per_op,mad,bytes_per_cycle,allocations_per_op,allocated_bytes_per_op";
+    for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+    {
+        std::cout << "," << Counters::name(static_cast<Counters::Event>(e));
+    }
+    std::cout << std::endl;
+}
+
+// unavailable counters are left empty
+void print_csv(const Result& result)
+{
+    std::cout
+        << std::fixed << std::setprecision(0)
+        << result.name << "," << result.width << "," << result.iterations
+        << std::setprecision(6)
+        << "," << result.nsPerItem << "," << result.mad << "," << result.bytesPerCycle
+        << "," << result.allocationsPerItem << "," << result.allocatedBytesPerItem;
+    for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+    {
+        std::cout << ",";
+        if(result.counted[e])
+        {
+            std::cout << result.events[e];
+        }
+    }
+    std::cout << std::endl;
+}
+
+// unavailable counters are null; results are keyed by function, width and cpu
+void print_json(std::ostream& out, const std::vector<Result>& results, const std::string& cpu, const Counters* counters)
+{
+    out << "{" << std::endl;
+    out << "  \"cpu\": \"" << cpu << "\"," << std::endl;
+    if(counters != 0 && ! counters->error().empty())
+    {
+        out << "  \"counters_error\": \"" << counters->error() << "\"," << std::endl;
+    }
+    out << "  \"benchmarks\": [" << std::endl;
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        out
+            << std::fixed << std::setprecision(6)
+            << "    {\"function\": \"" << result.name << "\""
+            << ", \"width\": " << std::setprecision(0) << result.width << std::setprecision(6)
+            << ", \"cpu\": \"" << cpu << "\""
+            << ", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": " << result.nsPerItem
+            << ", \"mad\": " << result.mad
+            << ", \"bytes_per_cycle\": " << result.bytesPerCycle
+            << ", \"allocations_per_op\": " << result.allocationsPerItem
+            << ", \"allocated_bytes_per_op\": " << result.allocatedBytesPerItem
+            << ", \"samples\": [";
+        for(std::size_t j = 0; j < result.samples.size(); ++j)
+        {
+            out << ((j == 0) ? "" : ", ") << result.samples[j];
+        }
+        out << "]";
+        if(counters != 0)
+        {
+            out << ", \"counters\": {";
+            for(int e = 0; e < Counters::EVENT_COUNT; ++e)
+            {
+                out << ((e == 0) ? "" : ", ") << "\"" << Counters::name(static_cast<Counters::Event>(e)) << "\": ";
+                if(result.counted[e])
+                {
+                    out << result.events[e];
+                }
+                else
+                {
+                    out << "null";
+                }
+            }
+            out << "}";
+        }
+        out << "}" << ((i + 1 < results.size()) ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl << "}" << std::endl;
+}
+
+// prints one line per result with a baseline; returns the number of significant slowdowns beyond maxSlowdown
+int compare(const std::vector<Result>& results, const std::vector<Baseline>& baselines, const std::string& cpu, const Options& options)
+{
+    std::cerr
+        << std::left  << std::setw(28) << "benchmark"
+        << std::right << std::setw(8)  << "width"
+        << std::right << std::setw(12) << "baseline"
+        << std::right << std::setw(12) << "ns/op"
+        << std::right << std::setw(9)  << "change"
+        << std::right << std::setw(10) << "p"
+        << "  verdict" << std::endl;
+
+    int regressions = 0;
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Result&   result   = results[i];
+        const Baseline* baseline = 0;
+        for(std::size_t j = 0; j < baselines.size() && baseline == 0; ++j)
+        {
+            if(baselines[j].function == result.name && baselines[j].width == result.width && baselines[j].cpu == cpu)
+            {
+                baseline = &baselines[j];
+            }
+        }
+
+        std::cerr << std::left << std::setw(28) << result.name << std::right << std::setw(8) << std::fixed << std::setprecision(0) << result.width;
+        if(baseline == 0 || baseline->samples.empty())
+        {
+            std::cerr << std::right << std::setw(12) << "-" << std::endl;
+            continue;
+        }
+
+        const double before = median(baseline->samples);
+        const double change = (result.nsPerItem - before) * 100 / before;
+        const double p      = mann_whitney(baseline->samples, result.samples);
+
+        const char* verdict = "same";
+        if(p < options.alpha)
+        {
+            verdict = (change < 0) ? "faster" : "slower";
+            if(change > 0 && options.maxSlowdown >= 0 && change > options.maxSlowdown)
+            {
+                verdict = "SLOWER";
+                ++regressions;
+            }
+        }
+
+        std::cerr
+            << std::fixed << std::setprecision(3)
+            << std::right << std::setw(12) << before
+            << std::right << std::setw(12) << result.nsPerItem
+            << std::setprecision(1)
+            << std::right << std::setw(8)  << change << "%"
+            << std::setprecision(4)
+            << std::right << std::setw(10) << p
+            << "  " << verdict << std::endl;
+    }
+    return regressions;
+}
+
+// returns false if a BENCH_NO_ALLOC benchmark allocates
+bool check_allocations(const std::vector<Benchmark>& benchmarks, const Options& options)
+{
+    if( ! tracks_malloc())
+    {
+        std::cerr << "malloc is not interposed on this platform; counting operator new only" << std::endl;
+    }
+
+    std::cout
+        << std::left  << std::setw(28) << "benchmark"
+        << std::right << std::setw(8)  << "width"
+        << std::right << std::setw(12) << "allocs/op"
+        << std::right << std::setw(12) << "alloc B/op"
+        << std::endl;
+
+    bool ok = true;
+    for(std::size_t i = 0; i < benchmarks.size(); ++i)
+    {
+        if(std::string(benchmarks[i].name).find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        const Result result = check_allocations(benchmarks[i]);
+        std::cout
+            << std::left  << std::setw(28) << result.name
+            << std::fixed << std::setprecision(0)
+            << std::right << std::setw(8)  << result.width
+            << std::setprecision(4)
+            << std::right << std::setw(12) << result.allocationsPerItem
+            << std::setprecision(1)
+            << std::right << std::setw(12) << result.allocatedBytesPerItem;
+        if(result.noAlloc)
+        {
+            const bool allocates = (result.allocationsPerItem > 0);
+            std::cout << (allocates ? "  FAIL (must not allocate)" : "  ok");
+            ok = ok && ! allocates;
+        }
+        std::cout << std::endl;
+    }
+    return ok;
+}
+
+bool parse(const char* arg, const char* name, const char*& value)
+{
+    const std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0)
+    {
+        value = arg + length;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+Registrar::Registrar(const char* name, Function function, double width, double items, double bytes, bool noAlloc)
+{
+    const Benchmark benchmark = { name, function, width, items, bytes, noAlloc };
+    registry().push_back(benchmark);
+}
+
+} // namespace bench
+
+int main(int argc, char* argv[])
+{
+    bench::Options options;
+    options.warmup      = 3;
+    options.repetitions = 15;
+    options.minTime     = 0.02;
+    options.counters    = false;
+    options.format      = "table";
+    options.alpha       = 0.01;
+    options.maxSlowdown = -1;
+
+    options.checkAllocations = false;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value;
+        if(bench::parse(argv[i], "--filter=", value))
+        {
+            options.filter = value;
+        }
+        else if(bench::parse(argv[i], "--warmup=", value))
+        {
+            options.warmup = std::atoi(value);
+        }
+        else if(bench::parse(argv[i], "--repetitions=", value))
+        {
+            options.repetitions = std::max(1, std::atoi(value));
+        }
+        else if(bench::parse(argv[i], "--min-time=", value))
+        {
+            options.minTime = std::atof(value) / 1000;
+        }
+        else if(std::strcmp(argv[i], "--counters") == 0)
+        {
+            options.counters = true;
+        }
+        else if(bench::parse(argv[i], "--format=", value) &&
+                (std::strcmp(value, "table") == 0 || std::strcmp(value, "json") == 0 || std::strcmp(value, "csv") == 0))
+        {
+            options.format = value;
+        }
+        else if(std::strcmp(argv[i], "--check-allocations") == 0)
+        {
+            options.checkAllocations = true;
+        }
+        else if(bench::parse(argv[i], "--output=", value))
+        {
+            options.output = value;
+        }
+        else if(bench::parse(argv[i], "--baseline=", value))
+        {
+            options.baseline = value;
+        }
+        else if(bench::parse(argv[i], "--alpha=", value))
+        {
+            options.alpha = std::atof(value);
+        }
+        else if(bench::parse(argv[i], "--max-slowdown=", value))
+        {
+            options.maxSlowdown = std::atof(value);
+        }
+        else
+        {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<bench::Baseline> baselines;
+    if( ! options.baseline.empty())
+    {
+        std::string error;
+        if( ! bench::load_baselines(options.baseline, baselines, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string cpu = bench::cpu_name();
+
+    bench::Counters  counters;
+    bench::Counters* active = options.counters ? &counters : 0;
+    if(active != 0 && ! counters.available())
+    {
+        std::cerr << "counters are not available (" << counters.error() << "); measuring time only" << std::endl;
+    }
+
+    const std::vector<bench::Benchmark>& benchmarks = bench::registry();
+    if(options.checkAllocations)
+    {
+        return bench::check_allocations(benchmarks, options) ? 0 : 3;
+    }
+
+    if(options.format == "table")
+    {
+        bench::print_table_header(options.counters);
+    }
+    else if(options.format == "csv")
+    {
+        bench::print_csv_header();
+    }
+
+    std::vector<bench::Result> results;
+    for(std::size_t i = 0; i < benchmarks.size(); ++i)
+    {
+        if(std::string(benchmarks[i].name).find(options.filter) != std::string::npos)
+        {
+            const bench::Result result = bench::measure(benchmarks[i], options, active);
+            if(options.format == "table")
+            {
+                bench::print_table(result, options.counters);
+            }
+            else if(options.format == "csv")
+            {
+                bench::print_csv(result);
+            }
+            results.push_back(result);
+        }
+    }
+
+    if(options.format == "json")
+    {
+        bench::print_json(std::cout, results, cpu, active);
+    }
+
+    if( ! options.output.empty())
+    {
+        std::ofstream out(options.output.c_str());
+        bench::print_json(out, results, cpu, active);
+        if( ! out)
+        {
+            std::cerr << "can not write " << options.output << std::endl;
+            return 1;
+        }
+    }
+
+    // the comparison goes to stderr, so that stdout stays machine-readable
+    if( ! options.baseline.empty() && bench::compare(results, baselines, cpu, options) > 0)
+    {
+        return 2;
+    }
+
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        if(results[i].noAlloc && results[i].allocationsPerItem > 0)
+        {
+            std::cerr << results[i].name << " allocates" << std::endl;
+            return 3;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstddef>
+
+namespace bench
+{
+
+// a benchmark runs its operation `iterations` times
+typedef void (*Function)(std::size_t iterations);
+
+struct Benchmark
+{
+    const char* name;
+    Function    function;
+    double      width; // problem size (elements, pixels of a row, bytes); a key of results with name
+    double      items; // operations per iteration
+    double      bytes; // bytes read and written per iteration
+    bool        noAlloc; // must not allocate (checked by the runner)
+};
+
+struct Registrar
+{
+    Registrar(const char* name, Function function, double width, double items, double bytes, bool noAlloc = false);
+};
+
+// keeps value (and the memory it depends on) alive without the cost of a volatile access
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<const volatile char*>(static_cast<const volatile void*>(&value)));
+#endif
+}
+
+// forces the compiler to assume all memory was read and written
+inline void clobber_memory()
+{
+#if defined(__GNUC__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b)  BENCH_CONCAT_(a, b)
+
+// BENCH(name, function, width, items, bytes) registers function as a benchmark
+#define BENCH(name, function, width, items, bytes) \
+    static const bench::Registrar BENCH_CONCAT(bench_registrar_, __LINE__)(name, function, width, items, bytes)
+
+// BENCH_NO_ALLOC(...) registers a hot path; the runner fails if it allocates
+#define BENCH_NO_ALLOC(name, function, width, items, bytes) \
+    static const bench::Registrar BENCH_CONCAT(bench_registrar_, __LINE__)(name, function, width, items, bytes, true)
+
+#endif//BENCH_H
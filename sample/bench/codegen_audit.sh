@@ -0,0 +1,108 @@
+#!/bin/sh
+# compares the number of instructions of every function of the Bits samples
+# with its twin in the naive sources (function name + "_naive"):
+#   sample/color_conv/color_conv.cpp  and  sample/color_conv/color_conv_naive.cpp
+#   sample/base64/base64.cpp          and  sample/base64/base64_naive.cpp
+# fails if the excess of a function (Bits - naive) is larger than the one recorded
+# in the baseline, or if a function has no recorded excess.
+#
+# usage: codegen_audit.sh [--record]
+#   --record  writes the current excesses to the baseline instead of comparing
+#
+# environment:
+#   CXX       compiler (default g++)
+#   CXXFLAGS  extra flags (e.g. -march=native)
+#   LEVELS    optimization levels (default "-O2 -O3")
+#   BASELINE  recorded excesses (default codegen_audit.baseline next to this script)
+
+set -e
+
+CXX=${CXX:-g++}
+LEVELS=${LEVELS:-"-O2 -O3"}
+BASELINE=${BASELINE:-$(cd "$(dirname "$0")" && pwd)/codegen_audit.baseline}
+RECORD=0
+if [ "$1" = "--record" ]; then
+    RECORD=1
+fi
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+PAIRS="color_conv/color_conv.cpp:color_conv/color_conv_naive.cpp base64/base64.cpp:base64/base64_naive.cpp"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+TAB=$(printf '\t')
+
+# prints "function<TAB>instructions" for every function in an object file; overloads are
+# told apart by their parameters; -ffunction-sections keeps alignment padding out of the functions
+count() {
+    objdump -d -C --no-show-raw-insn "$1" | awk '
+        /^[0-9a-f]+ <.*>:$/ {
+            name = $0
+            sub(/^[0-9a-f]+ </, "", name)
+            sub(/>:$/, "", name)
+            gsub(/std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >/, "std::string", name)
+            next
+        }
+        /^ *[0-9a-f]+:\t/ && name != "" { n[name]++ }
+        END { for(f in n) printf "%s\t%d\n", f, n[f] }'
+}
+
+: > "$WORK/excess.txt"
+for level in $LEVELS; do
+    : > "$WORK/joined.txt"
+    for pair in $PAIRS; do
+        bits=${pair%%:*}
+        naive=${pair#*:}
+        $CXX $level $CXXFLAGS -ffunction-sections -I"$ROOT" -c "$ROOT/sample/$bits"  -o "$WORK/bits.o"
+        $CXX $level $CXXFLAGS -ffunction-sections -I"$ROOT" -c "$ROOT/sample/$naive" -o "$WORK/naive.o"
+        count "$WORK/bits.o"  | sort -t "$TAB" -k 1,1 > "$WORK/bits.txt"
+        count "$WORK/naive.o" | sed 's/_naive(/(/' | sort -t "$TAB" -k 1,1 > "$WORK/naive.txt"
+        join -t "$TAB" "$WORK/bits.txt" "$WORK/naive.txt" >> "$WORK/joined.txt"
+    done
+    if [ ! -s "$WORK/joined.txt" ]; then
+        echo "no functions to compare at $level" >&2
+        exit 1
+    fi
+    awk -F "$TAB" -v level="$level" '{ printf "%s\t%s\t%d\t%d\t%d\n", level, $1, $2, $3, $2 - $3 }' "$WORK/joined.txt" >> "$WORK/excess.txt"
+done
+
+if [ $RECORD -ne 0 ]; then
+    {
+        echo "# excess instructions of the Bits functions over their naive twins; written by codegen_audit.sh --record"
+        echo "# $($CXX --version | head -n 1)"
+        awk -F "$TAB" '{ printf "%s\t%s\t%d\n", $1, $2, $5 }' "$WORK/excess.txt"
+    } > "$BASELINE"
+    echo "recorded $(wc -l < "$WORK/excess.txt") excesses in $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline $BASELINE; run codegen_audit.sh --record" >&2
+    exit 1
+fi
+
+printf '%-6s %-52s %6s %6s %6s %8s\n' level function bits naive excess baseline
+if ! awk -F "$TAB" '
+    FNR == NR {
+        if($0 !~ /^#/) baseline[$1 FS $2] = $3
+        next
+    }
+    {
+        key = $1 FS $2
+        if(!(key in baseline))
+        {
+            limit = "-"
+            mark  = "  FAIL (not recorded)"
+            failed = 1
+        }
+        else
+        {
+            limit = baseline[key]
+            mark  = ($5 > limit) ? "  FAIL" : (($5 < limit) ? "  (below baseline)" : "")
+            if($5 > limit) failed = 1
+        }
+        printf "%-6s %-52s %6d %6d %6d %8s%s\n", $1, $2, $3, $4, $5, limit, mark
+    }
+    END { exit failed }' "$BASELINE" "$WORK/excess.txt"; then
+    echo "Bits functions exceed their naive twins by more than the baseline; fix the code generation or re-record with --record" >&2
+    exit 1
+fi
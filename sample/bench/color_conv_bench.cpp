@@ -0,0 +1,326 @@
+#include "bench.h"
+
+#include "color_conv.h"
+#include "color_conv_naive.h"
+#include "blit.h"
+#include "blend.h"
+#include "palette.h"
+#include "ycbcr.h"
+#include "expand.h"
+#include "planar.h"
+
+#include <vector>
+
+namespace
+{
+
+const int N = 4096;
+
+enum Source
+{
+    RGB555,
+    RGB565,
+    RGB888
+};
+
+struct Inputs
+{
+    unsigned int values[3][N];
+    unsigned int r[N];
+    unsigned int g[N];
+    unsigned int b[N];
+
+    Inputs()
+    {
+        unsigned int x = 2463534242u;
+        for(int i = 0; i < N; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            values[RGB555][i] = x & 0x7fff;
+            values[RGB565][i] = x & 0xffff;
+            values[RGB888][i] = x & 0xffffff;
+            r[i] = x & 0xff;
+            g[i] = (x >> 8) & 0xff;
+            b[i] = (x >> 16) & 0xff;
+        }
+    }
+};
+
+const Inputs& inputs()
+{
+    static const Inputs in;
+    return in;
+}
+
+unsigned int outputs[N];
+
+template<unsigned int (*F)(unsigned int), Source S>
+void convert(std::size_t iterations)
+{
+    const unsigned int* in = inputs().values[S];
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int i = 0; i < N; ++i)
+        {
+            outputs[i] = F(in[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+template<unsigned int (*F)(unsigned int, unsigned int, unsigned int)>
+void make(std::size_t iterations)
+{
+    const Inputs& in = inputs();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int i = 0; i < N; ++i)
+        {
+            outputs[i] = F(in.r[i], in.g[i], in.b[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+// images for the row kernels
+const int Width  = 640;
+const int Height = 480;
+
+struct Images
+{
+    std::vector<unsigned int>   rgb888;
+    std::vector<unsigned short> rgb565;
+    std::vector<unsigned short> rgb565Src;
+    std::vector<unsigned char>  alpha;
+    std::vector<unsigned char>  bytes;
+    std::vector<unsigned char>  planes;
+    std::vector<unsigned char>  indexed;
+    InverseTable                table;
+
+    Images() :
+        rgb888(Width * Height),
+        rgb565(Width * Height),
+        rgb565Src(Width * Height),
+        alpha(Width * Height),
+        bytes(Width * Height * 2),
+        planes(Width * Height * 2), // 16 planes
+        indexed(Width * Height)
+    {
+        for(int i = 0; i < Width * Height; ++i)
+        {
+            const unsigned int x = inputs().values[RGB888][i % N];
+            rgb888[i]    = x;
+            rgb565Src[i] = static_cast<unsigned short>(rgb888to565(x));
+            alpha[i]     = static_cast<unsigned char>(x >> 5);
+            bytes[i]     = static_cast<unsigned char>(x);
+            bytes[i + Width * Height] = static_cast<unsigned char>(x >> 8);
+        }
+
+        Palette palette;
+        build_palette(&rgb888[0], Width * Height, 256, palette);
+        build_inverse_table(palette, table);
+    }
+};
+
+Images& images()
+{
+    static Images in;
+    return in;
+}
+
+void blit_none(std::size_t iterations)
+{
+    Images& in = images();
+    const Surface888 src  = { &in.rgb888[0], Width, Height, Width };
+    const Surface565 dst  = { &in.rgb565[0], Width, Height, Width };
+    const BlitRect   rect = { 0, 0, Width, Height };
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        blit_rgb888to565(src, rect, dst, rect, BLIT_SCALE_NONE);
+        bench::clobber_memory();
+    }
+}
+
+void blit_box2(std::size_t iterations)
+{
+    Images& in = images();
+    const Surface888 src  = { &in.rgb888[0], Width, Height, Width };
+    const Surface565 dst  = { &in.rgb565[0], Width / 2, Height / 2, Width / 2 };
+    const BlitRect   rect = { 0, 0, Width, Height };
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        blit_rgb888to565(src, rect, dst, rect, BLIT_SCALE_BOX2);
+        bench::clobber_memory();
+    }
+}
+
+void blend_const(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        blend_rgb565_const(&in.rgb565[0], &in.rgb565Src[0], Width * Height, 100);
+        bench::clobber_memory();
+    }
+}
+
+void blend_alpha(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        blend_rgb565_alpha(&in.rgb565[0], &in.rgb565Src[0], &in.alpha[0], Width * Height);
+        bench::clobber_memory();
+    }
+}
+
+void palette_map(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        map_to_indexed(&in.rgb888[0], Width * Height, in.table, &in.indexed[0]);
+        bench::clobber_memory();
+    }
+}
+
+void palette_build(std::size_t iterations)
+{
+    Images& in = images();
+    Palette palette;
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        build_palette(&in.rgb888[0], Width * Height, 256, palette);
+        bench::clobber_memory();
+    }
+}
+
+// the image as 4 frames of a quarter each
+void palette_quantize(std::size_t iterations)
+{
+    Images& in = images();
+    const int            frameCount = 4;
+    const int            n          = Width * Height / frameCount;
+    const unsigned int*  frames[frameCount];
+    unsigned char*       indexed[frameCount];
+    Palette              palettes[frameCount];
+    for(int f = 0; f < frameCount; ++f)
+    {
+        frames[f]  = &in.rgb888[f * n];
+        indexed[f] = &in.indexed[f * n];
+    }
+    for(std::size_t k = 0; k < iterations; ++k)
+    {
+        quantize_frames(frames, frameCount, n, 256, palettes, indexed);
+        bench::clobber_memory();
+    }
+}
+
+void i420_565(std::size_t iterations)
+{
+    Images& in = images();
+    const unsigned char* y  = &in.bytes[0];
+    const unsigned char* cb = y + Width * Height;
+    const unsigned char* cr = cb + Width * Height / 4;
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        i420_to_rgb565(y, Width, cb, cr, Width / 2, Width, Height, &in.rgb565[0], Width, YCBCR_BT601);
+        bench::clobber_memory();
+    }
+}
+
+void rgb888_nv12(std::size_t iterations)
+{
+    Images& in = images();
+    unsigned char* y    = &in.bytes[0];
+    unsigned char* cbcr = y + Width * Height;
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        rgb888_to_nv12(&in.rgb888[0], Width, Width, Height, y, Width, cbcr, Width, YCBCR_BT601);
+        bench::clobber_memory();
+    }
+}
+
+void expand_1bpp(std::size_t iterations)
+{
+    Images& in = images();
+    const unsigned short palette[] = { 0x0000, 0xffff };
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int row = 0; row < Height; ++row)
+        {
+            expand_1bpp_to_rgb565(&in.bytes[row * Width / 8], Width, palette, &in.rgb565[row * Width]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+void chunky8_planar(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        chunky8_to_planar(&in.bytes[0], Width * Height, 8, &in.planes[0], Width * Height / 8);
+        bench::clobber_memory();
+    }
+}
+
+void chunky16_planar(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        chunky16_to_planar(&in.rgb565Src[0], Width * Height, 16, &in.planes[0], Width * Height / 8);
+        bench::clobber_memory();
+    }
+}
+
+void planar_chunky16(std::size_t iterations)
+{
+    Images& in = images();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        planar_to_chunky16(&in.planes[0], Width * Height / 8, Width * Height, 16, &in.rgb565[0]);
+        bench::clobber_memory();
+    }
+}
+
+const double Pixels = Width * Height;
+
+} // namespace
+
+BENCH_NO_ALLOC("make_rgb555",       (make<make_rgb555>),       N, N, N * 16);
+BENCH_NO_ALLOC("make_rgb555_naive", (make<make_rgb555_naive>), N, N, N * 16);
+BENCH_NO_ALLOC("make_rgb565",       (make<make_rgb565>),       N, N, N * 16);
+BENCH_NO_ALLOC("make_rgb565_naive", (make<make_rgb565_naive>), N, N, N * 16);
+BENCH_NO_ALLOC("make_rgb888",       (make<make_rgb888>),       N, N, N * 16);
+BENCH_NO_ALLOC("make_rgb888_naive", (make<make_rgb888_naive>), N, N, N * 16);
+
+BENCH_NO_ALLOC("rgb555to565",       (convert<rgb555to565,       RGB555>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb555to565_naive", (convert<rgb555to565_naive, RGB555>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb555to888",       (convert<rgb555to888,       RGB555>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb555to888_naive", (convert<rgb555to888_naive, RGB555>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb565to555",       (convert<rgb565to555,       RGB565>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb565to555_naive", (convert<rgb565to555_naive, RGB565>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb565to888",       (convert<rgb565to888,       RGB565>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb565to888_naive", (convert<rgb565to888_naive, RGB565>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb888to555",       (convert<rgb888to555,       RGB888>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb888to555_naive", (convert<rgb888to555_naive, RGB888>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb888to565",       (convert<rgb888to565,       RGB888>), N, N, N * 8);
+BENCH_NO_ALLOC("rgb888to565_naive", (convert<rgb888to565_naive, RGB888>), N, N, N * 8);
+
+BENCH_NO_ALLOC("blit_rgb888to565_none", blit_none,      Width, Pixels,     Pixels * 6);
+BENCH_NO_ALLOC("blit_rgb888to565_box2", blit_box2,      Width, Pixels / 4, Pixels * 4 + Pixels / 2);
+BENCH_NO_ALLOC("blend_rgb565_const",    blend_const,    Width, Pixels,     Pixels * 6);
+BENCH_NO_ALLOC("blend_rgb565_alpha",    blend_alpha,    Width, Pixels,     Pixels * 7);
+BENCH_NO_ALLOC("map_to_indexed",        palette_map,    Width, Pixels,     Pixels * 5);
+BENCH("build_palette",                  palette_build,  Width, Pixels,     Pixels * 4);
+BENCH("quantize_frames",                palette_quantize, Width, Pixels,   Pixels * 9);
+BENCH_NO_ALLOC("i420_to_rgb565",        i420_565,       Width, Pixels,     Pixels * 3.5);
+BENCH_NO_ALLOC("rgb888_to_nv12",        rgb888_nv12,    Width, Pixels,     Pixels * 5.5);
+BENCH_NO_ALLOC("expand_1bpp_to_rgb565", expand_1bpp,    Width, Pixels,     Pixels / 8 + Pixels * 2);
+BENCH_NO_ALLOC("chunky8_to_planar",     chunky8_planar, Width, Pixels,     Pixels * 2);
+BENCH_NO_ALLOC("chunky16_to_planar",    chunky16_planar, Width, Pixels,    Pixels * 4);
+BENCH_NO_ALLOC("planar_to_chunky16",    planar_chunky16, Width, Pixels,    Pixels * 4);
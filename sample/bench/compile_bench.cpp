@@ -0,0 +1,294 @@
+// compile-time benchmark; see Makefile (make compile-bench)
+//
+// generates a translation unit with K layouts of M fields each, compiles it and reports
+// the compile time (median), the peak resident set size of the compiler and
+// the number of Bits class templates instantiated (from -fdump-lang-class).
+//
+// options:
+//   --layouts=K        number of layouts (default 200)
+//   --fields=M         fields per layout, 1..32 (default 6)
+//   --repetitions=N    timed compilations (default 3)
+//   --compiler=CXX     compiler (default g++)
+//   --flags=FLAGS      compiler flags (default -O2)
+//   --include=DIR      directory of Bits.h (default .)
+//   --keep=PATH        keep the generated source as PATH
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+struct Options
+{
+    int         layouts;
+    int         fields;
+    int         repetitions;
+    std::string compiler;
+    std::string flags;
+    std::string include;
+    std::string keep;
+};
+
+// field j of layout k; sizes vary so that layouts instantiate different packs, and a layout fits in 32 bits
+// (wider packs are MultiByte, which can not be assigned from an integer)
+int field_size(int k, int j, int fields)
+{
+    const int limit = std::max(1, std::min(16, 32 / fields));
+
+    unsigned int hash = static_cast<unsigned int>(k * 64 + j);
+    hash = (hash ^ (hash >> 16)) * 0x85ebca6bu;
+    hash = (hash ^ (hash >> 13)) * 0xc2b2ae35u;
+    hash =  hash ^ (hash >> 16);
+    return 1 + static_cast<int>(hash % limit);
+}
+
+void generate(const Options& options, std::ostream& out)
+{
+    out << "#include \"Bits.h\"\n"
+           "using namespace emattsan::bits;\n";
+
+    for(int k = 0; k < options.layouts; ++k)
+    {
+        out << "\nunsigned int layout_" << k << "(unsigned int value)\n{\n";
+        for(int j = 0; j < options.fields; ++j)
+        {
+            out << "    Bits<" << field_size(k, j, options.fields) << "> f" << j << ";\n";
+        }
+
+        // unpack in one order and pack in the reverse order
+        out << "    (";
+        for(int j = 0; j < options.fields; ++j)
+        {
+            out << ((j == 0) ? "" : ", ") << "f" << j;
+        }
+        out << ") = value;\n    return (";
+        for(int j = options.fields - 1; j >= 0; --j)
+        {
+            out << "f" << j << ((j == 0) ? "" : ", ");
+        }
+        out << ");\n}\n";
+    }
+}
+
+std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> words;
+    std::istringstream in(s);
+    std::string word;
+    while(in >> word)
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+struct Run
+{
+    bool   ok;
+    double seconds;
+    long   maxRssKb;
+};
+
+// runs the command (no shell) and measures it with wait4
+Run run(const std::vector<std::string>& command)
+{
+    Run result = { false, 0, 0 };
+
+    std::vector<char*> argv;
+    for(std::size_t i = 0; i < command.size(); ++i)
+    {
+        argv.push_back(const_cast<char*>(command[i].c_str()));
+    }
+    argv.push_back(0);
+
+    timeval start;
+    gettimeofday(&start, 0);
+
+    const pid_t pid = fork();
+    if(pid < 0)
+    {
+        return result;
+    }
+    if(pid == 0)
+    {
+        execvp(argv[0], &argv[0]);
+        std::perror(argv[0]);
+        _exit(127);
+    }
+
+    int    status;
+    rusage usage;
+    if(wait4(pid, &status, 0, &usage) != pid)
+    {
+        return result;
+    }
+
+    timeval end;
+    gettimeofday(&end, 0);
+
+    result.ok       = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    result.seconds  = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+    result.maxRssKb = usage.ru_maxrss;
+    return result;
+}
+
+int count_lines(const std::string& path, const std::string& prefix)
+{
+    std::ifstream in(path.c_str());
+    std::string   line;
+    int           count = 0;
+    while(std::getline(in, line))
+    {
+        if(line.compare(0, prefix.size(), prefix) == 0)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool parse(const char* arg, const char* name, const char*& value)
+{
+    const std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0)
+    {
+        value = arg + length;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    options.layouts     = 200;
+    options.fields      = 6;
+    options.repetitions = 3;
+    options.compiler    = "g++";
+    options.flags       = "-O2";
+    options.include     = ".";
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value;
+        if(parse(argv[i], "--layouts=", value))
+        {
+            options.layouts = std::max(1, std::atoi(value));
+        }
+        else if(parse(argv[i], "--fields=", value))
+        {
+            options.fields = std::max(1, std::min(32, std::atoi(value)));
+        }
+        else if(parse(argv[i], "--repetitions=", value))
+        {
+            options.repetitions = std::max(1, std::atoi(value));
+        }
+        else if(parse(argv[i], "--compiler=", value))
+        {
+            options.compiler = value;
+        }
+        else if(parse(argv[i], "--flags=", value))
+        {
+            options.flags = value;
+        }
+        else if(parse(argv[i], "--include=", value))
+        {
+            options.include = value;
+        }
+        else if(parse(argv[i], "--keep=", value))
+        {
+            options.keep = value;
+        }
+        else
+        {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    char directory[] = "/tmp/compile_bench.XXXXXX";
+    if(mkdtemp(directory) == 0)
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string source = options.keep.empty() ? (std::string(directory) + "/layouts.cpp") : options.keep;
+    const std::string object = std::string(directory) + "/layouts.o";
+    const std::string dump   = std::string(directory) + "/layouts.class";
+
+    {
+        std::ofstream out(source.c_str());
+        generate(options, out);
+    }
+
+    std::vector<std::string> command;
+    command.push_back(options.compiler);
+    const std::vector<std::string> flags = split(options.flags);
+    command.insert(command.end(), flags.begin(), flags.end());
+    command.push_back("-I" + options.include);
+    command.push_back("-c");
+    command.push_back(source);
+    command.push_back("-o");
+    command.push_back(object);
+
+    std::vector<double> seconds;
+    long                maxRssKb = 0;
+    for(int i = 0; i < options.repetitions; ++i)
+    {
+        const Run r = run(command);
+        if( ! r.ok)
+        {
+            std::cerr << "compilation failed" << std::endl;
+            return 1;
+        }
+        seconds.push_back(r.seconds);
+        maxRssKb = std::max(maxRssKb, r.maxRssKb);
+    }
+    std::sort(seconds.begin(), seconds.end());
+
+    // one more compilation, untimed, for the class dump
+    command.push_back("-fdump-lang-class=" + dump);
+    const bool dumped = run(command).ok;
+
+    std::cout
+        << "layouts:        " << options.layouts << "\n"
+        << "fields:         " << options.fields << "\n"
+        << "compile time:   " << std::fixed << std::setprecision(3) << seconds[seconds.size() / 2] << " s (median of " << seconds.size() << ")\n"
+        << "peak RSS:       " << maxRssKb << " KB\n";
+    if(dumped)
+    {
+        std::cout
+            << "Bits classes:   " << count_lines(dump, "Class emattsan::") << "\n"
+            << "all classes:    " << count_lines(dump, "Class ") << "\n";
+    }
+    else
+    {
+        std::cout << "classes:        unavailable (the compiler does not support -fdump-lang-class)\n";
+    }
+
+    std::remove(object.c_str());
+    std::remove(dump.c_str());
+    if(options.keep.empty())
+    {
+        std::remove(source.c_str());
+    }
+    rmdir(directory);
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include "counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace bench
+{
+
+namespace
+{
+
+#if defined(__linux__)
+
+// retired (AMD) or issued (Intel) micro-operations; there is no generic event for them
+bool uops_config(unsigned long long& config)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if(__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    if(ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e) // GenuineIntel
+    {
+        config = 0x010e; // UOPS_ISSUED.ANY
+        return true;
+    }
+    if(ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163) // AuthenticAMD
+    {
+        config = 0x00c1; // RETIRED_UOPS
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool attribute(Counters::Event event, perf_event_attr& attr)
+{
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    const unsigned long long readMiss =
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    switch(event)
+    {
+    case Counters::CYCLES:
+        attr.type   = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        return true;
+
+    case Counters::INSTRUCTIONS:
+        attr.type   = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        return true;
+
+    case Counters::BRANCH_MISSES:
+        attr.type   = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        return true;
+
+    case Counters::L1D_MISSES:
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+        return true;
+
+    case Counters::LLC_MISSES:
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_LL | readMiss;
+        return true;
+
+    case Counters::UOPS:
+        attr.type = PERF_TYPE_RAW;
+        return uops_config(attr.config);
+
+    default:
+        return false;
+    }
+}
+
+int open_event(Counters::Event event)
+{
+    perf_event_attr attr;
+    if( ! attribute(event, attr))
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+} // namespace
+
+const char* Counters::name(Event event)
+{
+    static const char* const names[EVENT_COUNT] =
+    {
+        "cycles",
+        "instructions",
+        "branch_misses",
+        "l1d_misses",
+        "llc_misses",
+        "uops"
+    };
+    return (0 <= event && event < EVENT_COUNT) ? names[event] : "";
+}
+
+Counters::Counters()
+{
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        values_[i] = 0;
+#if defined(__linux__)
+        fds_[i] = open_event(static_cast<Event>(i));
+        if(fds_[i] < 0 && error_.empty())
+        {
+            error_ = std::string("perf_event_open: ") + std::strerror(errno);
+        }
+#else
+        fds_[i] = -1;
+#endif
+    }
+
+    if(available())
+    {
+        error_.clear();
+    }
+    else if(error_.empty())
+    {
+        error_ = "hardware counters are not supported on this platform";
+    }
+}
+
+Counters::~Counters()
+{
+#if defined(__linux__)
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        if(fds_[i] >= 0)
+        {
+            close(fds_[i]);
+        }
+    }
+#endif
+}
+
+bool Counters::available() const
+{
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        if(fds_[i] >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Counters::available(Event event) const
+{
+    return fds_[event] >= 0;
+}
+
+const std::string& Counters::error() const
+{
+    return error_;
+}
+
+void Counters::start()
+{
+#if defined(__linux__)
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        if(fds_[i] >= 0)
+        {
+            ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void Counters::stop()
+{
+#if defined(__linux__)
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        if(fds_[i] >= 0)
+        {
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for(int i = 0; i < EVENT_COUNT; ++i)
+    {
+        values_[i] = 0;
+
+        // value, time enabled, time running
+        unsigned long long data[3];
+        if(fds_[i] >= 0 && read(fds_[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[2] != 0)
+        {
+            values_[i] = static_cast<double>(data[0]) * data[1] / data[2];
+        }
+    }
+#endif
+}
+
+double Counters::value(Event event) const
+{
+    return values_[event];
+}
+
+} // namespace bench
@@ -0,0 +1,54 @@
+#ifndef BENCH_COUNTERS_H
+#define BENCH_COUNTERS_H
+
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+// hardware performance counters of the calling thread (perf_event_open on Linux).
+// an event the kernel or the CPU does not provide is left unavailable; the others still count
+class Counters
+{
+public:
+    enum Event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        UOPS,
+        EVENT_COUNT
+    };
+
+    static const char* name(Event event);
+
+    Counters();
+    ~Counters();
+
+    bool available() const;
+    bool available(Event event) const;
+
+    // why no event is available; empty if any is
+    const std::string& error() const;
+
+    void start();
+    void stop();
+
+    // counts between the last start() and stop(), scaled if the events were multiplexed
+    double value(Event event) const;
+
+private:
+    Counters(const Counters&);
+    Counters& operator=(const Counters&);
+
+    int         fds_[EVENT_COUNT];
+    double      values_[EVENT_COUNT];
+    std::string error_;
+};
+
+} // namespace bench
+
+#endif//BENCH_COUNTERS_H
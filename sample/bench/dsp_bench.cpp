@@ -0,0 +1,193 @@
+#include "bench.h"
+
+#include "filter.h"
+#include "filter_naive.h"
+#include "cordic.h"
+
+namespace
+{
+
+const int Samples  = 4096;
+const int Taps     = 64;
+const int Factor   = 4;
+const int Channels = 256;
+const int Frames   = 64;
+
+struct Buffers
+{
+    short h[Taps];
+    short x16[Taps + Samples];
+    int   x24[Taps + Samples];
+    short y16[Samples];
+    int   y24[Samples];
+
+    // a biquad per channel
+    short b0[Channels], b1[Channels], b2[Channels], a1[Channels], a2[Channels];
+    int   x1[Channels], x2[Channels], y1[Channels], y2[Channels];
+    short frames[Channels * Frames];
+    short filtered[Channels * Frames];
+
+    // 24 bit NCO phases; the outputs of polar go to sin and cos too
+    int phase[Samples];
+    int sin[Samples];
+    int cos[Samples];
+
+    Buffers()
+    {
+        unsigned int x = 2463534242u;
+        for(int k = 0; k < Taps; ++k)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            h[k] = static_cast<short>(static_cast<int>(x % 2001) - 1000);
+        }
+        for(int i = 0; i < Taps + Samples; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            x16[i] = static_cast<short>(x);
+            x24[i] = static_cast<int>(x & 0xffffff) - 0x800000;
+        }
+        for(int c = 0; c < Channels; ++c)
+        {
+            // a 2nd order low pass, about fs / 8, Q2.14
+            b0[c] = 1510;
+            b1[c] = 3020;
+            b2[c] = 1510;
+            a1[c] = -18820;
+            a2[c] = 8476;
+            x1[c] = x2[c] = y1[c] = y2[c] = 0;
+        }
+        for(int i = 0; i < Channels * Frames; ++i)
+        {
+            frames[i] = x16[i % (Taps + Samples)];
+        }
+        for(int i = 0; i < Samples; ++i)
+        {
+            phase[i] = x24[i];
+        }
+    }
+
+    BiquadBank bank()
+    {
+        const BiquadBank result = { b0, b1, b2, a1, a2, x1, x2, y1, y2 };
+        return result;
+    }
+};
+
+Buffers& buffers()
+{
+    static Buffers b;
+    return b;
+}
+
+template<void (*F)(const short*, int, const short*, int, short*)>
+void run_fir16(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.h, Taps, b.x16 + Taps, Samples, b.y16);
+        bench::clobber_memory();
+    }
+}
+
+template<void (*F)(const short*, int, const int*, int, int*)>
+void run_fir24(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.h, Taps, b.x24 + Taps, Samples, b.y24);
+        bench::clobber_memory();
+    }
+}
+
+template<void (*F)(const short*, int, int, const short*, int, short*)>
+void run_decimate(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.h, Taps, Factor, b.x16 + Taps, Samples, b.y16);
+        bench::clobber_memory();
+    }
+}
+
+template<void (*F)(const BiquadBank&, int, const short*, int, short*)>
+void run_biquad16(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.bank(), Channels, b.frames, Frames, b.filtered);
+        bench::clobber_memory();
+    }
+}
+
+typedef Cordic<24> nco;
+
+// the model one rotation at a time, on Bits
+void sincos_scalar(const int* phase, int count, int* sin, int* cos)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        nco::value_type s;
+        nco::value_type c;
+        nco::sincos(nco::angle_type(phase[i]), s, c);
+        sin[i] = s.get();
+        cos[i] = c.get();
+    }
+}
+
+void polar_scalar(const int* x, const int* y, int count, int* magnitude, int* angle)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        nco::value_type m;
+        nco::angle_type a;
+        nco::polar(nco::value_type(x[i]), nco::value_type(y[i]), m, a);
+        magnitude[i] = m.get();
+        angle[i]     = a.get();
+    }
+}
+
+template<void (*F)(const int*, int, int*, int*)>
+void run_sincos(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.phase, Samples, b.sin, b.cos);
+        bench::clobber_memory();
+    }
+}
+
+template<void (*F)(const int*, const int*, int, int*, int*)>
+void run_polar(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.x24, b.x24 + Taps, Samples, b.sin, b.cos);
+        bench::clobber_memory();
+    }
+}
+
+} // namespace
+
+// width and items are output samples; 64 taps
+BENCH_NO_ALLOC("fir16",                run_fir16<fir16>,                       Samples, Samples, 4 * Samples);
+BENCH_NO_ALLOC("fir16_naive",          run_fir16<fir16_naive>,                 Samples, Samples, 4 * Samples);
+BENCH_NO_ALLOC("fir24",                run_fir24<fir24>,                       Samples, Samples, 8 * Samples);
+BENCH_NO_ALLOC("fir24_naive",          run_fir24<fir24_naive>,                 Samples, Samples, 8 * Samples);
+BENCH_NO_ALLOC("fir16_decimate",       run_decimate<fir16_decimate>,           Samples / Factor, Samples / Factor, 2 * Samples + 2 * Samples / Factor);
+BENCH_NO_ALLOC("fir16_decimate_naive", run_decimate<fir16_decimate_naive>,     Samples / Factor, Samples / Factor, 2 * Samples + 2 * Samples / Factor);
+BENCH_NO_ALLOC("biquad16",             run_biquad16<biquad16>,                 Channels * Frames, Channels * Frames, 4 * Channels * Frames);
+BENCH_NO_ALLOC("biquad16_naive",       run_biquad16<biquad16_naive>,           Channels * Frames, Channels * Frames, 4 * Channels * Frames);
+BENCH_NO_ALLOC("cordic_sincos_scalar", run_sincos<sincos_scalar>,              Samples, Samples, 12 * Samples);
+BENCH_NO_ALLOC("cordic_sincos",        run_sincos<nco::sincos>,                Samples, Samples, 12 * Samples);
+BENCH_NO_ALLOC("cordic_polar_scalar",  run_polar<polar_scalar>,                Samples, Samples, 16 * Samples);
+BENCH_NO_ALLOC("cordic_polar",         run_polar<nco::polar>,                  Samples, Samples, 16 * Samples);
@@ -0,0 +1,72 @@
+#include "bench.h"
+
+#include "Fixed.h"
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+const std::size_t Samples = 1024;
+
+// Q15 as the DSP code writes it on raw shorts
+#define Q15_MUL(a, b) static_cast<short>((static_cast<int>(a) * (b) + (1 << 14) + (((static_cast<int>(a) * (b)) >> 15) & 1) - 1) >> 15)
+
+struct Buffers
+{
+    short lhs[Samples];
+    short rhs[Samples];
+    short result[Samples];
+    Q15   fixedLhs[Samples];
+    Q15   fixedRhs[Samples];
+    Q15   fixedResult[Samples];
+
+    Buffers()
+    {
+        for(std::size_t i = 0; i < Samples; ++i)
+        {
+            lhs[i]      = static_cast<short>((i * 977) % 65536 - 32768);
+            rhs[i]      = static_cast<short>((i * 613) % 65536 - 32768);
+            fixedLhs[i] = Q15(Bits<16, Signed>(lhs[i]));
+            fixedRhs[i] = Q15(Bits<16, Signed>(rhs[i]));
+        }
+    }
+};
+
+Buffers& buffers()
+{
+    static Buffers b;
+    return b;
+}
+
+void mul_macro(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(std::size_t i = 0; i < Samples; ++i)
+        {
+            b.result[i] = Q15_MUL(b.lhs[i], b.rhs[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+void mul_fixed(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(std::size_t i = 0; i < Samples; ++i)
+        {
+            b.fixedResult[i] = b.fixedLhs[i] * b.fixedRhs[i];
+        }
+        bench::clobber_memory();
+    }
+}
+
+} // namespace
+
+// width and items are samples; both round to nearest, ties to even
+BENCH_NO_ALLOC("q15_mul_macro", mul_macro, Samples, Samples, 3 * sizeof(short) * Samples);
+BENCH_NO_ALLOC("q15_mul",       mul_fixed, Samples, Samples, 3 * sizeof(short) * Samples);
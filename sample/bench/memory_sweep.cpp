@@ -0,0 +1,468 @@
+// memory-hierarchy sweep; see Makefile (make sweep)
+//
+// reads n elements of W bits with sequential, strided and random access, for W = 1..32 and
+// n from 2^10 up to --max-elements, in three layouts:
+//   packed   W bits per element, back to back (decoded with Bits<W>)
+//   record   the same bits, read as records of 4 (W <= 8) or 2 (W <= 16) elements, each decoded
+//            with a pack: (f0, f1, f2, f3) = word; not measured for W > 16
+//   aligned  one Bits<W>::value_type per element (the byte-aligned container Fit picks)
+// the strided walk steps over at least a cache line (64 bytes) of packed bits, an odd number of
+// elements (records) so that it visits all of them; and prints the throughput curve of every width as csv:
+//   width,layout,pattern,elements,bytes,ns_per_element
+//
+// options:
+//   --widths=LIST        comma separated widths (default 1..32)
+//   --max-elements=N     largest element count, rounded down to a power of 2 (default 2^25)
+//   --repetitions=N      timed passes per point; the median is printed (default 3)
+//   --summary            instead of csv, print per width and pattern the smallest element count
+//                        from which packed (record) is faster than aligned
+
+#include "bench.h"
+#include "Bits.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+enum Pattern
+{
+    SEQUENTIAL,
+    STRIDED,
+    RANDOM,
+    PATTERN_COUNT
+};
+
+const char* const PatternNames[PATTERN_COUNT] = { "sequential", "strided", "random" };
+
+enum Layout
+{
+    PACKED,
+    RECORD,
+    ALIGNED,
+    LAYOUT_COUNT
+};
+
+const char* const LayoutNames[LAYOUT_COUNT] = { "packed", "record", "aligned" };
+
+// the strided step over units (elements or records) of BITS bits: at least 512 bits, and odd,
+// so that the walk visits every unit of a power of 2 sized array
+template<int BITS>
+struct Stride
+{
+    static const std::size_t value = ((512 + BITS - 1) / BITS) | 1;
+};
+
+struct Options
+{
+    std::vector<int> widths;
+    std::size_t      maxElements;
+    int              repetitions;
+    bool             summary;
+};
+
+struct Point
+{
+    int         width;
+    Layout      layout;
+    Pattern     pattern;
+    std::size_t elements;
+    std::size_t bytes;
+    double      nsPerElement;
+};
+
+double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// the BITS bits (at most 32) of unit i of packed bits, and more above them
+template<int BITS>
+inline unsigned int load(const unsigned char* data, std::size_t i)
+{
+    const std::size_t bit = i * BITS;
+    uint64_t          word;
+    std::memcpy(&word, data + bit / 8, sizeof(word));
+    return static_cast<unsigned int>(word >> (bit % 8));
+}
+
+// the arrays read Fields elements a unit, whose strided step is Stride<StrideBits>
+template<int W>
+struct PackedArray
+{
+    typedef Bits<W, unsigned int> element_type;
+
+    static const int Fields     = 1;
+    static const int StrideBits = W;
+
+    static std::size_t bytes(std::size_t n)
+    {
+        return (n * W + 7) / 8 + sizeof(uint64_t); // a 64 bit load at the last element stays inside
+    }
+
+    static unsigned int at(const unsigned char* data, std::size_t i)
+    {
+        return element_type(load<W>(data, i));
+    }
+};
+
+// the packed bits, a record of FIELDS elements at a time (0: the record is wider than 32 bits)
+template<int W, int FIELDS = (4 * W <= 32) ? 4 : (2 * W <= 32) ? 2 : 0>
+struct RecordArray : PackedArray<W>
+{
+    static const int Fields     = FIELDS;
+    static const int StrideBits = W * FIELDS;
+
+    // the sum of the fields
+    static unsigned int at(const unsigned char* data, std::size_t i)
+    {
+        Bits<W> f0, f1, f2, f3;
+        (f0, f1, f2, f3) = load<StrideBits>(data, i);
+        return f0.get() + f1.get() + f2.get() + f3.get();
+    }
+};
+
+template<int W>
+struct RecordArray<W, 2> : PackedArray<W>
+{
+    static const int Fields     = 2;
+    static const int StrideBits = W * 2;
+
+    static unsigned int at(const unsigned char* data, std::size_t i)
+    {
+        Bits<W> f0, f1;
+        (f0, f1) = load<StrideBits>(data, i);
+        return f0.get() + f1.get();
+    }
+};
+
+template<int W>
+struct RecordArray<W, 0>
+{
+    static const int Fields = 0;
+};
+
+template<int W>
+struct AlignedArray
+{
+    typedef typename Bits<W>::value_type value_type;
+
+    static const int Fields     = 1;
+    static const int StrideBits = W; // the elements of the packed walk
+
+    static std::size_t bytes(std::size_t n)
+    {
+        return n * sizeof(value_type);
+    }
+
+    static unsigned int at(const unsigned char* data, std::size_t i)
+    {
+        return reinterpret_cast<const value_type*>(data)[i];
+    }
+};
+
+// reads `accesses` elements of n (a power of 2), Array::Fields at a time; returns the sum
+// so that the reads are kept
+template<typename Array>
+unsigned int walk(const unsigned char* data, std::size_t n, std::size_t accesses, Pattern pattern)
+{
+    const std::size_t mask  = n / Array::Fields - 1;
+    const std::size_t units = accesses / Array::Fields;
+    unsigned int      sum   = 0;
+    std::size_t       i     = 0;
+    switch(pattern)
+    {
+    case SEQUENTIAL:
+        for(std::size_t k = 0; k < units; ++k)
+        {
+            sum += Array::at(data, k & mask);
+        }
+        break;
+
+    case STRIDED:
+        for(std::size_t k = 0; k < units; ++k)
+        {
+            sum += Array::at(data, i);
+            i = (i + Stride<Array::StrideBits>::value) & mask;
+        }
+        break;
+
+    default:
+        // full period linear congruential walk; the index does not depend on the data,
+        // so this measures throughput rather than latency
+        for(std::size_t k = 0; k < units; ++k)
+        {
+            sum += Array::at(data, i);
+            i = (i * 1664525u + 1013904223u) & mask;
+        }
+        break;
+    }
+    return sum;
+}
+
+template<typename Array>
+double measure(const unsigned char* data, std::size_t n, Pattern pattern, int repetitions)
+{
+    const std::size_t accesses = std::max<std::size_t>(n, 1u << 20);
+
+    bench::do_not_optimize(walk<Array>(data, n, std::min<std::size_t>(n, accesses), pattern)); // warm up
+
+    std::vector<double> times;
+    for(int r = 0; r < repetitions; ++r)
+    {
+        const double start = now();
+        bench::do_not_optimize(walk<Array>(data, n, accesses, pattern));
+        times.push_back((now() - start) * 1e9 / accesses);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+template<typename Array>
+void point(const Options& options, unsigned char* buffer, int width, Layout layout, Pattern pattern, std::size_t n, std::vector<Point>& points)
+{
+    Point p = { width, layout, pattern, n, Array::bytes(n), 0 };
+    p.nsPerElement = measure<Array>(buffer, n, pattern, options.repetitions);
+    points.push_back(p);
+}
+
+// a record wider than 32 bits is not measured
+template<int W, bool MEASURED = (RecordArray<W>::Fields != 0)>
+struct RecordPoint
+{
+    static void run(const Options& options, unsigned char* buffer, Pattern pattern, std::size_t n, std::vector<Point>& points)
+    {
+        point<RecordArray<W> >(options, buffer, W, RECORD, pattern, n, points);
+    }
+};
+
+template<int W>
+struct RecordPoint<W, false>
+{
+    static void run(const Options&, unsigned char*, Pattern, std::size_t, std::vector<Point>&)
+    {
+    }
+};
+
+template<int W>
+void sweep(const Options& options, unsigned char* buffer, std::vector<Point>& points)
+{
+    for(std::size_t n = 1u << 10; n <= options.maxElements; n *= 2)
+    {
+        for(int p = 0; p < PATTERN_COUNT; ++p)
+        {
+            const Pattern pattern = static_cast<Pattern>(p);
+
+            point<PackedArray<W> >(options, buffer, W, PACKED, pattern, n, points);
+            RecordPoint<W>::run(options, buffer, pattern, n, points);
+            point<AlignedArray<W> >(options, buffer, W, ALIGNED, pattern, n, points);
+        }
+    }
+}
+
+// Sweeper<W>::run runs sweep<W> for the selected widths of W..32
+template<int W>
+struct Sweeper
+{
+    static void run(const Options& options, unsigned char* buffer, std::vector<Point>& points)
+    {
+        if(std::find(options.widths.begin(), options.widths.end(), W) != options.widths.end())
+        {
+            sweep<W>(options, buffer, points);
+        }
+        Sweeper<W + 1>::run(options, buffer, points);
+    }
+};
+
+template<>
+struct Sweeper<33>
+{
+    static void run(const Options&, unsigned char*, std::vector<Point>&)
+    {
+    }
+};
+
+void print_csv(const std::vector<Point>& points)
+{
+    std::cout << "width,layout,pattern,elements,bytes,ns_per_element" << std::endl;
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        const Point& p = points[i];
+        std::cout
+            << p.width << "," << LayoutNames[p.layout] << "," << PatternNames[p.pattern] << ","
+            << p.elements << "," << p.bytes << ","
+            << std::fixed << std::setprecision(4) << p.nsPerElement << std::endl;
+    }
+}
+
+// the smallest count from which layout stays faster than aligned for all larger counts; 0 if none
+std::size_t crossover(const std::vector<Point>& points, int width, Layout layout, Pattern pattern)
+{
+    std::size_t from = 0;
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        const Point& p = points[i];
+        if(p.width != width || p.layout != layout || p.pattern != pattern)
+        {
+            continue;
+        }
+        for(std::size_t j = 0; j < points.size(); ++j)
+        {
+            const Point& a = points[j];
+            if(a.width == width && a.layout == ALIGNED && a.pattern == pattern && a.elements == p.elements)
+            {
+                if(p.nsPerElement >= a.nsPerElement)
+                {
+                    from = 0;
+                }
+                else if(from == 0)
+                {
+                    from = p.elements;
+                }
+            }
+        }
+    }
+    return from;
+}
+
+void print_crossover(std::size_t from)
+{
+    std::ostringstream out;
+    if(from == 0)
+    {
+        out << "never";
+    }
+    else
+    {
+        out << from << " elements";
+    }
+    std::cout << std::setw(24) << out.str();
+}
+
+void print_summary(const Options& options, const std::vector<Point>& points)
+{
+    std::cout << std::left << std::setw(8) << "width" << std::setw(12) << "pattern"
+              << std::setw(24) << "packed is faster from" << "record is faster from" << std::endl;
+    for(std::size_t w = 0; w < options.widths.size(); ++w)
+    {
+        for(int pattern = 0; pattern < PATTERN_COUNT; ++pattern)
+        {
+            const int width = options.widths[w];
+            std::cout << std::left << std::setw(8) << width << std::setw(12) << PatternNames[pattern];
+            print_crossover(crossover(points, width, PACKED, static_cast<Pattern>(pattern)));
+            if(width <= 16)
+            {
+                print_crossover(crossover(points, width, RECORD, static_cast<Pattern>(pattern)));
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+bool parse(const char* arg, const char* name, const char*& value)
+{
+    const std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0)
+    {
+        value = arg + length;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    options.maxElements = 1u << 25;
+    options.repetitions = 3;
+    options.summary     = false;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value;
+        if(parse(argv[i], "--widths=", value))
+        {
+            std::istringstream in(value);
+            std::string        item;
+            while(std::getline(in, item, ','))
+            {
+                const int w = std::atoi(item.c_str());
+                if(w < 1 || 32 < w)
+                {
+                    std::cerr << "width must be 1..32: " << item << std::endl;
+                    return 1;
+                }
+                options.widths.push_back(w);
+            }
+        }
+        else if(parse(argv[i], "--max-elements=", value))
+        {
+            const std::size_t n = std::strtoul(value, 0, 0);
+            options.maxElements = 1u << 10;
+            while(options.maxElements * 2 <= n)
+            {
+                options.maxElements *= 2;
+            }
+        }
+        else if(parse(argv[i], "--repetitions=", value))
+        {
+            options.repetitions = std::max(1, std::atoi(value));
+        }
+        else if(std::strcmp(argv[i], "--summary") == 0)
+        {
+            options.summary = true;
+        }
+        else
+        {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if(options.widths.empty())
+    {
+        for(int w = 1; w <= 32; ++w)
+        {
+            options.widths.push_back(w);
+        }
+    }
+    std::sort(options.widths.begin(), options.widths.end());
+    options.widths.erase(std::unique(options.widths.begin(), options.widths.end()), options.widths.end());
+
+    // the largest array is aligned 32 bit; the contents do not matter, but the pages must be touched
+    std::vector<unsigned char> buffer(options.maxElements * sizeof(unsigned int) + sizeof(uint64_t));
+    for(std::size_t i = 0; i < buffer.size(); ++i)
+    {
+        buffer[i] = static_cast<unsigned char>(i * 131);
+    }
+
+    std::vector<Point> points;
+    Sweeper<1>::run(options, &buffer[0], points);
+
+    if(options.summary)
+    {
+        print_summary(options, points);
+    }
+    else
+    {
+        print_csv(points);
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "bench.h"
+
+#include "rtl.h"
+#include "datapath.h"
+
+namespace
+{
+
+const int Instances = 4096;
+
+struct Buffers
+{
+    emattsan::bits::Bits<8> crc[Instances];
+    emattsan::bits::Bits<8> data[Instances];
+    emattsan::bits::Bits<8> out[Instances];
+
+    Buffers()
+    {
+        unsigned int x = 2463534242u;
+        for(int i = 0; i < Instances; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            crc[i]  = x;
+            data[i] = x >> 8;
+        }
+    }
+};
+
+Buffers& buffers()
+{
+    static Buffers b;
+    return b;
+}
+
+// the same instances kept bit sliced
+struct SlicedBuffers
+{
+    SliceArray<8> crc;
+    SliceArray<8> data;
+    SliceArray<8> out;
+
+    SlicedBuffers() : crc(Instances), data(Instances), out(Instances)
+    {
+        crc.load(buffers().crc);
+        data.load(buffers().data);
+    }
+};
+
+SlicedBuffers& sliced_buffers()
+{
+    static SlicedBuffers b;
+    return b;
+}
+
+// one instance at a time on Bits
+void run_crc8_scalar(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int i = 0; i < Instances; ++i)
+        {
+            b.out[i] = crc8<Scalar>(b.crc[i], b.data[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+// 64 instances at a time, transposed in and out (the round trip)
+void run_crc8_sliced(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int i = 0; i < Instances; i += 64)
+        {
+            crc8<Sliced>(Slice<8>::load(b.crc + i, 64), Slice<8>::load(b.data + i, 64)).store(b.out + i, 64);
+        }
+        bench::clobber_memory();
+    }
+}
+
+// the sliced kernel alone, on instances which stay sliced across calls
+void run_crc8_sliced_kernel(std::size_t iterations)
+{
+    SlicedBuffers& b = sliced_buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        for(int j = 0; j < b.crc.size(); ++j)
+        {
+            b.out[j] = crc8<Sliced>(b.crc[j], b.data[j]);
+        }
+        bench::clobber_memory();
+    }
+}
+
+} // namespace
+
+// width and items are instances of one byte
+BENCH_NO_ALLOC("rtl_crc8_scalar", run_crc8_scalar, Instances, Instances, 3 * Instances);
+BENCH_NO_ALLOC("rtl_crc8_sliced", run_crc8_sliced, Instances, Instances, 3 * Instances);
+BENCH_NO_ALLOC("rtl_crc8_sliced_kernel", run_crc8_sliced_kernel, Instances, Instances, 3 * Instances);
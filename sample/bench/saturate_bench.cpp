@@ -0,0 +1,105 @@
+#include "bench.h"
+
+#include "Bits.h"
+#include "BitsBulk.h"
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// 12 bit sensor samples, as Bits<12, signed> and Bits<12, Saturate<signed> > are stored in arrays
+typedef bulk::Element<12, signed>::type sample;
+
+const std::size_t Samples = 1024;
+
+struct Buffers
+{
+    sample lhs[Samples];
+    sample rhs[Samples];
+    sample result[Samples];
+
+    Buffers()
+    {
+        for(std::size_t i = 0; i < Samples; ++i)
+        {
+            lhs[i] = static_cast<sample>((i * 977) % 4096 - 2048);
+            rhs[i] = static_cast<sample>((i * 613) % 4096 - 2048);
+        }
+    }
+};
+
+Buffers& buffers()
+{
+    static Buffers b;
+    return b;
+}
+
+// wrapping Bits with compares around every operation, as the pipelines do without Saturate
+inline sample clamp12(int n)
+{
+    if(n < -2048)
+    {
+        return -2048;
+    }
+    if(2047 < n)
+    {
+        return 2047;
+    }
+    return static_cast<sample>(n);
+}
+
+void add_emulated(const sample* lhs, const sample* rhs, sample* result, std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = clamp12(Bits<12, signed>(lhs[i]).get() + Bits<12, signed>(rhs[i]).get());
+    }
+}
+
+void mul_emulated(const sample* lhs, const sample* rhs, sample* result, std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = clamp12(Bits<12, signed>(lhs[i]).get() * Bits<12, signed>(rhs[i]).get());
+    }
+}
+
+void add_saturate(const sample* lhs, const sample* rhs, sample* result, std::size_t count)
+{
+    typedef Bits<12, Saturate<signed> > bits;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = static_cast<sample>((bits(lhs[i]) + bits(rhs[i])).get());
+    }
+}
+
+void mul_saturate(const sample* lhs, const sample* rhs, sample* result, std::size_t count)
+{
+    typedef Bits<12, Saturate<signed> > bits;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = static_cast<sample>((bits(lhs[i]) * bits(rhs[i])).get());
+    }
+}
+
+template<void (*F)(const sample*, const sample*, sample*, std::size_t)>
+void run(std::size_t iterations)
+{
+    Buffers& b = buffers();
+    for(std::size_t n = 0; n < iterations; ++n)
+    {
+        F(b.lhs, b.rhs, b.result, Samples);
+        bench::clobber_memory();
+    }
+}
+
+} // namespace
+
+// width and items are samples
+BENCH_NO_ALLOC("saturate_add_emulated", run<add_emulated>,              Samples, Samples, 3 * sizeof(sample) * Samples);
+BENCH_NO_ALLOC("saturate_add",          run<add_saturate>,              Samples, Samples, 3 * sizeof(sample) * Samples);
+BENCH_NO_ALLOC("saturate_add_bulk",     (run<bulk::add<12, signed> >), Samples, Samples, 3 * sizeof(sample) * Samples);
+BENCH_NO_ALLOC("saturate_mul_emulated", run<mul_emulated>,              Samples, Samples, 3 * sizeof(sample) * Samples);
+BENCH_NO_ALLOC("saturate_mul",          run<mul_saturate>,              Samples, Samples, 3 * sizeof(sample) * Samples);
+BENCH_NO_ALLOC("saturate_mul_bulk",     (run<bulk::mul<12, signed> >), Samples, Samples, 3 * sizeof(sample) * Samples);
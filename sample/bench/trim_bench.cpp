@@ -0,0 +1,288 @@
+// sign extension strategies of Trimmer; see Makefile (make trim-bench)
+//
+// trims an L1 resident array of signed values of W bits, for W = 1..32, with every strategy of
+// detail::Trimmer (TrimBranch, TrimShift, TrimXor and, when compiled for BMI2, TrimBzhi) in two
+// containers:
+//   fit  Fit<W, Signed>::value_type (signed char, short or int; as Bits<W, Signed>)
+//   int  int (as Bits<W, signed>)
+// over two inputs:
+//   random    uniformly random container values; the MSB of W bits is unpredictable
+//   monotone  0, 1, 2, ...; the MSB of W bits changes every 2^(W - 1) values
+// and prints the time per trim as csv:
+//   width,container,strategy,input,ns_per_trim
+//
+// options:
+//   --widths=LIST        comma separated widths (default 1..32)
+//   --repetitions=N      timed passes per point; the median is printed (default 5)
+//   --summary            instead of csv, print per width, container and input the fastest strategy
+//                        and its speedup over TrimBranch
+
+#include "bench.h"
+#include "Bits.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+enum Input
+{
+    RANDOM,
+    MONOTONE,
+    INPUT_COUNT
+};
+
+const char* const InputNames[INPUT_COUNT] = { "random", "monotone" };
+
+enum Strategy
+{
+    BRANCH,
+    SHIFT,
+    XOR,
+#if defined(__BMI2__)
+    BZHI,
+#endif
+    STRATEGY_COUNT
+};
+
+const char* const StrategyNames[] = { "branch", "shift", "xor", "bzhi" };
+
+const std::size_t Elements = 4096;
+const std::size_t Trims    = 1u << 22; // per timed pass
+
+struct Options
+{
+    std::vector<int> widths;
+    int              repetitions;
+    bool             summary;
+};
+
+struct Point
+{
+    int         width;
+    const char* container;
+    Strategy    strategy;
+    Input       input;
+    double      nsPerTrim;
+};
+
+double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template<typename S, typename T, int W>
+void trim_all(const typename T::value_type* in, typename T::value_type* out)
+{
+    for(std::size_t i = 0; i < Elements; ++i)
+    {
+        typename T::value_type n = in[i];
+        S::template trim<T, W>(n);
+        out[i] = n;
+    }
+}
+
+template<typename S, typename T, int W>
+double measure(const typename T::value_type* in, typename T::value_type* out, int repetitions)
+{
+    trim_all<S, T, W>(in, out); // warm up
+
+    std::vector<double> times;
+    for(int r = 0; r < repetitions; ++r)
+    {
+        const double start = now();
+        for(std::size_t k = 0; k < Trims; k += Elements)
+        {
+            trim_all<S, T, W>(in, out);
+            bench::clobber_memory();
+        }
+        times.push_back((now() - start) * 1e9 / Trims);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+template<typename V>
+void fill(V* values, Input input)
+{
+    unsigned int x = 2463534242u;
+    for(std::size_t i = 0; i < Elements; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        values[i] = static_cast<V>((input == RANDOM) ? x : i);
+    }
+}
+
+template<typename T, int W>
+void sweep_container(const char* container, const Options& options, std::vector<Point>& points)
+{
+    typedef typename T::value_type value_type;
+
+    std::vector<value_type> in(Elements);
+    std::vector<value_type> out(Elements);
+    for(int i = 0; i < INPUT_COUNT; ++i)
+    {
+        const Input input = static_cast<Input>(i);
+        fill(&in[0], input);
+
+        const Point branch = { W, container, BRANCH, input, measure<detail::TrimBranch, T, W>(&in[0], &out[0], options.repetitions) };
+        const Point shift  = { W, container, SHIFT,  input, measure<detail::TrimShift,  T, W>(&in[0], &out[0], options.repetitions) };
+        const Point xor_   = { W, container, XOR,    input, measure<detail::TrimXor,    T, W>(&in[0], &out[0], options.repetitions) };
+        points.push_back(branch);
+        points.push_back(shift);
+        points.push_back(xor_);
+#if defined(__BMI2__)
+        const Point bzhi   = { W, container, BZHI,   input, measure<detail::TrimBzhi,   T, W>(&in[0], &out[0], options.repetitions) };
+        points.push_back(bzhi);
+#endif
+    }
+}
+
+// Sweeper<W>::run measures the selected widths of W..32
+template<int W>
+struct Sweeper
+{
+    static void run(const Options& options, std::vector<Point>& points)
+    {
+        if(std::find(options.widths.begin(), options.widths.end(), W) != options.widths.end())
+        {
+            sweep_container<typename detail::Fit<W, Signed>::traits, W>("fit", options, points);
+            sweep_container<detail::Traits<int>, W>("int", options, points);
+        }
+        Sweeper<W + 1>::run(options, points);
+    }
+};
+
+template<>
+struct Sweeper<33>
+{
+    static void run(const Options&, std::vector<Point>&)
+    {
+    }
+};
+
+void print_csv(const std::vector<Point>& points)
+{
+    std::cout << "width,container,strategy,input,ns_per_trim" << std::endl;
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        const Point& p = points[i];
+        std::cout
+            << p.width << "," << p.container << "," << StrategyNames[p.strategy] << "," << InputNames[p.input] << ","
+            << std::fixed << std::setprecision(4) << p.nsPerTrim << std::endl;
+    }
+}
+
+// points come in groups of STRATEGY_COUNT, TrimBranch first
+void print_summary(const std::vector<Point>& points)
+{
+    std::cout
+        << std::left << std::setw(8) << "width" << std::setw(12) << "container" << std::setw(12) << "input"
+        << std::setw(12) << "fastest" << "speedup over branch" << std::endl;
+    for(std::size_t i = 0; i + STRATEGY_COUNT <= points.size(); i += STRATEGY_COUNT)
+    {
+        std::size_t best = i;
+        for(std::size_t k = i + 1; k < i + STRATEGY_COUNT; ++k)
+        {
+            if(points[k].nsPerTrim < points[best].nsPerTrim)
+            {
+                best = k;
+            }
+        }
+        std::cout
+            << std::left << std::setw(8) << points[i].width << std::setw(12) << points[i].container
+            << std::setw(12) << InputNames[points[i].input] << std::setw(12) << StrategyNames[points[best].strategy]
+            << std::fixed << std::setprecision(2) << points[i].nsPerTrim / points[best].nsPerTrim << std::endl;
+    }
+}
+
+bool parse(const char* arg, const char* name, const char*& value)
+{
+    const std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0)
+    {
+        value = arg + length;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    options.repetitions = 5;
+    options.summary     = false;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* value;
+        if(parse(argv[i], "--widths=", value))
+        {
+            std::istringstream in(value);
+            std::string        item;
+            while(std::getline(in, item, ','))
+            {
+                const int w = std::atoi(item.c_str());
+                if(w < 1 || 32 < w)
+                {
+                    std::cerr << "width must be 1..32: " << item << std::endl;
+                    return 1;
+                }
+                options.widths.push_back(w);
+            }
+        }
+        else if(parse(argv[i], "--repetitions=", value))
+        {
+            options.repetitions = std::max(1, std::atoi(value));
+        }
+        else if(std::strcmp(argv[i], "--summary") == 0)
+        {
+            options.summary = true;
+        }
+        else
+        {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if(options.widths.empty())
+    {
+        for(int w = 1; w <= 32; ++w)
+        {
+            options.widths.push_back(w);
+        }
+    }
+    std::sort(options.widths.begin(), options.widths.end());
+    options.widths.erase(std::unique(options.widths.begin(), options.widths.end()), options.widths.end());
+
+    std::vector<Point> points;
+    Sweeper<1>::run(options, points);
+
+    if(options.summary)
+    {
+        print_summary(points);
+    }
+    else
+    {
+        print_csv(points);
+    }
+
+    return 0;
+}
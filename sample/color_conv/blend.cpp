@@ -0,0 +1,147 @@
+#include "blend.h"
+#include "Bits.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// RGB565 to 00000ggg ggg00000 rrrrr000 000bbbbb; every channel has room for a product with 0..32
+inline unsigned int spread565(unsigned int rgb)
+{
+    Bits<5> r;
+    Bits<6> g;
+    Bits<5> b;
+    (r, g, b) = rgb;
+    return (g, reserve<5>, r, reserve<6>, b);
+}
+
+// inverse of spread565; the reserved bits (the carries of the products) are discarded
+inline unsigned int gather565(unsigned int spread)
+{
+    Bits<5> r;
+    Bits<6> g;
+    Bits<5> b;
+    (g, reserve<5>, r, reserve<6>, b) = spread;
+    return (r, g, b);
+}
+
+inline unsigned int alpha5(unsigned int alpha)
+{
+    return (alpha + 4) >> 3;
+}
+
+inline unsigned int argb1555to565(unsigned int argb)
+{
+    Bits<5> r;
+    Bits<5> g;
+    Bits<5> b;
+    (r, g, b) = argb; // A is above the 15 bits of the pack
+    return (r, g, reserve<1>, b);
+}
+
+#ifdef __SSE2__
+
+// 8 pixels; dst * (32 - alpha) + src * alpha in each channel
+inline __m128i blend565x8(__m128i dst, __m128i src, __m128i alpha)
+{
+    const __m128i mask5 = _mm_set1_epi16(0x1f);
+    const __m128i mask6 = _mm_set1_epi16(0x3f);
+    const __m128i beta  = _mm_sub_epi16(_mm_set1_epi16(32), alpha);
+
+    const __m128i dr = _mm_srli_epi16(dst, 11);
+    const __m128i dg = _mm_and_si128(_mm_srli_epi16(dst, 5), mask6);
+    const __m128i db = _mm_and_si128(dst, mask5);
+    const __m128i sr = _mm_srli_epi16(src, 11);
+    const __m128i sg = _mm_and_si128(_mm_srli_epi16(src, 5), mask6);
+    const __m128i sb = _mm_and_si128(src, mask5);
+
+    const __m128i r = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dr, beta), _mm_mullo_epi16(sr, alpha)), 5);
+    const __m128i g = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dg, beta), _mm_mullo_epi16(sg, alpha)), 5);
+    const __m128i b = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(db, beta), _mm_mullo_epi16(sb, alpha)), 5);
+
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+inline __m128i load8(const unsigned short* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store8(unsigned short* p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+#endif
+
+} // namespace
+
+unsigned int blend_rgb565(unsigned int dst, unsigned int src, unsigned int alpha)
+{
+    return gather565((spread565(dst) * (32 - alpha) + spread565(src) * alpha) >> 5);
+}
+
+void blend_rgb565_const(unsigned short* dst, const unsigned short* src, int n, unsigned int alpha)
+{
+    const unsigned int a = alpha5(alpha);
+
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i va = _mm_set1_epi16(static_cast<short>(a));
+    for(; i + 8 <= n; i += 8)
+    {
+        store8(dst + i, blend565x8(load8(dst + i), load8(src + i), va));
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        dst[i] = static_cast<unsigned short>(blend_rgb565(dst[i], src[i], a));
+    }
+}
+
+void blend_rgb565_alpha(unsigned short* dst, const unsigned short* src, const unsigned char* alpha, int n)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi16(4);
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m128i a8 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(alpha + i)), zero);
+        const __m128i a5 = _mm_srli_epi16(_mm_add_epi16(a8, four), 3);
+        store8(dst + i, blend565x8(load8(dst + i), load8(src + i), a5));
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        dst[i] = static_cast<unsigned short>(blend_rgb565(dst[i], src[i], alpha5(alpha[i])));
+    }
+}
+
+void blend_argb1555_key(unsigned short* dst, const unsigned short* src, int n)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i maskRG = _mm_set1_epi16(0x7fe0);
+    const __m128i maskB  = _mm_set1_epi16(0x001f);
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m128i s    = load8(src + i);
+        const __m128i key  = _mm_srai_epi16(s, 15); // all 1 where A is 1
+        const __m128i s565 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(s, maskRG), 1), _mm_and_si128(s, maskB));
+        store8(dst + i, _mm_or_si128(_mm_and_si128(key, s565), _mm_andnot_si128(key, load8(dst + i))));
+    }
+#endif
+    for(; i < n; ++i)
+    {
+        if((src[i] & 0x8000) != 0)
+        {
+            dst[i] = static_cast<unsigned short>(argb1555to565(src[i]));
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef BLEND_H
+#define BLEND_H
+
+// alpha of blend_rgb565 is 0 (dst) .. 32 (src)
+// alpha of the row functions is 0 (dst) .. 255 (src), rounded to 0 .. 32
+
+unsigned int blend_rgb565(unsigned int dst, unsigned int src, unsigned int alpha);
+
+// dst[i] = blend(dst[i], src[i], alpha)
+void blend_rgb565_const(unsigned short* dst, const unsigned short* src, int n, unsigned int alpha);
+
+// dst[i] = blend(dst[i], src[i], alpha[i])
+void blend_rgb565_alpha(unsigned short* dst, const unsigned short* src, const unsigned char* alpha, int n);
+
+// dst[i] = (A of src[i] is 1) ? rgb555to565(src[i]) : dst[i]
+void blend_argb1555_key(unsigned short* dst, const unsigned short* src, int n);
+
+#endif//BLEND_H
@@ -0,0 +1,284 @@
+#include "blit.h"
+#include "color_conv.h"
+#include "Bits.h"
+
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// average of 2x2 pixels; red and blue are summed side by side in one word
+inline unsigned int average4(unsigned int p0, unsigned int p1, unsigned int p2, unsigned int p3)
+{
+    const unsigned int rb = (p0 & 0xff00ff) + (p1 & 0xff00ff) + (p2 & 0xff00ff) + (p3 & 0xff00ff);
+    const unsigned int g  = (p0 & 0x00ff00) + (p1 & 0x00ff00) + (p2 & 0x00ff00) + (p3 & 0x00ff00);
+    return (((rb + 0x020002) >> 2) & 0xff00ff) | (((g + 0x000200) >> 2) & 0x00ff00);
+}
+
+struct CopySource
+{
+    const unsigned int* row;
+
+    unsigned int operator () (int i) const
+    {
+        return row[i];
+    }
+
+#ifdef __SSE2__
+    __m128i load4(int i) const
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    }
+#endif
+};
+
+struct NearestSource
+{
+    const unsigned int* row;
+    int                 x;     // the left of the source rectangle, which may be out of the row
+    unsigned int        start; // 16.16 fixed point
+    unsigned int        step;  // 16.16 fixed point
+
+    unsigned int operator () (int i) const
+    {
+        return row[x + static_cast<int>((start + i * step) >> 16)];
+    }
+
+#ifdef __SSE2__
+    __m128i load4(int i) const
+    {
+        return _mm_set_epi32((*this)(i + 3), (*this)(i + 2), (*this)(i + 1), (*this)(i));
+    }
+#endif
+};
+
+struct Box2Source
+{
+    const unsigned int* row0;
+    const unsigned int* row1;
+
+    unsigned int operator () (int i) const
+    {
+        return average4(row0[i * 2], row0[i * 2 + 1], row1[i * 2], row1[i * 2 + 1]);
+    }
+
+#ifdef __SSE2__
+    __m128i load4(int i) const
+    {
+        return _mm_set_epi32((*this)(i + 3), (*this)(i + 2), (*this)(i + 1), (*this)(i));
+    }
+#endif
+};
+
+#ifdef __SSE2__
+
+// 4 pixels of 0x00RRGGBB to 4 pixels of RGB565 in 32 bit lanes
+inline __m128i pack565x4(__m128i rgb)
+{
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(rgb, 8), _mm_set1_epi32(0xf800));
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(rgb, 5), _mm_set1_epi32(0x07e0));
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(rgb, 3), _mm_set1_epi32(0x001f));
+    const __m128i p = _mm_or_si128(_mm_or_si128(r, g), b);
+    return _mm_srai_epi32(_mm_slli_epi32(p, 16), 16); // sign extend, so that packs_epi32 keeps the bits
+}
+
+template<typename Source>
+void convert_row(unsigned short* dst, int width, const Source& src, bool stream)
+{
+    int i = 0;
+    for(; (i < width) && ((reinterpret_cast<std::size_t>(dst + i) & 15) != 0); ++i)
+    {
+        dst[i] = static_cast<unsigned short>(pack_rgb565(src(i)));
+    }
+    for(; i + 8 <= width; i += 8)
+    {
+        const __m128i p = _mm_packs_epi32(pack565x4(src.load4(i)), pack565x4(src.load4(i + 4)));
+        if(stream)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), p);
+        }
+        else
+        {
+            _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), p);
+        }
+    }
+    for(; i < width; ++i)
+    {
+        dst[i] = static_cast<unsigned short>(pack_rgb565(src(i)));
+    }
+}
+
+#else
+
+template<typename Source>
+void convert_row(unsigned short* dst, int width, const Source& src, bool)
+{
+    for(int i = 0; i < width; ++i)
+    {
+        dst[i] = static_cast<unsigned short>(pack_rgb565(src(i)));
+    }
+}
+
+#endif
+
+inline int min(int a, int b)
+{
+    return (a < b) ? a : b;
+}
+
+inline int max(int a, int b)
+{
+    return (a < b) ? b : a;
+}
+
+// intersection of rect and (0, 0)-(width, height); returns false if it is empty
+bool clip(const BlitRect& rect, int width, int height, BlitRect& result)
+{
+    const int left   = max(rect.x, 0);
+    const int top    = max(rect.y, 0);
+    const int right  = min(rect.x + rect.width, width);
+    const int bottom = min(rect.y + rect.height, height);
+
+    result.x      = left;
+    result.y      = top;
+    result.width  = right - left;
+    result.height = bottom - top;
+
+    return (result.width > 0) && (result.height > 0);
+}
+
+bool use_stream(int width, int height)
+{
+    return static_cast<unsigned int>(width) * static_cast<unsigned int>(height) * sizeof(unsigned short) >= BLIT_STREAM_THRESHOLD;
+}
+
+void finish(bool stream)
+{
+#ifdef __SSE2__
+    if(stream)
+    {
+        _mm_sfence();
+    }
+#else
+    static_cast<void>(stream);
+#endif
+}
+
+// the first pixel i of a row of steps (16.16 fixed point, sampled at pixel centers) which reaches
+// source pixel n
+int first_reaching(int n, unsigned int step)
+{
+    if(n <= 0)
+    {
+        return 0;
+    }
+    const unsigned int target = static_cast<unsigned int>(n) << 16;
+    return (target <= step / 2) ? 0 : static_cast<int>((target - step / 2 + step - 1) / step);
+}
+
+void blit_unscaled(const Surface888& src, const BlitRect& srcRect, const BlitRect& s, const Surface565& dst, const BlitRect& dstRect, int factor)
+{
+    // destination pixels whose source pixels are all in the source surface; the pixels clipped off
+    // the source on the left and the top keep their place in the destination
+    const int      left   = (s.x - srcRect.x + factor - 1) / factor;
+    const int      top    = (s.y - srcRect.y + factor - 1) / factor;
+    const int      right  = (s.x + s.width - srcRect.x) / factor;
+    const int      bottom = (s.y + s.height - srcRect.y) / factor;
+    const BlitRect area   = { dstRect.x + left, dstRect.y + top, right - left, bottom - top };
+
+    BlitRect d;
+    if( ! clip(area, dst.width, dst.height, d))
+    {
+        return;
+    }
+
+    const int  sx     = srcRect.x + (d.x - dstRect.x) * factor;
+    const int  sy     = srcRect.y + (d.y - dstRect.y) * factor;
+    const bool stream = use_stream(d.width, d.height);
+
+    for(int y = 0; y < d.height; ++y)
+    {
+        unsigned short*     drow = dst.pixels + (d.y + y) * dst.stride + d.x;
+        const unsigned int* srow = src.pixels + (sy + y * factor) * src.stride + sx;
+        if(factor == 1)
+        {
+            const CopySource source = { srow };
+            convert_row(drow, d.width, source, stream);
+        }
+        else
+        {
+            const Box2Source source = { srow, srow + src.stride };
+            convert_row(drow, d.width, source, stream);
+        }
+    }
+
+    finish(stream);
+}
+
+void blit_nearest(const Surface888& src, const BlitRect& srcRect, const BlitRect& s, const Surface565& dst, const BlitRect& dstRect)
+{
+    if((dstRect.width <= 0) || (dstRect.height <= 0))
+    {
+        return;
+    }
+
+    // the scale is that of the whole srcRect; only the destination pixels which sample the source
+    // surface are written
+    const unsigned int stepX  = (static_cast<unsigned int>(srcRect.width) << 16) / dstRect.width;
+    const unsigned int stepY  = (static_cast<unsigned int>(srcRect.height) << 16) / dstRect.height;
+
+    if((stepX == 0) || (stepY == 0))
+    {
+        return;
+    }
+
+    const int          left   = first_reaching(s.x - srcRect.x, stepX);
+    const int          top    = first_reaching(s.y - srcRect.y, stepY);
+    const int          right  = min(first_reaching(s.x + s.width - srcRect.x, stepX), dstRect.width);
+    const int          bottom = min(first_reaching(s.y + s.height - srcRect.y, stepY), dstRect.height);
+    const BlitRect     area   = { dstRect.x + left, dstRect.y + top, right - left, bottom - top };
+
+    BlitRect d;
+    if( ! clip(area, dst.width, dst.height, d))
+    {
+        return;
+    }
+
+    const unsigned int startX = (d.x - dstRect.x) * stepX + stepX / 2;
+    const unsigned int startY = (d.y - dstRect.y) * stepY + stepY / 2;
+    const bool         stream = use_stream(d.width, d.height);
+
+    for(int y = 0; y < d.height; ++y)
+    {
+        const int           sy     = srcRect.y + static_cast<int>((startY + y * stepY) >> 16);
+        unsigned short*     drow   = dst.pixels + (d.y + y) * dst.stride + d.x;
+        const NearestSource source = { src.pixels + sy * src.stride, srcRect.x, startX, stepX };
+        convert_row(drow, d.width, source, stream);
+    }
+
+    finish(stream);
+}
+
+} // namespace
+
+void blit_rgb888to565(const Surface888& src, const BlitRect& srcRect, const Surface565& dst, const BlitRect& dstRect, BlitScale scale)
+{
+    BlitRect s;
+    if( ! clip(srcRect, src.width, src.height, s))
+    {
+        return;
+    }
+
+    switch(scale)
+    {
+    case BLIT_SCALE_NONE:    blit_unscaled(src, srcRect, s, dst, dstRect, 1); break;
+    case BLIT_SCALE_BOX2:    blit_unscaled(src, srcRect, s, dst, dstRect, 2); break;
+    case BLIT_SCALE_NEAREST: blit_nearest(src, srcRect, s, dst, dstRect);     break;
+    }
+}
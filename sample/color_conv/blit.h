@@ -0,0 +1,45 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+// pixels of Surface888 are 0x00RRGGBB (as make_rgb888), pixels of Surface565 are RGB565 (as make_rgb565)
+// stride is the distance between rows, counted in pixels
+
+struct Surface888
+{
+    const unsigned int* pixels;
+    int                 width;
+    int                 height;
+    int                 stride;
+};
+
+struct Surface565
+{
+    unsigned short* pixels;
+    int             width;
+    int             height;
+    int             stride;
+};
+
+struct BlitRect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+enum BlitScale
+{
+    BLIT_SCALE_NONE,    // 1:1; the size of dstRect is ignored
+    BLIT_SCALE_NEAREST, // nearest neighbour from srcRect to dstRect
+    BLIT_SCALE_BOX2     // 2:1 box filter (average of 2x2 pixels); the size of dstRect is ignored
+};
+
+// destination area (in bytes) from which non-temporal stores are used
+static const unsigned int BLIT_STREAM_THRESHOLD = 1024 * 1024;
+
+// clip, scale and convert srcRect of src into dstRect of dst in one pass; parts of srcRect out of src
+// are not drawn, and the rest stays where it would be without clipping, at the scale of the whole srcRect
+void blit_rgb888to565(const Surface888& src, const BlitRect& srcRect, const Surface565& dst, const BlitRect& dstRect, BlitScale scale);
+
+#endif//BLIT_H
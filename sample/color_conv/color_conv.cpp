@@ -74,9 +74,5 @@ unsigned int rgb888to555(unsigned int rgb)
 
 unsigned int rgb888to565(unsigned int rgb)
 {
-    Bits<5> r;
-    Bits<6> g;
-    Bits<5> b;
-    (r, reserve<3>, g, reserve<2>, b, reserve<3>) = rgb;
-    return (r, g, b);
-}
\ No newline at end of file
+    return pack_rgb565(rgb);
+}
@@ -1,6 +1,8 @@
 #ifndef COLOR_CONV_H
 #define COLOR_CONV_H
 
+#include "Bits.h"
+
 unsigned int make_rgb555(unsigned int r, unsigned int g, unsigned int b);
 unsigned int make_rgb565(unsigned int r, unsigned int g, unsigned int b);
 unsigned int make_rgb888(unsigned int r, unsigned int g, unsigned int b);
@@ -11,4 +13,14 @@ unsigned int rgb565to888(unsigned int rgb);
 unsigned int rgb888to555(unsigned int rgb);
 unsigned int rgb888to565(unsigned int rgb);
 
+// rgb888to565 inline, for the pixel loops of the other conversions
+inline unsigned int pack_rgb565(unsigned int rgb)
+{
+    emattsan::bits::Bits<5> r;
+    emattsan::bits::Bits<6> g;
+    emattsan::bits::Bits<5> b;
+    (r, emattsan::bits::reserve<3>, g, emattsan::bits::reserve<2>, b, emattsan::bits::reserve<3>) = rgb;
+    return (r, g, b);
+}
+
 #endif//COLOR_CONV_H
@@ -61,4 +61,4 @@ unsigned int rgb888to565_naive(unsigned int rgb)
     const unsigned int g = (rgb >>  8) & 0xff;
     const unsigned int b =  rgb        & 0xff;
     return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-}
\ No newline at end of file
+}
@@ -1,15 +1,20 @@
-// g++ -ansi -Wall -O3 -o color_conv_test color_conv_test.cpp color_conv_naive.cpp color_conv.cpp
+// g++ -ansi -Wall -O3 -fopenmp -I../.. -o color_conv_test color_conv_test.cpp color_conv_naive.cpp color_conv.cpp blit.cpp blend.cpp palette.cpp ycbcr.cpp expand.cpp planar.cpp
 
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
-#include <boost/progress.hpp>
+#include <vector>
 
 #include "color_conv.h"
 #include "color_conv_naive.h"
-
-volatile unsigned int rgb555[0x20][0x20][0x20];
-volatile unsigned int rgb565[0x20][0x40][0x20];
-volatile unsigned int rgb888[0x100][0x100][0x100];
+#include "blit.h"
+#include "blend.h"
+#include "palette.h"
+#include "ycbcr.h"
+#include "expand.h"
+#include "planar.h"
 
 void compare_make_rgb555()
 {
@@ -161,364 +166,692 @@ void compare_rgb888to565()
     std::cout << "ok" << std::endl;
 }
 
-void test_make_rgb555()
+// average of 2x2 pixels, channel by channel
+unsigned int blit_average_reference(unsigned int p0, unsigned int p1, unsigned int p2, unsigned int p3)
 {
-    std::cout << "test_make_rgb555:";
-    boost::progress_timer t;
-
-    for(int i = 0; i < 1000; ++i)
+    unsigned int avg = 0;
+    for(int shift = 0; shift < 24; shift += 8)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
-        {
-            for(unsigned int g = 0; g < 0x20; ++g)
-            {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb555[r][g][b] = make_rgb555(r, g, b);
-                }
-            }
-        }
+        const unsigned int sum = ((p0 >> shift) & 0xff) + ((p1 >> shift) & 0xff) + ((p2 >> shift) & 0xff) + ((p3 >> shift) & 0xff);
+        avg |= ((sum + 2) / 4) << shift;
     }
+    return avg;
 }
 
-void test_make_rgb565()
+// blit_rgb888to565 pixel by pixel: every destination pixel of the unclipped mapping is written if it
+// is in dst and all of its source pixels are in src
+void blit_reference(const Surface888& src, const BlitRect& sr, const Surface565& dst, const BlitRect& dr, BlitScale scale)
 {
-    std::cout << "test_make_rgb565:";
-    boost::progress_timer t;
+    const int    factor = (scale == BLIT_SCALE_BOX2) ? 2 : 1;
+    const int    width  = (scale == BLIT_SCALE_NEAREST) ? dr.width : sr.width / factor;
+    const int    height = (scale == BLIT_SCALE_NEAREST) ? dr.height : sr.height / factor;
+    unsigned int stepX  = 0;
+    unsigned int stepY  = 0;
+    if(scale == BLIT_SCALE_NEAREST)
+    {
+        if((width <= 0) || (height <= 0))
+        {
+            return;
+        }
+        stepX = (static_cast<unsigned int>(sr.width) << 16) / width;
+        stepY = (static_cast<unsigned int>(sr.height) << 16) / height;
+    }
 
-    for(int i = 0; i < 1000; ++i)
+    for(int y = 0; y < height; ++y)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        for(int x = 0; x < width; ++x)
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
+            const int dx = dr.x + x;
+            const int dy = dr.y + y;
+            const int sx = sr.x + ((scale == BLIT_SCALE_NEAREST) ? static_cast<int>((x * stepX + stepX / 2) >> 16) : x * factor);
+            const int sy = sr.y + ((scale == BLIT_SCALE_NEAREST) ? static_cast<int>((y * stepY + stepY / 2) >> 16) : y * factor);
+            if((dx < 0) || (dst.width <= dx) || (dy < 0) || (dst.height <= dy) ||
+               (sx < 0) || (src.width < sx + factor) || (sy < 0) || (src.height < sy + factor) ||
+               (sx + factor > sr.x + sr.width) || (sy + factor > sr.y + sr.height))
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb565[r][g][b] = make_rgb555(r, g, b);
-                }
+                continue;
             }
+            const unsigned int* p = src.pixels + sy * src.stride + sx;
+            const unsigned int  rgb = (factor == 1) ? p[0] : blit_average_reference(p[0], p[1], p[src.stride], p[src.stride + 1]);
+            dst.pixels[dy * dst.stride + dx] = static_cast<unsigned short>(rgb888to565_naive(rgb));
         }
     }
 }
 
-void test_make_rgb888()
+// the blit against the reference on destinations filled with the same pattern
+void check_blit(const Surface888& src, const BlitRect& sr, int width, int height, const BlitRect& dr, BlitScale scale)
+{
+    const int                   stride = width + 3;
+    std::vector<unsigned short> actual(stride * height);
+    std::vector<unsigned short> expected(stride * height);
+    for(std::size_t i = 0; i < actual.size(); ++i)
+    {
+        actual[i] = expected[i] = static_cast<unsigned short>(i * 0x9e37);
+    }
+
+    const Surface565 a = { &actual[0], width, height, stride };
+    const Surface565 e = { &expected[0], width, height, stride };
+    blit_rgb888to565(src, sr, a, dr, scale);
+    blit_reference(src, sr, e, dr, scale);
+    assert(actual == expected);
+}
+
+void compare_blit_rgb888to565()
 {
-    std::cout << "test_make_rgb888:";
-    boost::progress_timer t;
+    std::cout << "compare_blit_rgb888to565:";
+
+    static unsigned int   src[61][67];
+    static unsigned short dst[53][59];
 
-    for(int i = 0; i < 10; ++i)
+    for(unsigned int y = 0; y < 61; ++y)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        for(unsigned int x = 0; x < 67; ++x)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
-            {
-                for(unsigned int b = 0; b < 0x100; ++b)
-                {
-                    rgb888[r][g][b] = make_rgb555(r, g, b);
-                }
-            }
+            src[y][x] = (x * 0x010305 + y * 0x070b0d) & 0xffffff;
         }
     }
-}
 
-void test_rgb555to565()
-{
-    std::cout << "test_rgb555to565:";
-    boost::progress_timer t;
+    const Surface888 s = { &src[0][0], 60, 61, 67 };
+    const Surface565 d = { &dst[0][0], 50, 53, 59 };
 
-    for(int i = 0; i < 1000; ++i)
+    // 1:1, clipped by the destination on the left/top and by the source on the right/bottom
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        const BlitRect sr = { 10, 5, 100, 100 };
+        const BlitRect dr = { -3, -2, 0, 0 };
+        blit_rgb888to565(s, sr, d, dr, BLIT_SCALE_NONE);
+        for(int y = 0; y < 53; ++y)
         {
-            for(unsigned int g = 0; g < 0x20; ++g)
+            for(int x = 0; x < 47; ++x)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb565[r][g * 2][b] = rgb555to565(rgb555[r][g][b]);
-                }
+                assert(rgb888to565_naive(src[y + 7][x + 13]) == dst[y][x]);
             }
         }
     }
-}
-
-void test_rgb555to888()
-{
-    std::cout << "test_rgb555to888:";
-    boost::progress_timer t;
 
-    for(int i = 0; i < 1000; ++i)
+    // 2:1 box filter
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        const BlitRect sr = { 1, 1, 40, 40 };
+        const BlitRect dr = { 3, 4, 0, 0 };
+        blit_rgb888to565(s, sr, d, dr, BLIT_SCALE_BOX2);
+        for(int y = 0; y < 20; ++y)
         {
-            for(unsigned int g = 0; g < 0x20; ++g)
+            for(int x = 0; x < 20; ++x)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
+                const unsigned int* p0 = &src[1 + y * 2][1 + x * 2];
+                const unsigned int* p1 = &src[2 + y * 2][1 + x * 2];
+                unsigned int avg = 0;
+                for(int shift = 0; shift < 24; shift += 8)
                 {
-                    rgb888[r * 8][g * 8][b * 8] = rgb555to888(rgb555[r][g][b]);
+                    const unsigned int sum = ((p0[0] >> shift) & 0xff) + ((p0[1] >> shift) & 0xff) + ((p1[0] >> shift) & 0xff) + ((p1[1] >> shift) & 0xff);
+                    avg |= ((sum + 2) / 4) << shift;
                 }
+                assert(rgb888to565_naive(avg) == dst[4 + y][3 + x]);
             }
         }
     }
-}
-
-void test_rgb565to555()
-{
-    std::cout << "test_rgb565to555:";
-    boost::progress_timer t;
 
-    for(int i = 0; i < 1000; ++i)
+    // nearest, 3:2 enlargement, clipped by the destination on the right/bottom
+    // (pixel centers are sampled in 16.16 fixed point)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        const unsigned int step = (40u << 16) / 60;
+        const BlitRect sr = { 0, 0, 40, 40 };
+        const BlitRect dr = { 2, 2, 60, 60 };
+        blit_rgb888to565(s, sr, d, dr, BLIT_SCALE_NEAREST);
+        for(int y = 2; y < 53; ++y)
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
+            for(int x = 2; x < 50; ++x)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb555[r][g / 2][b] = rgb565to555(rgb565[r][g][b]);
-                }
+                const int sx = ((x - 2) * step + step / 2) >> 16;
+                const int sy = ((y - 2) * step + step / 2) >> 16;
+                assert(rgb888to565_naive(src[sy][sx]) == dst[y][x]);
             }
         }
     }
-}
-
-void test_rgb565to888()
-{
-    std::cout << "test_rgb565to888:";
-    boost::progress_timer t;
 
-    for(int i = 0; i < 1000; ++i)
+    // source rectangles out of the source on every side; what is clipped off keeps its place and
+    // the scale of the whole rectangle
+    const BlitRect sources[] =
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        { -10, -7, 40, 30 }, { 35, 41, 40, 30 }, { -5, 50, 80, 20 }, { -3, -4, 70, 70 }, { 59, 0, 8, 8 }, { -11, -9, 9, 9 }
+    };
+    const BlitRect destinations[] =
+    {
+        { 4, 3, 37, 29 }, { -6, -2, 61, 45 }, { 45, 40, 23, 17 }, { 0, 0, 1, 1 }
+    };
+    const BlitScale scales[] = { BLIT_SCALE_NONE, BLIT_SCALE_BOX2, BLIT_SCALE_NEAREST };
+    for(std::size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i)
+    {
+        for(std::size_t j = 0; j < sizeof(destinations) / sizeof(destinations[0]); ++j)
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
+            for(std::size_t k = 0; k < sizeof(scales) / sizeof(scales[0]); ++k)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb888[r * 8][g * 4][b * 8] = rgb565to888(rgb565[r][g][b]);
-                }
+                check_blit(s, sources[i], 50, 53, destinations[j], scales[k]);
             }
         }
     }
+
+    // non-temporal stores, from BLIT_STREAM_THRESHOLD bytes of destination
+    {
+        const int                 width  = 1031;
+        const int                 height = BLIT_STREAM_THRESHOLD / sizeof(unsigned short) / 1000 + 2;
+        std::vector<unsigned int> pixels(width * height);
+        for(std::size_t i = 0; i < pixels.size(); ++i)
+        {
+            pixels[i] = static_cast<unsigned int>(i * 0x010305) & 0xffffff;
+        }
+        const Surface888 large = { &pixels[0], width, height, width };
+        const BlitRect   sr    = { -7, -3, width + 20, height + 10 };
+        const BlitRect   dr    = { 1, 0, width, height };
+        check_blit(large, sr, width, height, dr, BLIT_SCALE_NONE);
+        check_blit(large, sr, width, height, dr, BLIT_SCALE_NEAREST);
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+unsigned int blend_rgb565_reference(unsigned int dst, unsigned int src, unsigned int alpha)
+{
+    unsigned int result = 0;
+    const unsigned int shifts[] = { 11, 5, 0 };
+    const unsigned int masks[]  = { 0x1f, 0x3f, 0x1f };
+    for(int i = 0; i < 3; ++i)
+    {
+        const unsigned int d = (dst >> shifts[i]) & masks[i];
+        const unsigned int s = (src >> shifts[i]) & masks[i];
+        result |= ((d * (32 - alpha) + s * alpha) >> 5) << shifts[i];
+    }
+    return result;
 }
 
-void test_rgb888to555()
+void compare_blend_rgb565()
 {
-    std::cout << "test_rgb888to555:";
-    boost::progress_timer t;
+    std::cout << "compare_blend_rgb565:";
 
-    for(int i = 0; i < 10; ++i)
+    const int n = 1003;
+    static unsigned short src[n];
+    static unsigned short dst[n];
+    static unsigned short result[n];
+    static unsigned char  alpha[n];
+
+    for(int i = 0; i < n; ++i)
+    {
+        src[i]   = static_cast<unsigned short>(i * 40503u);
+        dst[i]   = static_cast<unsigned short>(i * 7919u + 12345u);
+        alpha[i] = static_cast<unsigned char>(i * 37u);
+    }
+
+    for(unsigned int a = 0; a <= 32; ++a)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        for(int i = 0; i < n; ++i)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
-            {
-                for(unsigned int b = 0; b < 0x100; ++b)
-                {
-                    rgb555[r / 8][g / 8][b / 8] = rgb888to555(rgb888[r][g][b]);
-                }
-            }
+            assert(blend_rgb565_reference(dst[i], src[i], a) == blend_rgb565(dst[i], src[i], a));
+        }
+    }
+
+    for(unsigned int a = 0; a < 256; a += 17)
+    {
+        std::copy(dst, dst + n, result);
+        blend_rgb565_const(result, src, n, a);
+        for(int i = 0; i < n; ++i)
+        {
+            assert(blend_rgb565_reference(dst[i], src[i], (a + 4) / 8) == result[i]);
         }
     }
+
+    std::copy(dst, dst + n, result);
+    blend_rgb565_alpha(result, src, alpha, n);
+    for(int i = 0; i < n; ++i)
+    {
+        assert(blend_rgb565_reference(dst[i], src[i], (alpha[i] + 4) / 8) == result[i]);
+    }
+
+    std::copy(dst, dst + n, result);
+    blend_argb1555_key(result, src, n);
+    for(int i = 0; i < n; ++i)
+    {
+        assert(((src[i] & 0x8000) ? rgb555to565_naive(src[i] & 0x7fff) : dst[i]) == result[i]);
+    }
+
+    std::cout << "ok" << std::endl;
 }
 
-void test_rgb888to565()
+void compare_palette()
 {
-    std::cout << "test_rgb888to565:";
-    boost::progress_timer t;
+    std::cout << "compare_palette:";
+
+    // an image with 200 different RGB565 colors is reproduced exactly by a 256 color palette
+    const int n = 4000;
+    static unsigned int  image[n];
+    static unsigned char indexed[n];
+    for(int i = 0; i < n; ++i)
+    {
+        const unsigned int c = (i % 200) * 97;
+        image[i] = make_rgb888_naive(((c >> 6) & 0x1f) * 8 + 4, ((c >> 1) & 0x3f) * 4 + 2, (c & 0x1f) * 8 + 4);
+    }
 
-    for(int i = 0; i < 10; ++i)
+    Palette palette;
+    build_palette(image, n, 256, palette);
+    assert(palette.size == 200);
+
+    static InverseTable table;
+    build_inverse_table(palette, table);
+    map_to_indexed(image, n, table, indexed);
+    for(int i = 0; i < n; ++i)
+    {
+        assert(palette.colors[indexed[i]] == image[i]);
+    }
+
+    // with fewer colors every table entry is one of the nearest palette colors
+    build_palette(image, n, 16, palette);
+    assert(palette.size == 16);
+    build_inverse_table(palette, table);
+    for(unsigned int c = 0; c < 0x10000; c += 11)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        const unsigned int rgb = rgb565to888_naive(c) | 0x040204;
+        int best = 0x7fffffff;
+        int found = 0;
+        for(int i = 0; i < palette.size; ++i)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
+            int d = 0;
+            for(int shift = 0; shift < 24; shift += 8)
             {
-                for(unsigned int b = 0; b < 0x100; ++b)
-                {
-                    rgb565[r / 8][g / 4][b / 8] = rgb888to565(rgb888[r][g][b]);
-                }
+                const int e = static_cast<int>((rgb >> shift) & 0xff) - static_cast<int>((palette.colors[i] >> shift) & 0xff);
+                d += e * e;
             }
+            best  = (d < best) ? d : best;
+            found = (i == table.index[c]) ? d : found;
         }
+        assert(found == best);
     }
+
+    std::cout << "ok" << std::endl;
 }
 
-void test_make_rgb555_naive()
+void compare_quantize_frames()
 {
-    std::cout << "test_make_rgb555_naive:";
-    boost::progress_timer t;
+    std::cout << "compare_quantize_frames:";
+
+    // every frame gets the same palette and indices as the one frame functions give
+    const int frameCount = 5;
+    const int n          = 3001;
+    static unsigned int  images[frameCount][n];
+    static unsigned char indexed[frameCount][n];
+    static unsigned char expected[n];
+    unsigned int x = 2463534242u;
+    for(int f = 0; f < frameCount; ++f)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            // frames differ in how many colors they use
+            images[f][i] = (x & 0xffffff) % (1u << (f * 4 + 4));
+        }
+    }
 
-    for(int i = 0; i < 1000; ++i)
+    const unsigned int* frames[frameCount];
+    unsigned char*      outputs[frameCount];
+    for(int f = 0; f < frameCount; ++f)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        frames[f]  = images[f];
+        outputs[f] = indexed[f];
+    }
+    Palette palettes[frameCount];
+    quantize_frames(frames, frameCount, n, 64, palettes, outputs);
+
+    static InverseTable table;
+    for(int f = 0; f < frameCount; ++f)
+    {
+        Palette palette;
+        build_palette(images[f], n, 64, palette);
+        assert(palettes[f].size == palette.size);
+        for(int i = 0; i < palette.size; ++i)
         {
-            for(unsigned int g = 0; g < 0x20; ++g)
-            {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb555[r][g][b] = make_rgb555_naive(r, g, b);
-                }
-            }
+            assert(palettes[f].colors[i] == palette.colors[i]);
+        }
+        build_inverse_table(palette, table);
+        map_to_indexed(images[f], n, table, expected);
+        for(int i = 0; i < n; ++i)
+        {
+            assert(indexed[f][i] == expected[i]);
         }
     }
+
+    std::cout << "ok" << std::endl;
 }
 
-void test_make_rgb565_naive()
+// floating point BT.601/BT.709 video range conversion
+unsigned int ycbcr_to_rgb888_reference(int y, int cb, int cr, YCbCrMatrix matrix)
 {
-    std::cout << "test_make_rgb565_naive:";
-    boost::progress_timer t;
+    const double kr = (matrix == YCBCR_BT601) ? 0.299 : 0.2126;
+    const double kb = (matrix == YCBCR_BT601) ? 0.114 : 0.0722;
+    const double yy = (y - 16) * 255.0 / 219.0;
+    const double u  = (cb - 128) * 255.0 / 224.0;
+    const double v  = (cr - 128) * 255.0 / 224.0;
+    const double rgb[] =
+    {
+        yy + 2 * (1 - kr) * v,
+        yy - 2 * (1 - kb) * kb / (1 - kr - kb) * u - 2 * (1 - kr) * kr / (1 - kr - kb) * v,
+        yy + 2 * (1 - kb) * u
+    };
+    unsigned int result = 0;
+    for(int i = 0; i < 3; ++i)
+    {
+        const double c = std::floor(rgb[i] + 0.5);
+        result = (result << 8) | static_cast<unsigned int>((c < 0) ? 0 : ((255 < c) ? 255 : c));
+    }
+    return result;
+}
 
-    for(int i = 0; i < 1000; ++i)
+bool near_rgb888(unsigned int lhs, unsigned int rhs, int tolerance)
+{
+    for(int shift = 0; shift < 24; shift += 8)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        const int d = static_cast<int>((lhs >> shift) & 0xff) - static_cast<int>((rhs >> shift) & 0xff);
+        if((d < -tolerance) || (tolerance < d))
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
-            {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb565[r][g][b] = make_rgb555_naive(r, g, b);
-                }
-            }
+            return false;
         }
     }
+    return true;
 }
 
-void test_make_rgb888_naive()
+void compare_ycbcr()
 {
-    std::cout << "test_make_rgb888_naive:";
-    boost::progress_timer t;
+    std::cout << "compare_ycbcr:";
+
+    const int width  = 37;
+    const int height = 6;
+    const int cw     = (width + 1) / 2;
+
+    static unsigned char  y[height][width];
+    static unsigned char  cb[height][cw];
+    static unsigned char  cr[height][cw];
+    static unsigned char  cbcr[height][cw * 2];
+    static unsigned int   rgb888[height][width];
+    static unsigned short rgb565[height][width];
 
-    for(int i = 0; i < 10; ++i)
+    const YCbCrMatrix matrices[] = { YCBCR_BT601, YCBCR_BT709 };
+    for(int m = 0; m < 2; ++m)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        for(int seed = 0; seed < 256; ++seed)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
+            for(int j = 0; j < height; ++j)
             {
-                for(unsigned int b = 0; b < 0x100; ++b)
+                for(int i = 0; i < width; ++i)
                 {
-                    rgb888[r][g][b] = make_rgb555_naive(r, g, b);
+                    y[j][i] = static_cast<unsigned char>(seed + i * 7 + j * 13);
+                }
+                for(int i = 0; i < cw; ++i)
+                {
+                    cb[j][i] = cbcr[j][i * 2]     = static_cast<unsigned char>(seed * 3 + i * 11);
+                    cr[j][i] = cbcr[j][i * 2 + 1] = static_cast<unsigned char>(seed * 5 + j * 17 + i);
                 }
             }
-        }
-    }
-}
 
-void test_rgb555to565_naive()
-{
-    std::cout << "test_rgb555to565_naive:";
-    boost::progress_timer t;
+            // 4:2:0
+            i420_to_rgb888(&y[0][0], width, &cb[0][0], &cr[0][0], cw, width, height, &rgb888[0][0], width, matrices[m]);
+            i420_to_rgb565(&y[0][0], width, &cb[0][0], &cr[0][0], cw, width, height, &rgb565[0][0], width, matrices[m]);
+            for(int j = 0; j < height; ++j)
+            {
+                for(int i = 0; i < width; ++i)
+                {
+                    const int c = i / 2;
+                    const unsigned int expected = ycbcr_to_rgb888_reference(y[j][i], cb[j / 2][c], cr[j / 2][c], matrices[m]);
+                    assert(near_rgb888(expected, rgb888[j][i], 3));
+                    assert(rgb888to565_naive(rgb888[j][i]) == rgb565[j][i]);
+
+                    // the row kernels give the same result as the conversion of a single pixel
+                    unsigned int single;
+                    i420_to_rgb888(&y[j][i], width, &cb[j / 2][c], &cr[j / 2][c], cw, 1, 1, &single, 1, matrices[m]);
+                    assert(single == rgb888[j][i]);
+                }
+            }
 
-    for(int i = 0; i < 1000; ++i)
-    {
-        for(unsigned int r = 0; r < 0x20; ++r)
-        {
-            for(unsigned int g = 0; g < 0x20; ++g)
+            // NV12 is the same as I420 of the same samples
+            static unsigned int nv12[height][width];
+            nv12_to_rgb888(&y[0][0], width, &cbcr[0][0], cw * 2, width, height, &nv12[0][0], width, matrices[m]);
+            assert(std::equal(&rgb888[0][0], &rgb888[0][0] + width * height, &nv12[0][0]));
+
+            // 4:2:2
+            i422_to_rgb888(&y[0][0], width, &cb[0][0], &cr[0][0], cw, width, height, &rgb888[0][0], width, matrices[m]);
+            for(int j = 0; j < height; ++j)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
+                for(int i = 0; i < width; ++i)
                 {
-                    rgb565[r][g * 2][b] = rgb555to565_naive(rgb555[r][g][b]);
+                    const unsigned int expected = ycbcr_to_rgb888_reference(y[j][i], cb[j][i / 2], cr[j][i / 2], matrices[m]);
+                    assert(near_rgb888(expected, rgb888[j][i], 3));
                 }
             }
         }
-    }
-}
 
-void test_rgb555to888_naive()
-{
-    std::cout << "test_rgb555to888_naive:";
-    boost::progress_timer t;
-
-    for(int i = 0; i < 1000; ++i)
-    {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        // RGB -> I420 -> RGB roundtrip of flat 2x2 blocks
+        for(int j = 0; j < height; ++j)
+        {
+            for(int i = 0; i < width; ++i)
+            {
+                rgb888[j][i] = (((i / 2) * 0x3f1b07) ^ ((j / 2) * 0x1c3e71)) & 0xffffff;
+            }
+        }
+        rgb888_to_i420(&rgb888[0][0], width, width, height, &y[0][0], width, &cb[0][0], &cr[0][0], cw, matrices[m]);
+        static unsigned int roundtrip[height][width];
+        i420_to_rgb888(&y[0][0], width, &cb[0][0], &cr[0][0], cw, width, height, &roundtrip[0][0], width, matrices[m]);
+        for(int j = 0; j < height; ++j)
         {
-            for(unsigned int g = 0; g < 0x20; ++g)
+            for(int i = 0; i < width; ++i)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
+                // saturated colors are out of the video range and are clipped
+                const unsigned int c = rgb888[j][i];
+                if(near_rgb888(c, 0x808080, 0x50))
                 {
-                    rgb888[r * 8][g * 8][b * 8] = rgb555to888_naive(rgb555[r][g][b]);
+                    assert(near_rgb888(c, roundtrip[j][i], 4));
                 }
             }
         }
-    }
-}
 
-void test_rgb565to555_naive()
-{
-    std::cout << "test_rgb565to555_naive:";
-    boost::progress_timer t;
+        for(int j = 0; j < height; ++j)
+        {
+            for(int i = 0; i < width; ++i)
+            {
+                rgb565[j][i] = static_cast<unsigned short>(rgb888to565_naive(rgb888[j][i]));
+            }
+        }
+        static unsigned char y565[height][width];
+        rgb565_to_i420(&rgb565[0][0], width, width, height, &y565[0][0], width, &cb[0][0], &cr[0][0], cw, matrices[m]);
+        for(int j = 0; j < height; ++j)
+        {
+            for(int i = 0; i < width; ++i)
+            {
+                assert(std::abs(y565[j][i] - y[j][i]) <= 8);
+            }
+        }
 
-    for(int i = 0; i < 1000; ++i)
-    {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        // the row kernels give the same samples as the conversion of a single block, and NV12 the same as I420
+        unsigned int x = 2463534242u;
+        for(int j = 0; j < height; ++j)
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
+            for(int i = 0; i < width; ++i)
             {
-                for(unsigned int b = 0; b < 0x20; ++b)
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                rgb888[j][i] = x;
+                rgb565[j][i] = static_cast<unsigned short>(x >> 7);
+            }
+        }
+        for(int format = 0; format < 2; ++format)
+        {
+            // an odd height leaves a last row of its own
+            for(int h = height - 1; h <= height; ++h)
+            {
+                if(format == 0)
+                {
+                    rgb888_to_i420(&rgb888[0][0], width, width, h, &y[0][0], width, &cb[0][0], &cr[0][0], cw, matrices[m]);
+                    rgb888_to_nv12(&rgb888[0][0], width, width, h, &y565[0][0], width, &cbcr[0][0], cw * 2, matrices[m]);
+                }
+                else
                 {
-                    rgb555[r][g / 2][b] = rgb565to555_naive(rgb565[r][g][b]);
+                    rgb565_to_i420(&rgb565[0][0], width, width, h, &y[0][0], width, &cb[0][0], &cr[0][0], cw, matrices[m]);
+                    rgb565_to_nv12(&rgb565[0][0], width, width, h, &y565[0][0], width, &cbcr[0][0], cw * 2, matrices[m]);
+                }
+                for(int j = 0; j < h; j += 2)
+                {
+                    for(int i = 0; i < width; i += 2)
+                    {
+                        const int     bw = (i + 1 < width) ? 2 : 1;
+                        const int     bh = (j + 1 < h) ? 2 : 1;
+                        unsigned char by[2][2];
+                        unsigned char bcb;
+                        unsigned char bcr;
+                        if(format == 0)
+                        {
+                            rgb888_to_i420(&rgb888[j][i], width, bw, bh, &by[0][0], 2, &bcb, &bcr, 1, matrices[m]);
+                        }
+                        else
+                        {
+                            rgb565_to_i420(&rgb565[j][i], width, bw, bh, &by[0][0], 2, &bcb, &bcr, 1, matrices[m]);
+                        }
+                        for(int jj = 0; jj < bh; ++jj)
+                        {
+                            for(int ii = 0; ii < bw; ++ii)
+                            {
+                                assert(y[j + jj][i + ii] == by[jj][ii]);
+                                assert(y565[j + jj][i + ii] == by[jj][ii]);
+                            }
+                        }
+                        assert(cb[j / 2][i / 2] == bcb);
+                        assert(cr[j / 2][i / 2] == bcr);
+                        assert(cbcr[j / 2][i] == bcb);
+                        assert(cbcr[j / 2][i + 1] == bcr);
+                    }
                 }
             }
         }
     }
+
+    std::cout << "ok" << std::endl;
 }
 
-void test_rgb565to888_naive()
+void compare_expand()
 {
-    std::cout << "test_rgb565to888_naive:";
-    boost::progress_timer t;
+    std::cout << "compare_expand:";
 
-    for(int i = 0; i < 1000; ++i)
+    const int width = 77;
+    static unsigned char src[(width * 4 + 7) / 8];
+    for(unsigned int i = 0; i < sizeof(src); ++i)
     {
-        for(unsigned int r = 0; r < 0x20; ++r)
+        src[i] = static_cast<unsigned char>(i * 157 + 31);
+    }
+
+    unsigned short palette565[16];
+    unsigned int   palette888[16];
+    for(unsigned int i = 0; i < 16; ++i)
+    {
+        palette565[i] = static_cast<unsigned short>(make_rgb565_naive(i * 2, 63 - i, i + 7));
+        palette888[i] = make_rgb888_naive(i * 16, 255 - i, i * 3 + 1);
+    }
+
+    static unsigned short dst565[width];
+    static unsigned int   dst888[width];
+
+    const int depths[] = { 1, 2, 4 };
+    for(int d = 0; d < 3; ++d)
+    {
+        const int bpp = depths[d];
+        switch(bpp)
         {
-            for(unsigned int g = 0; g < 0x40; ++g)
-            {
-                for(unsigned int b = 0; b < 0x20; ++b)
-                {
-                    rgb888[r * 8][g * 4][b * 8] = rgb565to888_naive(rgb565[r][g][b]);
-                }
-            }
+        case 1: expand_1bpp_to_rgb565(src, width, palette565, dst565); expand_1bpp_to_rgb888(src, width, palette888, dst888); break;
+        case 2: expand_2bpp_to_rgb565(src, width, palette565, dst565); expand_2bpp_to_rgb888(src, width, palette888, dst888); break;
+        case 4: expand_4bpp_to_rgb565(src, width, palette565, dst565); expand_4bpp_to_rgb888(src, width, palette888, dst888); break;
+        }
+        for(int x = 0; x < width; ++x)
+        {
+            const int bit   = x * bpp;
+            const int index = (src[bit / 8] >> (8 - bpp - bit % 8)) & ((1 << bpp) - 1);
+            assert(palette565[index] == dst565[x]);
+            assert(palette888[index] == dst888[x]);
         }
     }
+
+    std::cout << "ok" << std::endl;
 }
 
-void test_rgb888to555_naive()
+void compare_planar()
 {
-    std::cout << "test_rgb888to555_naive:";
-    boost::progress_timer t;
+    std::cout << "compare_planar:";
 
-    for(int i = 0; i < 10; ++i)
+    // 64x64 transpose against bit by bit transposition
+    uint64_t rows[64];
+    uint64_t x = 88172645463325252ULL;
+    for(int i = 0; i < 64; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        rows[i] = x;
+    }
+    uint64_t transposed[64];
+    std::copy(rows, rows + 64, transposed);
+    transpose64x64(transposed);
+    for(int i = 0; i < 64; ++i)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        for(int j = 0; j < 64; ++j)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
-            {
-                for(unsigned int b = 0; b < 0x100; ++b)
-                {
-                    rgb555[r / 8][g / 8][b / 8] = rgb888to555_naive(rgb888[r][g][b]);
-                }
-            }
+            assert(((rows[i] >> (63 - j)) & 1) == ((transposed[j] >> (63 - i)) & 1));
         }
     }
-}
 
-void test_rgb888to565_naive()
-{
-    std::cout << "test_rgb888to565_naive:";
-    boost::progress_timer t;
+    const int n      = 77;
+    const int stride = 11;
+    static unsigned char  pixels8[n];
+    static unsigned short pixels16[n];
+    static unsigned char  planes[16][stride];
+    static unsigned char  chunky8[n];
+    static unsigned short chunky16[n];
+    for(int i = 0; i < n; ++i)
+    {
+        pixels16[i] = static_cast<unsigned short>(rgb888to565_naive(i * 0x030507 + 0x123456));
+        pixels8[i]  = static_cast<unsigned char>(pixels16[i]);
+    }
 
-    for(int i = 0; i < 10; ++i)
+    for(int bpp = 1; bpp <= 16; ++bpp)
     {
-        for(unsigned int r = 0; r < 0x100; ++r)
+        const unsigned int mask = (1u << bpp) - 1;
+
+        if(bpp <= 8)
         {
-            for(unsigned int g = 0; g < 0x100; ++g)
+            chunky8_to_planar(pixels8, n, bpp, &planes[0][0], stride);
+            for(int k = 0; k < bpp; ++k)
             {
-                for(unsigned int b = 0; b < 0x100; ++b)
+                for(int i = 0; i < n; ++i)
                 {
-                    rgb565[r / 8][g / 4][b / 8] = rgb888to565_naive(rgb888[r][g][b]);
+                    assert(((pixels8[i] >> k) & 1) == ((planes[k][i / 8] >> (7 - i % 8)) & 1));
                 }
             }
+            planar_to_chunky8(&planes[0][0], stride, n, bpp, chunky8);
+            for(int i = 0; i < n; ++i)
+            {
+                assert((pixels8[i] & mask) == chunky8[i]);
+            }
+        }
+
+        chunky16_to_planar(pixels16, n, bpp, &planes[0][0], stride);
+        for(int k = 0; k < bpp; ++k)
+        {
+            for(int i = 0; i < n; ++i)
+            {
+                assert(((pixels16[i] >> k) & 1) == ((planes[k][i / 8] >> (7 - i % 8)) & 1));
+            }
+        }
+        planar_to_chunky16(&planes[0][0], stride, n, bpp, chunky16);
+        for(int i = 0; i < n; ++i)
+        {
+            assert((pixels16[i] & mask) == chunky16[i]);
         }
     }
+
+    std::cout << "ok" << std::endl;
 }
 
 void test()
@@ -532,26 +865,13 @@ void test()
     compare_rgb565to888();
     compare_rgb888to555();
     compare_rgb888to565();
-
-    test_make_rgb555();
-    test_make_rgb565();
-    test_make_rgb888();
-    test_rgb555to565();
-    test_rgb555to888();
-    test_rgb565to555();
-    test_rgb565to888();
-    test_rgb888to555();
-    test_rgb888to565();
-
-    test_make_rgb555_naive();
-    test_make_rgb565_naive();
-    test_make_rgb888_naive();
-    test_rgb555to565_naive();
-    test_rgb555to888_naive();
-    test_rgb565to555_naive();
-    test_rgb565to888_naive();
-    test_rgb888to555_naive();
-    test_rgb888to565_naive();
+    compare_blit_rgb888to565();
+    compare_blend_rgb565();
+    compare_palette();
+    compare_quantize_frames();
+    compare_ycbcr();
+    compare_expand();
+    compare_planar();
 }
 
 int main(int, char* [])
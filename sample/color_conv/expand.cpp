@@ -0,0 +1,218 @@
+#include "expand.h"
+#include "Bits.h"
+
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+template<int BPP> struct Depth;
+
+template<>
+struct Depth<1>
+{
+    static const int PixelsPerByte = 8;
+
+    static void decode(unsigned int byte, unsigned int* index)
+    {
+        Bits<1> p0, p1, p2, p3, p4, p5, p6, p7;
+        (p0, p1, p2, p3, p4, p5, p6, p7) = byte;
+        index[0] = p0; index[1] = p1; index[2] = p2; index[3] = p3;
+        index[4] = p4; index[5] = p5; index[6] = p6; index[7] = p7;
+    }
+
+#ifdef __SSSE3__
+    // 16 indices from 2 bytes; each byte is broadcast to 8 lanes and tested against its bit
+    static __m128i indices16(const unsigned char* src)
+    {
+        const __m128i bytes = _mm_cvtsi32_si128(src[0] | (src[1] << 8));
+        const __m128i spread = _mm_shuffle_epi8(bytes, _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1));
+        const __m128i bit = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+        return _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(spread, bit), bit), _mm_set1_epi8(1));
+    }
+#endif
+};
+
+template<>
+struct Depth<2>
+{
+    static const int PixelsPerByte = 4;
+
+    static void decode(unsigned int byte, unsigned int* index)
+    {
+        Bits<2> p0, p1, p2, p3;
+        (p0, p1, p2, p3) = byte;
+        index[0] = p0; index[1] = p1; index[2] = p2; index[3] = p3;
+    }
+
+#ifdef __SSSE3__
+    // 16 indices from 4 bytes; bytes are split into nibbles, then each nibble into 2 indices by table lookup
+    static __m128i indices16(const unsigned char* src)
+    {
+        int n;
+        std::memcpy(&n, src, sizeof(n));
+        const __m128i bytes   = _mm_cvtsi32_si128(n);
+        const __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f)), _mm_and_si128(bytes, _mm_set1_epi8(0x0f)));
+        const __m128i left    = _mm_shuffle_epi8(_mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3), nibbles);
+        const __m128i right   = _mm_shuffle_epi8(_mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3), nibbles);
+        return _mm_unpacklo_epi8(left, right);
+    }
+#endif
+};
+
+template<>
+struct Depth<4>
+{
+    static const int PixelsPerByte = 2;
+
+    static void decode(unsigned int byte, unsigned int* index)
+    {
+        Bits<4> p0, p1;
+        (p0, p1) = byte;
+        index[0] = p0; index[1] = p1;
+    }
+
+#ifdef __SSSE3__
+    // 16 indices from 8 bytes
+    static __m128i indices16(const unsigned char* src)
+    {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+        return _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f)), _mm_and_si128(bytes, _mm_set1_epi8(0x0f)));
+    }
+#endif
+};
+
+#ifdef __SSSE3__
+
+// byte k of every palette entry, as a table for pshufb
+template<typename T>
+__m128i byte_table(const T* palette, int size, int k)
+{
+    unsigned char table[16] = {};
+    for(int i = 0; i < size; ++i)
+    {
+        table[i] = static_cast<unsigned char>(palette[i] >> (k * 8));
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+struct Rgb565
+{
+    typedef unsigned short pixel_type;
+
+    Rgb565(const pixel_type* palette, int size) : lo_(byte_table(palette, size, 0)), hi_(byte_table(palette, size, 1))
+    {
+    }
+
+    void store16(pixel_type* dst, __m128i index) const
+    {
+        const __m128i lo = _mm_shuffle_epi8(lo_, index);
+        const __m128i hi = _mm_shuffle_epi8(hi_, index);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),     _mm_unpacklo_epi8(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(lo, hi));
+    }
+
+    __m128i lo_;
+    __m128i hi_;
+};
+
+struct Rgb888
+{
+    typedef unsigned int pixel_type;
+
+    Rgb888(const pixel_type* palette, int size)
+    {
+        for(int k = 0; k < 4; ++k)
+        {
+            table_[k] = byte_table(palette, size, k);
+        }
+    }
+
+    void store16(pixel_type* dst, __m128i index) const
+    {
+        const __m128i b0  = _mm_shuffle_epi8(table_[0], index);
+        const __m128i b1  = _mm_shuffle_epi8(table_[1], index);
+        const __m128i b2  = _mm_shuffle_epi8(table_[2], index);
+        const __m128i b3  = _mm_shuffle_epi8(table_[3], index);
+        const __m128i lo0 = _mm_unpacklo_epi8(b0, b1);
+        const __m128i hi0 = _mm_unpacklo_epi8(b2, b3);
+        const __m128i lo1 = _mm_unpackhi_epi8(b0, b1);
+        const __m128i hi1 = _mm_unpackhi_epi8(b2, b3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),      _mm_unpacklo_epi16(lo0, hi0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4),  _mm_unpackhi_epi16(lo0, hi0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8),  _mm_unpacklo_epi16(lo1, hi1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 12), _mm_unpackhi_epi16(lo1, hi1));
+    }
+
+    __m128i table_[4];
+};
+
+#else
+
+struct Rgb565 { typedef unsigned short pixel_type; };
+struct Rgb888 { typedef unsigned int   pixel_type; };
+
+#endif
+
+template<int BPP, typename Out>
+void expand(const unsigned char* src, int width, const typename Out::pixel_type* palette, typename Out::pixel_type* dst)
+{
+    int x = 0;
+
+#ifdef __SSSE3__
+    const Out out(palette, 1 << BPP);
+    for(; x + 16 <= width; x += 16)
+    {
+        out.store16(dst + x, Depth<BPP>::indices16(src + x * BPP / 8));
+    }
+#endif
+
+    unsigned int index[8] = { 0 };
+    for(; x < width; x += Depth<BPP>::PixelsPerByte)
+    {
+        Depth<BPP>::decode(src[x * BPP / 8], index);
+        const int n = (x + Depth<BPP>::PixelsPerByte <= width) ? Depth<BPP>::PixelsPerByte : (width - x);
+        for(int i = 0; i < n; ++i)
+        {
+            dst[x + i] = palette[index[i]];
+        }
+    }
+}
+
+} // namespace
+
+void expand_1bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst)
+{
+    expand<1, Rgb565>(src, width, palette, dst);
+}
+
+void expand_2bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst)
+{
+    expand<2, Rgb565>(src, width, palette, dst);
+}
+
+void expand_4bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst)
+{
+    expand<4, Rgb565>(src, width, palette, dst);
+}
+
+void expand_1bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst)
+{
+    expand<1, Rgb888>(src, width, palette, dst);
+}
+
+void expand_2bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst)
+{
+    expand<2, Rgb888>(src, width, palette, dst);
+}
+
+void expand_4bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst)
+{
+    expand<4, Rgb888>(src, width, palette, dst);
+}
@@ -0,0 +1,16 @@
+#ifndef EXPAND_H
+#define EXPAND_H
+
+// expand a row of packed 1/2/4 bit pixels through a palette
+// pixels are stored from the most significant bits of each byte, as (p0, p1, ...) = byte
+// palettes have 2/4/16 entries, built with make_rgb565/make_rgb888
+
+void expand_1bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst);
+void expand_2bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst);
+void expand_4bpp_to_rgb565(const unsigned char* src, int width, const unsigned short* palette, unsigned short* dst);
+
+void expand_1bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst);
+void expand_2bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst);
+void expand_4bpp_to_rgb888(const unsigned char* src, int width, const unsigned int* palette, unsigned int* dst);
+
+#endif//EXPAND_H
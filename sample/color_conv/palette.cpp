@@ -0,0 +1,267 @@
+#include "palette.h"
+#include "color_conv.h"
+#include "Bits.h"
+
+#include <vector>
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+const int Cells = 0x20 * 0x40 * 0x20;
+
+inline unsigned int cell(int r, int g, int b)
+{
+    return (r << 11) | (g << 5) | b;
+}
+
+// center of an RGB565 cell in 8 bit scale
+inline int center(int c, int bits)
+{
+    return (c << (8 - bits)) + (1 << (7 - bits));
+}
+
+struct Box
+{
+    int           lo[3]; // r, g, b
+    int           hi[3];
+    unsigned long count;
+};
+
+const int Bits565[3] = { 5, 6, 5 };
+
+void count_box(const std::vector<unsigned int>& histogram, Box& box, unsigned long* planes, int axis)
+{
+    box.count = 0;
+    for(int r = box.lo[0]; r <= box.hi[0]; ++r)
+    {
+        for(int g = box.lo[1]; g <= box.hi[1]; ++g)
+        {
+            for(int b = box.lo[2]; b <= box.hi[2]; ++b)
+            {
+                const unsigned int n = histogram[cell(r, g, b)];
+                box.count += n;
+                if(planes != 0)
+                {
+                    const int c[3] = { r, g, b };
+                    planes[c[axis] - box.lo[axis]] += n;
+                }
+            }
+        }
+    }
+}
+
+// shrink the box to the populated cells
+void shrink(const std::vector<unsigned int>& histogram, Box& box)
+{
+    int lo[3] = { box.hi[0], box.hi[1], box.hi[2] };
+    int hi[3] = { box.lo[0], box.lo[1], box.lo[2] };
+    for(int r = box.lo[0]; r <= box.hi[0]; ++r)
+    {
+        for(int g = box.lo[1]; g <= box.hi[1]; ++g)
+        {
+            for(int b = box.lo[2]; b <= box.hi[2]; ++b)
+            {
+                if(histogram[cell(r, g, b)] != 0)
+                {
+                    const int c[3] = { r, g, b };
+                    for(int i = 0; i < 3; ++i)
+                    {
+                        lo[i] = (c[i] < lo[i]) ? c[i] : lo[i];
+                        hi[i] = (hi[i] < c[i]) ? c[i] : hi[i];
+                    }
+                }
+            }
+        }
+    }
+    for(int i = 0; i < 3; ++i)
+    {
+        box.lo[i] = lo[i];
+        box.hi[i] = hi[i];
+    }
+}
+
+// longest side in 8 bit scale; -1 if the box is a single cell
+int longest_axis(const Box& box)
+{
+    int axis   = -1;
+    int length = 0;
+    for(int i = 0; i < 3; ++i)
+    {
+        const int l = (box.hi[i] - box.lo[i]) << (8 - Bits565[i]);
+        if(length < l)
+        {
+            axis   = i;
+            length = l;
+        }
+    }
+    return axis;
+}
+
+void split(const std::vector<unsigned int>& histogram, Box& box, Box& other, int axis)
+{
+    unsigned long planes[0x40] = {};
+    count_box(histogram, box, planes, axis);
+
+    const int     length = box.hi[axis] - box.lo[axis] + 1;
+    unsigned long sum    = 0;
+    int           at     = 0;
+    for(; at < length - 2; ++at)
+    {
+        sum += planes[at];
+        if(sum * 2 >= box.count)
+        {
+            break;
+        }
+    }
+
+    other = box;
+    box.hi[axis]   = box.lo[axis] + at;
+    other.lo[axis] = box.lo[axis] + at + 1;
+
+    shrink(histogram, box);
+    shrink(histogram, other);
+    count_box(histogram, box, 0, axis);
+    count_box(histogram, other, 0, axis);
+}
+
+unsigned int average(const std::vector<unsigned int>& histogram, const Box& box)
+{
+    unsigned long sum[3] = {};
+    for(int r = box.lo[0]; r <= box.hi[0]; ++r)
+    {
+        for(int g = box.lo[1]; g <= box.hi[1]; ++g)
+        {
+            for(int b = box.lo[2]; b <= box.hi[2]; ++b)
+            {
+                const unsigned long n = histogram[cell(r, g, b)];
+                sum[0] += n * center(r, 5);
+                sum[1] += n * center(g, 6);
+                sum[2] += n * center(b, 5);
+            }
+        }
+    }
+
+    const Bits<8> r8((sum[0] + box.count / 2) / box.count);
+    const Bits<8> g8((sum[1] + box.count / 2) / box.count);
+    const Bits<8> b8((sum[2] + box.count / 2) / box.count);
+    return (r8, g8, b8);
+}
+
+} // namespace
+
+void build_palette(const unsigned int* pixels, int n, int maxColors, Palette& palette)
+{
+    palette.size = 0;
+    if(n <= 0)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> histogram(Cells);
+    for(int i = 0; i < n; ++i)
+    {
+        ++histogram[pack_rgb565(pixels[i])];
+    }
+
+    std::vector<Box> boxes;
+    boxes.reserve(256);
+    const Box whole = { { 0, 0, 0 }, { 0x1f, 0x3f, 0x1f }, 0 };
+    boxes.push_back(whole);
+    shrink(histogram, boxes[0]);
+    boxes[0].count = n;
+
+    const int limit = (maxColors < 256) ? maxColors : 256;
+    while(static_cast<int>(boxes.size()) < limit)
+    {
+        // split the most populated box that is not a single cell
+        int target = -1;
+        for(std::size_t i = 0; i < boxes.size(); ++i)
+        {
+            if((longest_axis(boxes[i]) >= 0) && ((target < 0) || (boxes[target].count < boxes[i].count)))
+            {
+                target = static_cast<int>(i);
+            }
+        }
+        if(target < 0)
+        {
+            break;
+        }
+
+        Box other;
+        split(histogram, boxes[target], other, longest_axis(boxes[target]));
+        boxes.push_back(other);
+    }
+
+    for(std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        palette.colors[i] = average(histogram, boxes[i]);
+    }
+    palette.size = static_cast<int>(boxes.size());
+}
+
+void build_inverse_table(const Palette& palette, InverseTable& table)
+{
+    int components[256][3];
+    for(int i = 0; i < palette.size; ++i)
+    {
+        Bits<8> r;
+        Bits<8> g;
+        Bits<8> b;
+        (r, g, b) = palette.colors[i];
+        components[i][0] = r;
+        components[i][1] = g;
+        components[i][2] = b;
+    }
+
+#pragma omp parallel for
+    for(int c = 0; c < Cells; ++c)
+    {
+        const int r = center((c >> 11) & 0x1f, 5);
+        const int g = center((c >>  5) & 0x3f, 6);
+        const int b = center( c        & 0x1f, 5);
+
+        int nearest  = 0;
+        int distance = 0x7fffffff;
+        for(int i = 0; i < palette.size; ++i)
+        {
+            const int dr = r - components[i][0];
+            const int dg = g - components[i][1];
+            const int db = b - components[i][2];
+            const int d  = dr * dr + dg * dg + db * db;
+            if(d < distance)
+            {
+                nearest  = i;
+                distance = d;
+            }
+        }
+        table.index[c] = static_cast<unsigned char>(nearest);
+    }
+}
+
+void map_to_indexed(const unsigned int* pixels, int n, const InverseTable& table, unsigned char* indexed)
+{
+    for(int i = 0; i < n; ++i)
+    {
+        indexed[i] = table.index[pack_rgb565(pixels[i])];
+    }
+}
+
+void quantize_frames(const unsigned int* const* frames, int frameCount, int n, int maxColors, Palette* palettes, unsigned char* const* indexed)
+{
+#pragma omp parallel
+    {
+        InverseTable* table = new InverseTable;
+
+#pragma omp for schedule(dynamic)
+        for(int f = 0; f < frameCount; ++f)
+        {
+            build_palette(frames[f], n, maxColors, palettes[f]);
+            build_inverse_table(palettes[f], *table);
+            map_to_indexed(frames[f], n, *table, indexed[f]);
+        }
+
+        delete table;
+    }
+}
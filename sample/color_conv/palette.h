@@ -0,0 +1,29 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+// colors are 0x00RRGGBB (as make_rgb888)
+struct Palette
+{
+    unsigned int colors[256];
+    int          size;
+};
+
+// palette index of each RGB565 value; indexed by the Bits<5>/Bits<6>/Bits<5> fields of rgb888to565
+struct InverseTable
+{
+    unsigned char index[0x20 * 0x40 * 0x20];
+};
+
+// median cut over the RGB565 histogram of pixels; palette.size becomes at most maxColors (<= 256)
+void build_palette(const unsigned int* pixels, int n, int maxColors, Palette& palette);
+
+// nearest palette entry for every RGB565 value
+void build_inverse_table(const Palette& palette, InverseTable& table);
+
+// indexed[i] = table.index[rgb888to565(pixels[i])]
+void map_to_indexed(const unsigned int* pixels, int n, const InverseTable& table, unsigned char* indexed);
+
+// build_palette, build_inverse_table and map_to_indexed for each frame; frames are processed in parallel with OpenMP
+void quantize_frames(const unsigned int* const* frames, int frameCount, int n, int maxColors, Palette* palettes, unsigned char* const* indexed);
+
+#endif//PALETTE_H
@@ -0,0 +1,318 @@
+#include "planar.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+inline int min(int a, int b)
+{
+    return (a < b) ? a : b;
+}
+
+// bytes of p (p[0] as row 0); missing rows are 0
+template<typename T>
+inline uint64_t load_rows(const T* p, int count, int shift)
+{
+    uint64_t x = 0;
+    for(int i = 0; i < 8; ++i)
+    {
+        x = (x << 8) | ((i < count) ? ((p[i] >> shift) & 0xff) : 0);
+    }
+    return x;
+}
+
+// plane k is row (7 - k) of the transposed matrix, that is byte k
+inline void store_planes(uint64_t t, int first, int count, unsigned char* planes, int planeStride, int column)
+{
+    for(int k = 0; k < count; ++k)
+    {
+        planes[(first + k) * planeStride + column] = static_cast<unsigned char>(t >> (k * 8));
+    }
+}
+
+inline uint64_t load_planes(const unsigned char* planes, int planeStride, int first, int count, int column)
+{
+    uint64_t x = 0;
+    for(int k = 0; k < count; ++k)
+    {
+        x |= static_cast<uint64_t>(planes[(first + k) * planeStride + column]) << (k * 8);
+    }
+    return x;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+// movemask collects bit 7 of every byte; adding a vector to itself shifts every byte by 1 bit.
+// bytes are reversed first, so that pixel 0 becomes the most significant bit of the mask.
+// back to pixels, every byte picks its bit of the broadcast plane bytes with a compare
+#if defined(__AVX2__)
+
+typedef __m256i pixel_vector;
+
+const int VectorPixels = 32;
+
+inline void store_plane_bits(__m256i v, int first, int count, unsigned char* planes, int planeStride, int column)
+{
+    const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    v = _mm256_shuffle_epi8(v, reverse);
+    v = _mm256_permute2x128_si256(v, v, 1);
+    for(int k = 7; k >= 0; --k)
+    {
+        if(k < count)
+        {
+            const unsigned int m = static_cast<unsigned int>(_mm256_movemask_epi8(v));
+            unsigned char* plane = planes + column + (first + k) * planeStride;
+            plane[0] = static_cast<unsigned char>(m >> 24);
+            plane[1] = static_cast<unsigned char>(m >> 16);
+            plane[2] = static_cast<unsigned char>(m >> 8);
+            plane[3] = static_cast<unsigned char>(m);
+        }
+        v = _mm256_add_epi8(v, v);
+    }
+}
+
+inline __m256i load_plane_bits(const unsigned char* planes, int planeStride, int first, int count, int column)
+{
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i select = _mm256_set1_epi64x(0x0102040810204080LL);
+    __m256i       v      = _mm256_setzero_si256();
+    for(int k = 0; k < count; ++k)
+    {
+        const unsigned char* plane = planes + column + (first + k) * planeStride;
+        const int m = plane[0] | (plane[1] << 8) | (plane[2] << 16) | (plane[3] << 24);
+        __m256i bits = _mm256_shuffle_epi8(_mm256_set1_epi32(m), spread);
+        bits = _mm256_cmpeq_epi8(_mm256_and_si256(bits, select), select);
+        v = _mm256_or_si256(v, _mm256_and_si256(bits, _mm256_set1_epi8(static_cast<char>(1 << k))));
+    }
+    return v;
+}
+
+inline void load_bytes(const unsigned char* pixels, __m256i& lo, __m256i& hi)
+{
+    lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+    hi = _mm256_setzero_si256();
+}
+
+// the packs interleave the 128 bit lanes of their arguments
+inline void load_bytes(const unsigned short* pixels, __m256i& lo, __m256i& hi)
+{
+    const __m256i a    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+    const __m256i b    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + 16));
+    const __m256i byte = _mm256_set1_epi16(0xff);
+    lo = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a, byte), _mm256_and_si256(b, byte)), 0xd8);
+    hi = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 0xd8);
+}
+
+inline void store_bytes(__m256i lo, __m256i, unsigned char* pixels)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), lo);
+}
+
+inline void store_bytes(__m256i lo, __m256i hi, unsigned short* pixels)
+{
+    const __m256i a = _mm256_unpacklo_epi8(lo, hi);
+    const __m256i b = _mm256_unpackhi_epi8(lo, hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels),      _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + 16), _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+#else
+
+typedef __m128i pixel_vector;
+
+const int VectorPixels = 16;
+
+inline void store_plane_bits(__m128i v, int first, int count, unsigned char* planes, int planeStride, int column)
+{
+    v = _mm_shuffle_epi32(v, 0x1b);
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1);
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    for(int k = 7; k >= 0; --k)
+    {
+        if(k < count)
+        {
+            const unsigned int m = static_cast<unsigned int>(_mm_movemask_epi8(v));
+            unsigned char* plane = planes + column + (first + k) * planeStride;
+            plane[0] = static_cast<unsigned char>(m >> 8);
+            plane[1] = static_cast<unsigned char>(m);
+        }
+        v = _mm_add_epi8(v, v);
+    }
+}
+
+inline __m128i load_plane_bits(const unsigned char* planes, int planeStride, int first, int count, int column)
+{
+    const __m128i select = _mm_set1_epi64x(0x0102040810204080LL);
+    __m128i       v      = _mm_setzero_si128();
+    for(int k = 0; k < count; ++k)
+    {
+        const unsigned char* plane = planes + column + (first + k) * planeStride;
+        __m128i bits = _mm_cvtsi32_si128(plane[0] | (plane[1] << 8));
+        bits = _mm_unpacklo_epi8(bits, bits);
+        bits = _mm_unpacklo_epi16(bits, bits);
+        bits = _mm_unpacklo_epi32(bits, bits);
+        bits = _mm_cmpeq_epi8(_mm_and_si128(bits, select), select);
+        v = _mm_or_si128(v, _mm_and_si128(bits, _mm_set1_epi8(static_cast<char>(1 << k))));
+    }
+    return v;
+}
+
+inline void load_bytes(const unsigned char* pixels, __m128i& lo, __m128i& hi)
+{
+    lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    hi = _mm_setzero_si128();
+}
+
+inline void load_bytes(const unsigned short* pixels, __m128i& lo, __m128i& hi)
+{
+    const __m128i a    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    const __m128i b    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 8));
+    const __m128i byte = _mm_set1_epi16(0xff);
+    lo = _mm_packus_epi16(_mm_and_si128(a, byte), _mm_and_si128(b, byte));
+    hi = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+}
+
+inline void store_bytes(__m128i lo, __m128i, unsigned char* pixels)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), lo);
+}
+
+inline void store_bytes(__m128i lo, __m128i hi, unsigned short* pixels)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels),     _mm_unpacklo_epi8(lo, hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 8), _mm_unpackhi_epi8(lo, hi));
+}
+
+#endif
+
+// the pixels the vectors convert; the rest is left to the 8x8 transposes
+template<typename T>
+int to_planar_vector(const T* pixels, int n, int bpp, unsigned char* planes, int planeStride)
+{
+    int i = 0;
+    for(; i + VectorPixels <= n; i += VectorPixels)
+    {
+        pixel_vector lo, hi;
+        load_bytes(pixels + i, lo, hi);
+        store_plane_bits(lo, 0, min(bpp, 8), planes, planeStride, i / 8);
+        if(1 < sizeof(T) && 8 < bpp)
+        {
+            store_plane_bits(hi, 8, bpp - 8, planes, planeStride, i / 8);
+        }
+    }
+    return i;
+}
+
+template<typename T>
+int to_chunky_vector(const unsigned char* planes, int planeStride, int n, int bpp, T* pixels)
+{
+    int i = 0;
+    for(; i + VectorPixels <= n; i += VectorPixels)
+    {
+        const pixel_vector lo = load_plane_bits(planes, planeStride, 0, min(bpp, 8), i / 8);
+        const pixel_vector hi = load_plane_bits(planes, planeStride, 8, bpp - 8, i / 8); // none for bpp <= 8
+        store_bytes(lo, hi, pixels + i);
+    }
+    return i;
+}
+
+#else
+
+template<typename T>
+int to_planar_vector(const T*, int, int, unsigned char*, int)
+{
+    return 0;
+}
+
+template<typename T>
+int to_chunky_vector(const unsigned char*, int, int, int, T*)
+{
+    return 0;
+}
+
+#endif
+
+template<typename T>
+void to_planar(const T* pixels, int n, int bpp, unsigned char* planes, int planeStride)
+{
+    for(int i = to_planar_vector(pixels, n, bpp, planes, planeStride); i < n; i += 8)
+    {
+        const int count = min(8, n - i);
+        store_planes(transpose8x8(load_rows(pixels + i, count, 0)), 0, min(bpp, 8), planes, planeStride, i / 8);
+        if(8 < bpp)
+        {
+            store_planes(transpose8x8(load_rows(pixels + i, count, 8)), 8, bpp - 8, planes, planeStride, i / 8);
+        }
+    }
+}
+
+template<typename T>
+void to_chunky(const unsigned char* planes, int planeStride, int n, int bpp, T* pixels)
+{
+    for(int i = to_chunky_vector(planes, planeStride, n, bpp, pixels); i < n; i += 8)
+    {
+        const int      count = min(8, n - i);
+        const uint64_t lo    = transpose8x8(load_planes(planes, planeStride, 0, min(bpp, 8), i / 8));
+        const uint64_t hi    = (8 < bpp) ? transpose8x8(load_planes(planes, planeStride, 8, bpp - 8, i / 8)) : 0;
+        for(int j = 0; j < count; ++j)
+        {
+            const int shift = (7 - j) * 8;
+            pixels[i + j] = static_cast<T>((((hi >> shift) & 0xff) << 8) | ((lo >> shift) & 0xff));
+        }
+    }
+}
+
+} // namespace
+
+uint64_t transpose8x8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >>  7)) & 0x00aa00aa00aa00aaULL; x ^= t ^ (t <<  7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL; x ^= t ^ (t << 28);
+    return x;
+}
+
+void transpose64x64(uint64_t* rows)
+{
+    // swap the upper right and the lower left blocks of size j, for j = 32, 16, ..., 1
+    uint64_t mask = 0x00000000ffffffffULL;
+    for(int j = 32; j != 0; j >>= 1, mask ^= (mask << j))
+    {
+        for(int k = 0; k < 64; k = ((k | j) + 1) & ~j)
+        {
+            const uint64_t t = (rows[k] ^ (rows[k | j] >> j)) & mask;
+            rows[k]     ^= t;
+            rows[k | j] ^= t << j;
+        }
+    }
+}
+
+void chunky8_to_planar(const unsigned char* pixels, int n, int bpp, unsigned char* planes, int planeStride)
+{
+    to_planar(pixels, n, bpp, planes, planeStride);
+}
+
+void planar_to_chunky8(const unsigned char* planes, int planeStride, int n, int bpp, unsigned char* pixels)
+{
+    to_chunky(planes, planeStride, n, bpp, pixels);
+}
+
+void chunky16_to_planar(const unsigned short* pixels, int n, int bpp, unsigned char* planes, int planeStride)
+{
+    to_planar(pixels, n, bpp, planes, planeStride);
+}
+
+void planar_to_chunky16(const unsigned char* planes, int planeStride, int n, int bpp, unsigned short* pixels)
+{
+    to_chunky(planes, planeStride, n, bpp, pixels);
+}
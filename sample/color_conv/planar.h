@@ -0,0 +1,26 @@
+#ifndef PLANAR_H
+#define PLANAR_H
+
+#include <stdint.h>
+
+// bit matrices are stored row by row from the most significant bits;
+// the most significant bit of a row is column 0
+
+// 8x8 bits; row i is byte (7 - i) of x
+uint64_t transpose8x8(uint64_t x);
+
+// 64x64 bits in place; row i is rows[i]
+void transpose64x64(uint64_t* rows);
+
+// planes[k * planeStride ...] holds bit k of every pixel, 8 pixels per byte from the most significant bit
+// (the layout of (p0, p1, p2, p3, p4, p5, p6, p7) = byte with Bits<1>); planeStride >= (n + 7) / 8
+
+// 1..8 bits per pixel
+void chunky8_to_planar(const unsigned char* pixels, int n, int bpp, unsigned char* planes, int planeStride);
+void planar_to_chunky8(const unsigned char* planes, int planeStride, int n, int bpp, unsigned char* pixels);
+
+// 1..16 bits per pixel (e.g. bpp = 16 for RGB565 as rgb888to565 produces)
+void chunky16_to_planar(const unsigned short* pixels, int n, int bpp, unsigned char* planes, int planeStride);
+void planar_to_chunky16(const unsigned char* planes, int planeStride, int n, int bpp, unsigned short* pixels);
+
+#endif//PLANAR_H
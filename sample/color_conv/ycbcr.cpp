@@ -0,0 +1,383 @@
+#include "ycbcr.h"
+#include "color_conv.h"
+#include "Bits.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// YCbCr to RGB in 6 bit fixed point; every intermediate value fits in 16 bit lanes
+//   R = Y' + V * rv, G = Y' - U * gu - V * gv, B = Y' + U * bu  (Y' = (Y - 16) * y, U = Cb - 128, V = Cr - 128)
+struct ToRgb
+{
+    short y;
+    short rv;
+    short gu;
+    short gv;
+    short bu;
+};
+
+const ToRgb ToRgbCoefficients[] =
+{
+    { 75, 102, 25, 52, 129 }, // BT.601: 1.164, 1.596, 0.391, 0.813, 2.018
+    { 75, 115, 14, 34, 135 }  // BT.709: 1.164, 1.793, 0.213, 0.533, 2.112
+};
+
+// RGB to YCbCr in 8 bit fixed point
+struct ToYCbCr
+{
+    int yr, yg, yb;
+    int ur, ug, ub;
+    int vr, vg, vb;
+};
+
+const ToYCbCr ToYCbCrCoefficients[] =
+{
+    { 66, 129, 25, -38, -74, 112, 112, -94, -18 }, // BT.601
+    { 47, 157, 16, -26, -87, 112, 112, -102, -10 }  // BT.709
+};
+
+inline int clamp255(int n)
+{
+    return (n < 0) ? 0 : ((255 < n) ? 255 : n);
+}
+
+inline unsigned int pack888(int r, int g, int b)
+{
+    const Bits<8> r8(clamp255(r));
+    const Bits<8> g8(clamp255(g));
+    const Bits<8> b8(clamp255(b));
+    return (r8, g8, b8);
+}
+
+struct Rgb565
+{
+    typedef unsigned short pixel_type;
+
+    static pixel_type pack(int r, int g, int b)
+    {
+        return static_cast<pixel_type>(pack_rgb565(pack888(r, g, b)));
+    }
+
+    static void unpack(pixel_type rgb, int& r, int& g, int& b)
+    {
+        // same layout as rgb565to888
+        Bits<5> r5;
+        Bits<6> g6;
+        Bits<5> b5;
+        (r5, g6, b5) = static_cast<unsigned int>(rgb);
+        r = static_cast<unsigned int>((r5, reserve<3>));
+        g = static_cast<unsigned int>((g6, reserve<2>));
+        b = static_cast<unsigned int>((b5, reserve<3>));
+    }
+
+#ifdef __SSE2__
+    // r, g, b are 8 lanes of 0..255
+    static void store8(pixel_type* dst, __m128i r, __m128i g, __m128i b)
+    {
+        const __m128i r5 = _mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xf8)), 8);
+        const __m128i g6 = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xfc)), 3);
+        const __m128i b5 = _mm_srli_epi16(b, 3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_or_si128(r5, g6), b5));
+    }
+
+    // 8 pixels to 8 lanes of r, g, b the same as unpack
+    static void load8(const pixel_type* src, __m128i& r, __m128i& g, __m128i& b)
+    {
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        r = _mm_slli_epi16(_mm_srli_epi16(p, 11), 3);
+        g = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3f)), 2);
+        b = _mm_slli_epi16(_mm_and_si128(p, _mm_set1_epi16(0x1f)), 3);
+    }
+#endif
+};
+
+struct Rgb888
+{
+    typedef unsigned int pixel_type;
+
+    static pixel_type pack(int r, int g, int b)
+    {
+        return pack888(r, g, b);
+    }
+
+    static void unpack(pixel_type rgb, int& r, int& g, int& b)
+    {
+        Bits<8> r8;
+        Bits<8> g8;
+        Bits<8> b8;
+        (r8, g8, b8) = rgb;
+        r = r8;
+        g = g8;
+        b = b8;
+    }
+
+#ifdef __SSE2__
+    static void store8(pixel_type* dst, __m128i r, __m128i g, __m128i b)
+    {
+        const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),     _mm_unpacklo_epi16(gb, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(gb, r));
+    }
+
+    static void load8(const pixel_type* src, __m128i& r, __m128i& g, __m128i& b)
+    {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        const __m128i lo   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i hi   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+        r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask), _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+        g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask), _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+        b = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+    }
+#endif
+};
+
+// chroma of pixel x is cb[(x / 2) * step], cr[(x / 2) * step]; step is 1 for planar and 2 for interleaved
+template<typename Out>
+void convert_row(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, int step, int width, const ToRgb& k, typename Out::pixel_type* dst)
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i max   = _mm_set1_epi16(255);
+    const __m128i half  = _mm_set1_epi16(32);
+    const __m128i y16   = _mm_set1_epi16(16);
+    const __m128i c128  = _mm_set1_epi16(128);
+    const __m128i ky    = _mm_set1_epi16(k.y);
+    const __m128i krv   = _mm_set1_epi16(k.rv);
+    const __m128i kgu   = _mm_set1_epi16(k.gu);
+    const __m128i kgv   = _mm_set1_epi16(k.gv);
+    const __m128i kbu   = _mm_set1_epi16(k.bu);
+
+    for(; x + 8 <= width; x += 8)
+    {
+        __m128i u;
+        __m128i v;
+        if(step == 1)
+        {
+            int cb4;
+            int cr4;
+            std::memcpy(&cb4, cb + x / 2, sizeof(cb4));
+            std::memcpy(&cr4, cr + x / 2, sizeof(cr4));
+            u = _mm_unpacklo_epi8(_mm_cvtsi32_si128(cb4), zero);
+            v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(cr4), zero);
+        }
+        else
+        {
+            const __m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + x)), zero);
+            u = _mm_shufflelo_epi16(_mm_shufflehi_epi16(uv, 0x08), 0x08); // 0, 2 of each half
+            v = _mm_shufflelo_epi16(_mm_shufflehi_epi16(uv, 0x0d), 0x0d); // 1, 3 of each half
+            u = _mm_unpacklo_epi32(u, _mm_unpackhi_epi64(u, u));
+            v = _mm_unpacklo_epi32(v, _mm_unpackhi_epi64(v, v));
+        }
+        u = _mm_sub_epi16(_mm_unpacklo_epi16(u, u), c128);
+        v = _mm_sub_epi16(_mm_unpacklo_epi16(v, v), c128);
+
+        const __m128i yy = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), y16), ky), half);
+
+        const __m128i r = _mm_adds_epi16(yy, _mm_mullo_epi16(v, krv));
+        const __m128i g = _mm_subs_epi16(_mm_subs_epi16(yy, _mm_mullo_epi16(u, kgu)), _mm_mullo_epi16(v, kgv));
+        const __m128i b = _mm_adds_epi16(yy, _mm_mullo_epi16(u, kbu));
+
+        Out::store8(dst + x,
+                    _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(r, 6), zero), max),
+                    _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(g, 6), zero), max),
+                    _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(b, 6), zero), max));
+    }
+#endif
+
+    // same arithmetic as above; saturation in 16 bits never changes the clamped result
+    for(; x < width; ++x)
+    {
+        const int yy = (y[x] - 16) * k.y + 32;
+        const int u  = cb[(x / 2) * step] - 128;
+        const int v  = cr[(x / 2) * step] - 128;
+        dst[x] = Out::pack((yy + v * k.rv) >> 6, (yy - u * k.gu - v * k.gv) >> 6, (yy + u * k.bu) >> 6);
+    }
+}
+
+// chromaShift is 1 when chroma rows are shared by 2 rows (4:2:0)
+template<typename Out>
+void convert(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int step, int cStride, int chromaShift,
+             int width, int height, typename Out::pixel_type* dst, int dstStride, YCbCrMatrix matrix)
+{
+    const ToRgb& k = ToRgbCoefficients[matrix];
+    for(int row = 0; row < height; ++row)
+    {
+        const int c = (row >> chromaShift) * cStride;
+        convert_row<Out>(y + row * yStride, cb + c, cr + c, step, width, k, dst + row * dstStride);
+    }
+}
+
+#ifdef __SSE2__
+// Y of 8 lanes of r, g, b as 8 bytes; every product and sum is below 0x10000, so 16 bit lanes wrap to the exact value
+inline __m128i luma8(__m128i r, __m128i g, __m128i b, const ToYCbCr& k)
+{
+    const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(k.yr)), _mm_mullo_epi16(g, _mm_set1_epi16(k.yg))),
+                                      _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(k.yb)), _mm_set1_epi16(128)));
+    return _mm_packus_epi16(_mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16)), _mm_setzero_si128());
+}
+
+// Cb or Cr of the even lanes as 4 bytes; with the offset the sum is in 0..0xffff as for luma8
+inline __m128i chroma4(__m128i r, __m128i g, __m128i b, int kr, int kg, int kb)
+{
+    const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(static_cast<short>(kr))), _mm_mullo_epi16(g, _mm_set1_epi16(static_cast<short>(kg)))),
+                                      _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(static_cast<short>(kb))), _mm_set1_epi16(static_cast<short>(128 + (128 << 8)))));
+    const __m128i c   = _mm_and_si128(_mm_srli_epi16(sum, 8), _mm_set1_epi32(0xffff));
+    return _mm_packus_epi16(_mm_packs_epi32(c, c), _mm_setzero_si128());
+}
+
+// rounded average of the 2x2 blocks of 2 rows of 8 lanes, in the even lanes
+inline __m128i average2x2(__m128i row0, __m128i row1)
+{
+    const __m128i sum = _mm_add_epi16(row0, row1);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sum, _mm_srli_epi32(sum, 16)), _mm_set1_epi16(2)), 2);
+}
+#endif
+
+// 2 rows of RGB to 2 rows of Y and 1 row of Cb, Cr; chroma of column x / 2 is cb[(x / 2) * step], cr[(x / 2) * step]
+template<typename In>
+void convert_to_420(const typename In::pixel_type* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cb, unsigned char* cr, int step, int cStride, YCbCrMatrix matrix)
+{
+    const ToYCbCr& k = ToYCbCrCoefficients[matrix];
+    for(int row = 0; row < height; row += 2)
+    {
+        const int rows = (row + 1 < height) ? 2 : 1;
+        int       x    = 0;
+
+#ifdef __SSE2__
+        // full 2x2 blocks, 8 columns at a time
+        for(; (rows == 2) && (x + 8 <= width); x += 8)
+        {
+            __m128i r0;
+            __m128i g0;
+            __m128i b0;
+            __m128i r1;
+            __m128i g1;
+            __m128i b1;
+            In::load8(src + row * srcStride + x, r0, g0, b0);
+            In::load8(src + (row + 1) * srcStride + x, r1, g1, b1);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y + row * yStride + x), luma8(r0, g0, b0, k));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y + (row + 1) * yStride + x), luma8(r1, g1, b1, k));
+
+            const __m128i r = average2x2(r0, r1);
+            const __m128i g = average2x2(g0, g1);
+            const __m128i b = average2x2(b0, b1);
+            const __m128i u = chroma4(r, g, b, k.ur, k.ug, k.ub);
+            const __m128i v = chroma4(r, g, b, k.vr, k.vg, k.vb);
+            unsigned char* const c = cb + (row / 2) * cStride + (x / 2) * step;
+            if(step == 1)
+            {
+                const int u4 = _mm_cvtsi128_si32(u);
+                const int v4 = _mm_cvtsi128_si32(v);
+                std::memcpy(c, &u4, sizeof(u4));
+                std::memcpy(cr + (row / 2) * cStride + x / 2, &v4, sizeof(v4));
+            }
+            else
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(c), _mm_unpacklo_epi8(u, v));
+            }
+        }
+#endif
+
+        for(; x < width; x += 2)
+        {
+            const int columns = (x + 1 < width) ? 2 : 1;
+
+            int sum[3] = {};
+            for(int j = 0; j < rows; ++j)
+            {
+                for(int i = 0; i < columns; ++i)
+                {
+                    int r;
+                    int g;
+                    int b;
+                    In::unpack(src[(row + j) * srcStride + x + i], r, g, b);
+                    y[(row + j) * yStride + x + i] = static_cast<unsigned char>(((k.yr * r + k.yg * g + k.yb * b + 128) >> 8) + 16);
+                    sum[0] += r;
+                    sum[1] += g;
+                    sum[2] += b;
+                }
+            }
+
+            const int n = rows * columns;
+            const int r = (sum[0] + n / 2) / n;
+            const int g = (sum[1] + n / 2) / n;
+            const int b = (sum[2] + n / 2) / n;
+            // the offset 128 << 8 keeps the shifted value positive
+            cb[(row / 2) * cStride + (x / 2) * step] = static_cast<unsigned char>((k.ur * r + k.ug * g + k.ub * b + 128 + (128 << 8)) >> 8);
+            cr[(row / 2) * cStride + (x / 2) * step] = static_cast<unsigned char>((k.vr * r + k.vg * g + k.vb * b + 128 + (128 << 8)) >> 8);
+        }
+    }
+}
+
+} // namespace
+
+void i420_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb565>(y, yStride, cb, cr, 1, cStride, 1, width, height, dst, dstStride, matrix);
+}
+
+void i420_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb888>(y, yStride, cb, cr, 1, cStride, 1, width, height, dst, dstStride, matrix);
+}
+
+void i422_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb565>(y, yStride, cb, cr, 1, cStride, 0, width, height, dst, dstStride, matrix);
+}
+
+void i422_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb888>(y, yStride, cb, cr, 1, cStride, 0, width, height, dst, dstStride, matrix);
+}
+
+void nv12_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cbcr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb565>(y, yStride, cbcr, cbcr + 1, 2, cStride, 1, width, height, dst, dstStride, matrix);
+}
+
+void nv12_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cbcr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix)
+{
+    convert<Rgb888>(y, yStride, cbcr, cbcr + 1, 2, cStride, 1, width, height, dst, dstStride, matrix);
+}
+
+void rgb565_to_i420(const unsigned short* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cb, unsigned char* cr, int cStride, YCbCrMatrix matrix)
+{
+    convert_to_420<Rgb565>(src, srcStride, width, height, y, yStride, cb, cr, 1, cStride, matrix);
+}
+
+void rgb888_to_i420(const unsigned int* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cb, unsigned char* cr, int cStride, YCbCrMatrix matrix)
+{
+    convert_to_420<Rgb888>(src, srcStride, width, height, y, yStride, cb, cr, 1, cStride, matrix);
+}
+
+void rgb565_to_nv12(const unsigned short* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cbcr, int cStride, YCbCrMatrix matrix)
+{
+    convert_to_420<Rgb565>(src, srcStride, width, height, y, yStride, cbcr, cbcr + 1, 2, cStride, matrix);
+}
+
+void rgb888_to_nv12(const unsigned int* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cbcr, int cStride, YCbCrMatrix matrix)
+{
+    convert_to_420<Rgb888>(src, srcStride, width, height, y, yStride, cbcr, cbcr + 1, 2, cStride, matrix);
+}
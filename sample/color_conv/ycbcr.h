@@ -0,0 +1,44 @@
+#ifndef YCBCR_H
+#define YCBCR_H
+
+// video range YCbCr (Y: 16..235, Cb/Cr: 16..240)
+enum YCbCrMatrix
+{
+    YCBCR_BT601,
+    YCBCR_BT709
+};
+
+// strides are counted in elements (bytes for the planes, pixels for the RGB images)
+// chroma is shared by 2 pixels horizontally (4:2:2) and also by 2 rows (4:2:0); it is upsampled by replication
+
+// planar 4:2:0 (I420)
+void i420_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix);
+void i420_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix);
+
+// planar 4:2:2 (I422)
+void i422_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix);
+void i422_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cb, const unsigned char* cr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix);
+
+// semi-planar 4:2:0 (NV12; interleaved Cb, Cr)
+void nv12_to_rgb565(const unsigned char* y, int yStride, const unsigned char* cbcr, int cStride,
+                    int width, int height, unsigned short* dst, int dstStride, YCbCrMatrix matrix);
+void nv12_to_rgb888(const unsigned char* y, int yStride, const unsigned char* cbcr, int cStride,
+                    int width, int height, unsigned int* dst, int dstStride, YCbCrMatrix matrix);
+
+// RGB to planar 4:2:0; chroma is the average of 2x2 pixels
+void rgb565_to_i420(const unsigned short* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cb, unsigned char* cr, int cStride, YCbCrMatrix matrix);
+void rgb888_to_i420(const unsigned int* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cb, unsigned char* cr, int cStride, YCbCrMatrix matrix);
+
+// RGB to semi-planar 4:2:0 (NV12); same samples as the I420 conversions
+void rgb565_to_nv12(const unsigned short* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cbcr, int cStride, YCbCrMatrix matrix);
+void rgb888_to_nv12(const unsigned int* src, int srcStride, int width, int height,
+                    unsigned char* y, int yStride, unsigned char* cbcr, int cStride, YCbCrMatrix matrix);
+
+#endif//YCBCR_H
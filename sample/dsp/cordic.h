@@ -0,0 +1,301 @@
+#ifndef CORDIC_H
+#define CORDIC_H
+
+#include "Bits.h"
+#include "Fixed.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// CORDIC of N bit precision, which models the NCOs of a hardware datapath bit for bit:
+//   angles are binary angles, Bits<N, signed> in which 2^(N - 1) is pi, so that a phase accumulator wraps as Bits does
+//   values are Q1.(N - 1) Bits<N, signed>; results are rounded as Fixed rounds, and saturate
+//   x, y and z run in Bits<N + GUARD + 2, signed>: GUARD fraction bits against the truncation of the shifts,
+//   and two integer bits for the gain, for N + GUARD - 1 iterations
+// N + GUARD is at most 30, so that a batch runs in 32 bit lanes
+
+// atan(2^-I) * 2^60 for I >= 1, as the series 2^-I - 2^-3I / 3 + 2^-5I / 5 - ...
+template<int I, int K = 0, bool MORE = (I * (2 * K + 1) <= 60)>
+struct CordicSeries
+{
+    static const long value = ((K % 2 == 0) ? 1 : -1) * ((1L << (60 - I * (2 * K + 1))) / (2 * K + 1)) + CordicSeries<I, K + 1>::value;
+};
+
+template<int I, int K>
+struct CordicSeries<I, K, false>
+{
+    static const long value = 0;
+};
+
+// the angle table: atan(2^-I) as a binary angle of N bits, rounded. the series is multiplied by 2^62 / pi
+// in halves of 30 and 31 bits to stay in long; the bits dropped are far below those rounded off
+template<int N, int I>
+struct CordicAngle
+{
+    static const long a       = CordicSeries<I>::value;
+    static const long q       = 1467945251641000613L;
+    static const long a1      = a >> 30;
+    static const long a0      = a & ((1L << 30) - 1);
+    static const long q1      = q >> 31;
+    static const long q0      = q & ((1L << 31) - 1);
+    static const long product = a1 * q1 + ((((a1 * q0) >> 1) + a0 * q1 + ((a0 * q0) >> 31)) >> 30);
+    static const int  value   = static_cast<int>((product + (1L << (61 - N))) >> (62 - N));
+};
+
+template<int N>
+struct CordicAngle<N, 0>
+{
+    static const int value = 1 << (N - 3);
+};
+
+// the direction of each step: down rotates clockwise, by -atan(2^-I)
+struct CordicRotation
+{
+    template<typename D>
+    static bool down(const D&, const D& z)
+    {
+        return z.get() < 0;
+    }
+
+#ifdef __AVX2__
+    static __m256i down(__m256i, __m256i z)
+    {
+        return _mm256_srai_epi32(z, 31);
+    }
+#endif
+};
+
+struct CordicVectoring
+{
+    template<typename D>
+    static bool down(const D& y, const D&)
+    {
+        return 0 <= y.get();
+    }
+
+#ifdef __AVX2__
+    static __m256i down(__m256i y, __m256i)
+    {
+        return _mm256_xor_si256(_mm256_srai_epi32(y, 31), _mm256_set1_epi32(-1));
+    }
+#endif
+};
+
+// the iterations, unrolled with the angles as constants
+template<int N, typename MODE, int I = 0, bool MORE = (I < N - 1)>
+struct CordicSteps
+{
+    template<typename D>
+    static void run(D& x, D& y, D& z)
+    {
+        const D dx(y >> I);
+        const D dy(x >> I);
+        if(MODE::down(y, z))
+        {
+            x += dx.get();
+            y -= dy.get();
+            z += CordicAngle<N, I>::value;
+        }
+        else
+        {
+            x -= dx.get();
+            y += dy.get();
+            z -= CordicAngle<N, I>::value;
+        }
+        CordicSteps<N, MODE, I + 1>::run(x, y, z);
+    }
+
+#ifdef __AVX2__
+    // the same step in every lane; (v ^ m) - m negates v in the lanes where m is -1
+    static void run(__m256i& x, __m256i& y, __m256i& z)
+    {
+        const __m256i m  = MODE::down(y, z);
+        const __m256i dx = _mm256_sub_epi32(_mm256_xor_si256(_mm256_srai_epi32(y, I), m), m);
+        const __m256i dy = _mm256_sub_epi32(_mm256_xor_si256(_mm256_srai_epi32(x, I), m), m);
+        const __m256i dz = _mm256_sub_epi32(_mm256_xor_si256(_mm256_set1_epi32(CordicAngle<N, I>::value), m), m);
+        x = _mm256_sub_epi32(x, dx);
+        y = _mm256_add_epi32(y, dy);
+        z = _mm256_sub_epi32(z, dz);
+        CordicSteps<N, MODE, I + 1>::run(x, y, z);
+    }
+#endif
+};
+
+template<int N, typename MODE, int I>
+struct CordicSteps<N, MODE, I, false>
+{
+    template<typename D>
+    static void run(D&, D&, D&)
+    {
+    }
+};
+
+template<int N, int GUARD = ((N <= 26) ? 4 : 30 - N)>
+class Cordic
+{
+public:
+    typedef emattsan::bits::Bits<N, signed>                                 angle_type;
+    typedef emattsan::bits::Bits<N, signed>                                 value_type;
+    typedef emattsan::bits::Bits<N + GUARD + 2, signed>                     datapath_type;
+    typedef emattsan::bits::Bits<N, emattsan::bits::Saturate<signed> >      saturated_type;
+
+    static const int Width = (N + GUARD) *
+        emattsan::bits::detail::ERROR__INVALID_Bits_SIZE__ONLY_CAN_USE_FROM_ONE_TO_CONTAINER_DIGIT_SIZE<(4 <= N) && (0 <= GUARD) && (N + GUARD <= 30)>::value;
+    static const int Iterations = Width - 1;
+
+    static const int Half    = 1 << (N - 1);
+    static const int Quarter = 1 << (N - 2);
+
+    // 2^(Width - 1) / gain, the start of a rotation, and 2^32 / gain, the correction of a magnitude
+    static const int           Start       = static_cast<int>((2800459870029452954L + (1L << (62 - Width))) >> (63 - Width));
+    static const unsigned long InverseGain = (2800459870029452954UL + (1UL << 29)) >> 30;
+
+    static void sincos(const angle_type& angle, value_type& sin, value_type& cos)
+    {
+        // beyond +-pi/2, the vector starts from -x and rotates by angle - pi
+        const bool    flip = (angle.get() < -Quarter) || (Quarter < angle.get());
+        datapath_type x(flip ? -Start : Start);
+        datapath_type y(0);
+        datapath_type z(angle_type(angle.get() + (flip ? Half : 0)).get() * (1 << GUARD));
+        CordicSteps<Width, CordicRotation>::run(x, y, z);
+        sin = value_type(saturated_type(round(y.get())).get());
+        cos = value_type(saturated_type(round(x.get())).get());
+    }
+
+    static void polar(const value_type& x0, const value_type& y0, value_type& magnitude, angle_type& angle)
+    {
+        // with x < 0, the vector starts negated, from the angle pi
+        const bool    flip = x0.get() < 0;
+        datapath_type x((flip ? -x0.get() : x0.get()) * (1 << GUARD));
+        datapath_type y((flip ? -y0.get() : y0.get()) * (1 << GUARD));
+        datapath_type z(flip ? (Half << GUARD) : 0);
+        CordicSteps<Width, CordicVectoring>::run(x, y, z);
+        magnitude = value_type(saturated_type(emattsan::bits::detail::FixedRound<32 + GUARD>::apply(static_cast<long>(x.get()) * static_cast<long>(InverseGain))).get());
+        angle     = angle_type(round(z.get()));
+    }
+
+    static angle_type atan2(const value_type& y, const value_type& x)
+    {
+        value_type magnitude;
+        angle_type angle;
+        polar(x, y, magnitude, angle);
+        return angle;
+    }
+
+    static value_type magnitude(const value_type& x, const value_type& y)
+    {
+        value_type magnitude;
+        angle_type angle;
+        polar(x, y, magnitude, angle);
+        return magnitude;
+    }
+
+    // batches of independent rotations on raw values in int, 8 lanes per step with AVX2
+    static void sincos(const int* angle, int count, int* sin, int* cos)
+    {
+        int i = 0;
+#ifdef __AVX2__
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i a    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(angle + i));
+            const __m256i flip = _mm256_or_si256(_mm256_cmpgt_epi32(a, _mm256_set1_epi32(Quarter)), _mm256_cmpgt_epi32(_mm256_set1_epi32(-Quarter), a));
+            __m256i       x    = _mm256_sub_epi32(_mm256_xor_si256(_mm256_set1_epi32(Start), flip), flip);
+            __m256i       y    = _mm256_setzero_si256();
+            __m256i       z    = _mm256_slli_epi32(wrap(_mm256_add_epi32(a, _mm256_and_si256(_mm256_set1_epi32(Half), flip))), GUARD);
+            CordicSteps<Width, CordicRotation>::run(x, y, z);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(sin + i), saturate(round(y)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(cos + i), saturate(round(x)));
+        }
+#endif
+        for(; i < count; ++i)
+        {
+            value_type s;
+            value_type c;
+            sincos(angle_type(angle[i]), s, c);
+            sin[i] = s.get();
+            cos[i] = c.get();
+        }
+    }
+
+    static void polar(const int* x0, const int* y0, int count, int* magnitude, int* angle)
+    {
+        int i = 0;
+#ifdef __AVX2__
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i u    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x0 + i));
+            const __m256i v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y0 + i));
+            const __m256i flip = _mm256_srai_epi32(u, 31);
+            __m256i       x    = _mm256_slli_epi32(_mm256_sub_epi32(_mm256_xor_si256(u, flip), flip), GUARD);
+            __m256i       y    = _mm256_slli_epi32(_mm256_sub_epi32(_mm256_xor_si256(v, flip), flip), GUARD);
+            __m256i       z    = _mm256_and_si256(_mm256_set1_epi32(Half << GUARD), flip);
+            CordicSteps<Width, CordicVectoring>::run(x, y, z);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(magnitude + i), correct(x));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(angle + i), wrap(round(z)));
+        }
+#endif
+        for(; i < count; ++i)
+        {
+            value_type m;
+            angle_type a;
+            polar(value_type(x0[i]), value_type(y0[i]), m, a);
+            magnitude[i] = m.get();
+            angle[i]     = a.get();
+        }
+    }
+
+private:
+    // the guard bits rounded off as FixedRound rounds
+    static int round(int n)
+    {
+        return emattsan::bits::detail::FixedRound<GUARD>::apply(n);
+    }
+
+#ifdef __AVX2__
+    static __m256i round(__m256i v)
+    {
+        if(GUARD == 0)
+        {
+            return v;
+        }
+        const __m256i odd = _mm256_and_si256(_mm256_srai_epi32(v, GUARD), _mm256_set1_epi32(1));
+        return _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(((1 << GUARD) >> 1) - 1)), odd), GUARD);
+    }
+
+    // to N bits, as angle_type wraps
+    static __m256i wrap(__m256i v)
+    {
+        return _mm256_srai_epi32(_mm256_slli_epi32(v, 32 - N), 32 - N);
+    }
+
+    static __m256i saturate(__m256i v)
+    {
+        return _mm256_max_epi32(_mm256_min_epi32(v, _mm256_set1_epi32(Half - 1)), _mm256_set1_epi32(-Half));
+    }
+
+    // x * InverseGain / 2^(32 + GUARD), rounded as FixedRound and saturated; x is not negative. the products
+    // of the even and the odd lanes are 64 bit; both are shifted right by GUARD and the odd ones keep their
+    // result in the high half
+    static __m256i correct(__m256i x)
+    {
+        const __m256i gain = _mm256_set1_epi32(static_cast<int>(InverseGain));
+        const __m256i half = _mm256_set1_epi64x((1L << (31 + GUARD)) - 1);
+        const __m256i one  = _mm256_set1_epi64x(1);
+        const __m256i even = _mm256_mul_epu32(x, gain);
+        const __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), gain);
+        const __m256i re   = _mm256_srli_epi64(_mm256_add_epi64(_mm256_add_epi64(even, half), _mm256_and_si256(_mm256_srli_epi64(even, 32 + GUARD), one)), 32 + GUARD);
+        const __m256i ro   = _mm256_slli_epi64(_mm256_srli_epi64(_mm256_add_epi64(_mm256_add_epi64(odd, half), _mm256_and_si256(_mm256_srli_epi64(odd, 32 + GUARD), one)), 32 + GUARD), 32);
+        return _mm256_min_epi32(_mm256_blend_epi32(re, ro, 0xaa), _mm256_set1_epi32(Half - 1));
+    }
+#endif
+};
+
+template<int N, int GUARD> const int           Cordic<N, GUARD>::Width;
+template<int N, int GUARD> const int           Cordic<N, GUARD>::Iterations;
+template<int N, int GUARD> const int           Cordic<N, GUARD>::Half;
+template<int N, int GUARD> const int           Cordic<N, GUARD>::Quarter;
+template<int N, int GUARD> const int           Cordic<N, GUARD>::Start;
+template<int N, int GUARD> const unsigned long Cordic<N, GUARD>::InverseGain;
+
+#endif//CORDIC_H
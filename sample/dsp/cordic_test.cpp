@@ -0,0 +1,181 @@
+// g++ -ansi -Wall -O3 -mavx2 -I../.. -o cordic_test cordic_test.cpp
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "cordic.h"
+
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+
+// the table of CordicAngle against atan
+template<int N, int I = 0, bool MORE = (I < N - 1)>
+struct CheckAngles
+{
+    static void run()
+    {
+        const double angle = std::atan(std::ldexp(1.0, -I)) / Pi * (1 << (N - 1));
+        assert((CordicAngle<N, I>::value == static_cast<int>(std::floor(angle + 0.5))));
+        CheckAngles<N, I + 1>::run();
+    }
+};
+
+template<int N, int I>
+struct CheckAngles<N, I, false>
+{
+    static void run()
+    {
+    }
+};
+
+// the distance of a from b in units of the last place; angles wrap
+int ulp(double a, double b, double wrap = 0)
+{
+    double d = std::fabs(a - b);
+    if((0 < wrap) && (wrap < d))
+    {
+        d = 2 * wrap - d;
+    }
+    return static_cast<int>(std::ceil(d - 0.5));
+}
+
+// every angle (step) through the batch against the scalar model, and against sin and cos
+template<int N>
+void check_sincos(int step, int tolerance)
+{
+    typedef Cordic<N> cordic;
+    const double scale = 1 << (N - 1);
+
+    std::vector<int> angle;
+    for(long a = -(1L << (N - 1)); a < (1L << (N - 1)); a += step)
+    {
+        angle.push_back(static_cast<int>(a));
+    }
+    const int        count = static_cast<int>(angle.size());
+    std::vector<int> sin(count);
+    std::vector<int> cos(count);
+    cordic::sincos(&angle[0], count, &sin[0], &cos[0]);
+
+    for(int i = 0; i < count; ++i)
+    {
+        typename cordic::value_type s;
+        typename cordic::value_type c;
+        cordic::sincos(typename cordic::angle_type(angle[i]), s, c);
+        assert(s.get() == sin[i]);
+        assert(c.get() == cos[i]);
+
+        const double t = angle[i] * Pi / scale;
+        assert(ulp(sin[i], std::min(std::sin(t) * scale, scale - 1)) <= tolerance);
+        assert(ulp(cos[i], std::min(std::cos(t) * scale, scale - 1)) <= tolerance);
+    }
+}
+
+// random vectors through the batch against the scalar model, and against hypot and atan2; the angle of
+// a short vector has few bits, so it is checked from a length of 1 / 16
+template<int N>
+void check_polar(int tolerance)
+{
+    typedef Cordic<N> cordic;
+    const double scale = 1 << (N - 1);
+    const int    count = 10003;
+
+    std::vector<int> x(count);
+    std::vector<int> y(count);
+    for(int i = 0; i < count; ++i)
+    {
+        x[i] = (std::rand() % (1 << N)) - (1 << (N - 1));
+        y[i] = (std::rand() % (1 << N)) - (1 << (N - 1));
+    }
+    x[0] = 0;
+    y[0] = 0;
+    x[1] = -(1 << (N - 1));
+    y[1] = -(1 << (N - 1));
+
+    std::vector<int> magnitude(count);
+    std::vector<int> angle(count);
+    cordic::polar(&x[0], &y[0], count, &magnitude[0], &angle[0]);
+
+    for(int i = 0; i < count; ++i)
+    {
+        typename cordic::value_type m;
+        typename cordic::angle_type a;
+        cordic::polar(typename cordic::value_type(x[i]), typename cordic::value_type(y[i]), m, a);
+        assert(m.get() == magnitude[i]);
+        assert(a.get() == angle[i]);
+        assert(cordic::magnitude(typename cordic::value_type(x[i]), typename cordic::value_type(y[i])).get() == magnitude[i]);
+        assert(cordic::atan2(typename cordic::value_type(y[i]), typename cordic::value_type(x[i])).get() == angle[i]);
+
+        const double r = std::sqrt(static_cast<double>(x[i]) * x[i] + static_cast<double>(y[i]) * y[i]);
+        assert(ulp(magnitude[i], std::min(r, scale - 1)) <= tolerance);
+        if(scale / 16 <= r)
+        {
+            assert(ulp(angle[i], std::atan2(static_cast<double>(y[i]), static_cast<double>(x[i])) / Pi * scale, scale) <= tolerance);
+        }
+    }
+}
+
+} // namespace
+
+void compare_cordic_angles()
+{
+    std::cout << "compare_cordic_angles:";
+
+    CheckAngles<12>::run();
+    CheckAngles<16>::run();
+    CheckAngles<24>::run();
+    CheckAngles<30>::run();
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_cordic_sincos()
+{
+    std::cout << "compare_cordic_sincos:";
+
+    check_sincos<12>(1, 1);
+    check_sincos<16>(1, 1);
+    check_sincos<24>(251, 2);
+
+    // an NCO: a phase accumulator of 16 bits wraps past pi
+    typedef Cordic<16> nco;
+    nco::angle_type phase(30000);
+    nco::value_type sin;
+    nco::value_type cos;
+    phase += 5000;
+    nco::sincos(phase, sin, cos);
+    assert(phase.get() == -30536);
+    assert(ulp(sin.get(), std::sin(-30536 * Pi / 32768) * 32768) <= 1);
+    assert(ulp(cos.get(), std::cos(-30536 * Pi / 32768) * 32768) <= 1);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_cordic_polar()
+{
+    std::cout << "compare_cordic_polar:";
+
+    check_polar<12>(1);
+    check_polar<16>(1);
+    check_polar<24>(2);
+
+    std::cout << "ok" << std::endl;
+}
+
+void test()
+{
+    compare_cordic_angles();
+    compare_cordic_sincos();
+    compare_cordic_polar();
+}
+
+int main(int, char* [])
+{
+    test();
+
+    return 0;
+}
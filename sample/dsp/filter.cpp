@@ -0,0 +1,319 @@
+#include "filter.h"
+#include "Bits.h"
+#include "Fixed.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+template<typename T> struct Sample;
+template<> struct Sample<short> { static const int Size = 16; };
+template<> struct Sample<int>   { static const int Size = 24; };
+
+// acc / 2^SHIFT rounded as Fixed rounds, and saturated to the sample
+template<int SHIFT, typename T>
+inline T finish(long acc)
+{
+    return static_cast<T>(Bits<Sample<T>::Size, Saturate<signed> >(detail::FixedRound<SHIFT>::apply(acc)).get());
+}
+
+template<typename T>
+void fir_scalar(const short* h, int taps, int factor, const T* x, int from, int to, T* y)
+{
+    for(int m = from; m < to; ++m)
+    {
+        long acc = 0;
+        for(int k = 0; k < taps; ++k)
+        {
+            acc += static_cast<long>(h[k]) * x[m * factor - k];
+        }
+        y[m] = finish<15, T>(acc);
+    }
+}
+
+template<typename T>
+void biquad_scalar(const BiquadBank& bank, int from, int channels, const T* x, int n, T* y)
+{
+    for(int c = from; c < channels; ++c)
+    {
+        long x1 = bank.x1[c];
+        long x2 = bank.x2[c];
+        long y1 = bank.y1[c];
+        long y2 = bank.y2[c];
+        for(int i = 0; i < n; ++i)
+        {
+            const long x0 = x[i * channels + c];
+            const long y0 = finish<14, T>(bank.b0[c] * x0 + bank.b1[c] * x1 + bank.b2[c] * x2 - bank.a1[c] * y1 - bank.a2[c] * y2);
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            y[i * channels + c] = static_cast<T>(y0);
+        }
+        bank.x1[c] = static_cast<int>(x1);
+        bank.x2[c] = static_cast<int>(x2);
+        bank.y1[c] = static_cast<int>(y1);
+        bank.y2[c] = static_cast<int>(y2);
+    }
+}
+
+#ifdef __AVX2__
+
+// true when every sum of products of h and 16 bit samples fits in int: |sum| <= (|h[0]| + ...) * 2^15 < 2^31
+bool fits_int(const short* h, int taps)
+{
+    long norm = 0;
+    for(int k = 0; k < taps; ++k)
+    {
+        norm += (h[k] < 0) ? -h[k] : h[k];
+    }
+    return norm <= 65535;
+}
+
+// a and b as the low and the high half of a 32 bit lane, the operand of _mm256_madd_epi16
+inline int pair(short a, short b)
+{
+    return static_cast<int>(static_cast<unsigned short>(a) | (static_cast<unsigned int>(static_cast<unsigned short>(b)) << 16));
+}
+
+// 4 samples sign extended to 64 bit lanes
+inline __m256i load4(const short* p)
+{
+    return _mm256_cvtepi16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+inline __m256i load4(const int* p)
+{
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+// 8 32 bit lanes, already saturated to the sample
+inline void store8(short* p, __m256i v)
+{
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(v, v), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+}
+
+inline void store8(int* p, __m256i v)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+// the low halves of the 64 bit lanes of lo and then of hi, as 8 32 bit lanes
+inline __m256i narrow(__m256i lo, __m256i hi)
+{
+    const __m256i index = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    return _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(lo, index), _mm256_permutevar8x32_epi32(hi, index), 0x20);
+}
+
+// finish on 32 bit lanes; saturation is left to _mm256_packs_epi32
+template<int SHIFT>
+inline __m256i finish8(__m256i acc)
+{
+    const __m256i odd = _mm256_and_si256(_mm256_srai_epi32(acc, SHIFT), _mm256_set1_epi32(1));
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(acc, _mm256_set1_epi32((1 << (SHIFT - 1)) - 1)), odd), SHIFT);
+}
+
+// finish on 64 bit lanes. AVX2 has no arithmetic shift of 64 bit lanes, so the sum is biased by 2^62
+// to shift it as unsigned, and the bias is removed after the shift
+template<int SHIFT, int SIZE>
+inline __m256i finish4(__m256i acc)
+{
+    const __m256i odd     = _mm256_and_si256(_mm256_srli_epi64(acc, SHIFT), _mm256_set1_epi64x(1));
+    const __m256i biased  = _mm256_add_epi64(_mm256_add_epi64(acc, _mm256_set1_epi64x((1L << 62) + (1L << (SHIFT - 1)) - 1)), odd);
+    const __m256i q       = _mm256_sub_epi64(_mm256_srli_epi64(biased, SHIFT), _mm256_set1_epi64x(1L << (62 - SHIFT)));
+    const __m256i max     = _mm256_set1_epi64x((1L << (SIZE - 1)) - 1);
+    const __m256i min     = _mm256_set1_epi64x(-(1L << (SIZE - 1)));
+    const __m256i clamped = _mm256_blendv_epi8(q, max, _mm256_cmpgt_epi64(q, max));
+    return _mm256_blendv_epi8(clamped, min, _mm256_cmpgt_epi64(min, clamped));
+}
+
+// 16 outputs per step; a pair of taps is multiplied and added in one _mm256_madd_epi16. the outputs
+// 0-3 and 8-11 sum in lo, 4-7 and 12-15 in hi, which _mm256_packs_epi32 puts back in order
+int fir16_narrow(const short* h, int taps, const short* x, int n, short* y)
+{
+    int i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        __m256i lo = _mm256_setzero_si256();
+        __m256i hi = _mm256_setzero_si256();
+        int     k  = 0;
+        for(; k + 2 <= taps; k += 2)
+        {
+            const __m256i c = _mm256_set1_epi32(pair(h[k], h[k + 1]));
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i - k));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i - k - 1));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), c));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), c));
+        }
+        if(k < taps)
+        {
+            const __m256i c = _mm256_set1_epi32(pair(h[k], 0));
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i - k));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, a), c));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, a), c));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i), _mm256_packs_epi32(finish8<15>(lo), finish8<15>(hi)));
+    }
+    return i;
+}
+
+// 8 outputs per step, in two vectors of 64 bit sums
+template<typename T>
+int fir_wide(const short* h, int taps, const T* x, int n, T* y)
+{
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256i lo = _mm256_setzero_si256();
+        __m256i hi = _mm256_setzero_si256();
+        for(int k = 0; k < taps; ++k)
+        {
+            const __m256i c = _mm256_set1_epi64x(h[k]);
+            lo = _mm256_add_epi64(lo, _mm256_mul_epi32(load4(x + i - k), c));
+            hi = _mm256_add_epi64(hi, _mm256_mul_epi32(load4(x + i - k + 4), c));
+        }
+        store8(y + i, narrow(finish4<15, Sample<T>::Size>(lo), finish4<15, Sample<T>::Size>(hi)));
+    }
+    return i;
+}
+
+inline __m256i reverse16(__m256i v)
+{
+    const __m256i index = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                           14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, index), 0x4e);
+}
+
+inline int sum8(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return _mm_cvtsi128_si32(s);
+}
+
+// each kept output is a dot product of 16 taps per step; the coefficients are reversed in the vector
+// to meet the samples in memory order
+void fir16_decimate_narrow(const short* h, int taps, int factor, const short* x, int n, short* y)
+{
+    for(int m = 0; m < n / factor; ++m)
+    {
+        const short* last = x + m * factor;
+        __m256i      acc  = _mm256_setzero_si256();
+        int          k    = 0;
+        for(; k + 16 <= taps; k += 16)
+        {
+            const __m256i c = reverse16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + k)));
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - k - 15));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(s, c));
+        }
+        long sum = sum8(acc);
+        for(; k < taps; ++k)
+        {
+            sum += h[k] * last[-k];
+        }
+        y[m] = finish<15, short>(sum);
+    }
+}
+
+// 8 channels per step, in two vectors of 64 bit sums; the state stays in registers over the block
+template<typename T>
+int biquad_wide(const BiquadBank& bank, int channels, const T* x, int n, T* y)
+{
+    int c = 0;
+    for(; c + 8 <= channels; c += 8)
+    {
+        __m256i b0[2], b1[2], b2[2], a1[2], a2[2], x1[2], x2[2], y1[2], y2[2];
+        for(int j = 0; j < 2; ++j)
+        {
+            const int offset = c + 4 * j;
+            b0[j] = load4(bank.b0 + offset);
+            b1[j] = load4(bank.b1 + offset);
+            b2[j] = load4(bank.b2 + offset);
+            a1[j] = load4(bank.a1 + offset);
+            a2[j] = load4(bank.a2 + offset);
+            x1[j] = load4(bank.x1 + offset);
+            x2[j] = load4(bank.x2 + offset);
+            y1[j] = load4(bank.y1 + offset);
+            y2[j] = load4(bank.y2 + offset);
+        }
+        for(int i = 0; i < n; ++i)
+        {
+            for(int j = 0; j < 2; ++j)
+            {
+                const __m256i x0  = load4(x + i * channels + c + 4 * j);
+                const __m256i ff  = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epi32(b0[j], x0), _mm256_mul_epi32(b1[j], x1[j])), _mm256_mul_epi32(b2[j], x2[j]));
+                const __m256i fb  = _mm256_add_epi64(_mm256_mul_epi32(a1[j], y1[j]), _mm256_mul_epi32(a2[j], y2[j]));
+                const __m256i y0  = finish4<14, Sample<T>::Size>(_mm256_sub_epi64(ff, fb));
+                x2[j] = x1[j];
+                x1[j] = x0;
+                y2[j] = y1[j];
+                y1[j] = y0;
+            }
+            store8(y + i * channels + c, narrow(y1[0], y1[1]));
+        }
+        store8(bank.x1 + c, narrow(x1[0], x1[1]));
+        store8(bank.x2 + c, narrow(x2[0], x2[1]));
+        store8(bank.y1 + c, narrow(y1[0], y1[1]));
+        store8(bank.y2 + c, narrow(y2[0], y2[1]));
+    }
+    return c;
+}
+
+#endif
+
+} // namespace
+
+void fir16(const short* h, int taps, const short* x, int n, short* y)
+{
+    int i = 0;
+#ifdef __AVX2__
+    i = fits_int(h, taps) ? fir16_narrow(h, taps, x, n, y) : fir_wide(h, taps, x, n, y);
+#endif
+    fir_scalar(h, taps, 1, x, i, n, y);
+}
+
+void fir24(const short* h, int taps, const int* x, int n, int* y)
+{
+    int i = 0;
+#ifdef __AVX2__
+    i = fir_wide(h, taps, x, n, y);
+#endif
+    fir_scalar(h, taps, 1, x, i, n, y);
+}
+
+void fir16_decimate(const short* h, int taps, int factor, const short* x, int n, short* y)
+{
+#ifdef __AVX2__
+    if(fits_int(h, taps))
+    {
+        fir16_decimate_narrow(h, taps, factor, x, n, y);
+        return;
+    }
+#endif
+    fir_scalar(h, taps, factor, x, 0, n / factor, y);
+}
+
+void biquad16(const BiquadBank& bank, int channels, const short* x, int n, short* y)
+{
+    int c = 0;
+#ifdef __AVX2__
+    c = biquad_wide(bank, channels, x, n, y);
+#endif
+    biquad_scalar(bank, c, channels, x, n, y);
+}
+
+void biquad24(const BiquadBank& bank, int channels, const int* x, int n, int* y)
+{
+    int c = 0;
+#ifdef __AVX2__
+    c = biquad_wide(bank, channels, x, n, y);
+#endif
+    biquad_scalar(bank, c, channels, x, n, y);
+}
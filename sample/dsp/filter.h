@@ -0,0 +1,39 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+// fixed point filters which model a hardware datapath bit for bit:
+//   samples       Bits<16, signed> values in short, or Bits<24, signed> values in int
+//   FIR taps      Q15 coefficients (short)
+//   biquads       Q2.14 coefficients (short); a0 is 1
+// products are accumulated exactly, then rounded to nearest, ties to even (as Fixed does), and saturated
+// to the sample width (as Bits<N, Saturate<Signed> > does). with AVX2 the kernels multiply and accumulate
+// 8 or 16 samples per step; the results do not depend on the instruction set
+
+// y[i] = sum of h[k] * x[i - k] for k < taps, i < n; x[-taps + 1] .. x[-1] hold the previous samples
+void fir16(const short* h, int taps, const short* x, int n, short* y);
+void fir24(const short* h, int taps, const int* x, int n, int* y);
+
+// y[m] = sum of h[k] * x[m * factor - k] for k < taps, m < n / factor; only the kept outputs are computed,
+// as a polyphase decimator does. x[-taps + 1] .. x[-1] hold the previous samples
+void fir16_decimate(const short* h, int taps, int factor, const short* x, int n, short* y);
+
+// a biquad (direct form I) per channel, y[i] = b0 x[i] + b1 x[i - 1] + b2 x[i - 2] - a1 y[i - 1] - a2 y[i - 2];
+// the coefficients and the state of channel c are element c of each array, so that channels load as vectors
+struct BiquadBank
+{
+    const short* b0;
+    const short* b1;
+    const short* b2;
+    const short* a1;
+    const short* a2;
+    int*         x1; // x[i - 1], updated
+    int*         x2; // x[i - 2], updated
+    int*         y1; // y[i - 1], updated
+    int*         y2; // y[i - 2], updated
+};
+
+// x[i * channels + c] is sample i of channel c, i < n
+void biquad16(const BiquadBank& bank, int channels, const short* x, int n, short* y);
+void biquad24(const BiquadBank& bank, int channels, const int* x, int n, int* y);
+
+#endif//FILTER_H
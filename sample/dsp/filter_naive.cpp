@@ -0,0 +1,88 @@
+#include "filter_naive.h"
+
+#include "Bits.h"
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+typedef Bits<16, signed>              coefficient;
+typedef Bits<16, signed>              sample16;
+typedef Bits<24, signed>              sample24;
+typedef Bits<16, Saturate<signed> >   saturated16;
+typedef Bits<24, Saturate<signed> >   saturated24;
+
+// acc / 2^shift rounded to nearest, ties to even
+long round_even(long acc, int shift)
+{
+    const long q    = acc >> shift;
+    const long rest = acc - q * (1L << shift);
+    const long half = 1L << (shift - 1);
+    return ((half < rest) || ((rest == half) && ((q & 1) != 0))) ? q + 1 : q;
+}
+
+template<typename Sample, typename Saturated, typename T>
+void fir(const short* h, int taps, int factor, const T* x, int n, T* y)
+{
+    for(int m = 0; m < n / factor; ++m)
+    {
+        long acc = 0;
+        for(int k = 0; k < taps; ++k)
+        {
+            acc += static_cast<long>(coefficient(h[k]).get()) * Sample(x[m * factor - k]).get();
+        }
+        y[m] = static_cast<T>(Saturated(round_even(acc, 15)).get());
+    }
+}
+
+template<typename Sample, typename Saturated, typename T>
+void biquad(const BiquadBank& bank, int channels, const T* x, int n, T* y)
+{
+    for(int c = 0; c < channels; ++c)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            const Sample x0(x[i * channels + c]);
+            const long   acc = static_cast<long>(coefficient(bank.b0[c]).get()) * x0.get()
+                             + static_cast<long>(coefficient(bank.b1[c]).get()) * Sample(bank.x1[c]).get()
+                             + static_cast<long>(coefficient(bank.b2[c]).get()) * Sample(bank.x2[c]).get()
+                             - static_cast<long>(coefficient(bank.a1[c]).get()) * Sample(bank.y1[c]).get()
+                             - static_cast<long>(coefficient(bank.a2[c]).get()) * Sample(bank.y2[c]).get();
+            const Saturated y0(round_even(acc, 14));
+
+            bank.x2[c] = bank.x1[c];
+            bank.x1[c] = x0.get();
+            bank.y2[c] = bank.y1[c];
+            bank.y1[c] = static_cast<int>(y0.get());
+            y[i * channels + c] = static_cast<T>(y0.get());
+        }
+    }
+}
+
+} // namespace
+
+void fir16_naive(const short* h, int taps, const short* x, int n, short* y)
+{
+    fir<sample16, saturated16>(h, taps, 1, x, n, y);
+}
+
+void fir24_naive(const short* h, int taps, const int* x, int n, int* y)
+{
+    fir<sample24, saturated24>(h, taps, 1, x, n, y);
+}
+
+void fir16_decimate_naive(const short* h, int taps, int factor, const short* x, int n, short* y)
+{
+    fir<sample16, saturated16>(h, taps, factor, x, n, y);
+}
+
+void biquad16_naive(const BiquadBank& bank, int channels, const short* x, int n, short* y)
+{
+    biquad<sample16, saturated16>(bank, channels, x, n, y);
+}
+
+void biquad24_naive(const BiquadBank& bank, int channels, const int* x, int n, int* y)
+{
+    biquad<sample24, saturated24>(bank, channels, x, n, y);
+}
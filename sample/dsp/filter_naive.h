@@ -0,0 +1,14 @@
+#ifndef FILTER_NAIVE_H
+#define FILTER_NAIVE_H
+
+#include "filter.h"
+
+// the reference model of filter.h, one sample at a time with Bits
+
+void fir16_naive(const short* h, int taps, const short* x, int n, short* y);
+void fir24_naive(const short* h, int taps, const int* x, int n, int* y);
+void fir16_decimate_naive(const short* h, int taps, int factor, const short* x, int n, short* y);
+void biquad16_naive(const BiquadBank& bank, int channels, const short* x, int n, short* y);
+void biquad24_naive(const BiquadBank& bank, int channels, const int* x, int n, int* y);
+
+#endif//FILTER_NAIVE_H
@@ -0,0 +1,214 @@
+// g++ -ansi -Wall -O3 -mavx2 -I../.. -o filter_test filter_test.cpp filter.cpp filter_naive.cpp
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "filter.h"
+#include "filter_naive.h"
+
+namespace
+{
+
+const int History = 64;
+
+// a random value of size bits; the ends of the range come up often, to saturate the sums
+int random_value(int size)
+{
+    const int max = (1 << (size - 1)) - 1;
+    switch(std::rand() % 8)
+    {
+    case 0:  return max;
+    case 1:  return -max - 1;
+    default: return std::rand() % (2 * max + 2) - max - 1;
+    }
+}
+
+// coefficients whose sums fit in int (small) or not (large), to take both paths of the kernels
+std::vector<short> random_taps(int taps, bool large)
+{
+    std::vector<short> h(taps);
+    for(int k = 0; k < taps; ++k)
+    {
+        h[k] = static_cast<short>(large ? random_value(16) : (std::rand() % 2001 - 1000));
+    }
+    return h;
+}
+
+template<typename T>
+std::vector<T> random_samples(int n, int size)
+{
+    std::vector<T> x(n);
+    for(int i = 0; i < n; ++i)
+    {
+        x[i] = static_cast<T>(random_value(size));
+    }
+    return x;
+}
+
+struct Biquads
+{
+    std::vector<short> b0, b1, b2, a1, a2;
+    std::vector<int>   x1, x2, y1, y2;
+
+    Biquads(int channels, int size) : b0(channels), b1(channels), b2(channels), a1(channels), a2(channels),
+                                      x1(channels), x2(channels), y1(channels), y2(channels)
+    {
+        for(int c = 0; c < channels; ++c)
+        {
+            b0[c] = static_cast<short>(random_value(16));
+            b1[c] = static_cast<short>(random_value(16));
+            b2[c] = static_cast<short>(random_value(16));
+            a1[c] = static_cast<short>(random_value(16));
+            a2[c] = static_cast<short>(random_value(16));
+            x1[c] = random_value(size);
+            x2[c] = random_value(size);
+            y1[c] = random_value(size);
+            y2[c] = random_value(size);
+        }
+    }
+
+    BiquadBank bank()
+    {
+        const BiquadBank result = { &b0[0], &b1[0], &b2[0], &a1[0], &a2[0], &x1[0], &x2[0], &y1[0], &y2[0] };
+        return result;
+    }
+};
+
+template<typename T>
+void compare_fir(void (*f)(const short*, int, const T*, int, T*), void (*naive)(const short*, int, const T*, int, T*), int size)
+{
+    const int n = 203;
+    for(int taps = 1; taps <= History; taps += 7)
+    {
+        for(int large = 0; large < 2; ++large)
+        {
+            const std::vector<short> h = random_taps(taps, large != 0);
+            const std::vector<T>     x = random_samples<T>(History + n, size);
+            std::vector<T>           expected(n);
+            std::vector<T>           actual(n);
+
+            naive(&h[0], taps, &x[History], n, &expected[0]);
+            f(&h[0], taps, &x[History], n, &actual[0]);
+            assert(expected == actual);
+
+            // a block continues from the history of the previous one
+            f(&h[0], taps, &x[History], 100, &actual[0]);
+            f(&h[0], taps, &x[History + 100], n - 100, &actual[100]);
+            assert(expected == actual);
+        }
+    }
+}
+
+template<typename T>
+void compare_biquad(void (*f)(const BiquadBank&, int, const T*, int, T*), void (*naive)(const BiquadBank&, int, const T*, int, T*), int size)
+{
+    const int n = 50;
+    for(int channels = 1; channels <= 40; channels += 3)
+    {
+        Biquads                expected(channels, size);
+        Biquads                actual(expected);
+        const std::vector<T>   x = random_samples<T>(channels * n, size);
+        std::vector<T>         expectedY(channels * n);
+        std::vector<T>         actualY(channels * n);
+
+        naive(expected.bank(), channels, &x[0], n, &expectedY[0]);
+        f(actual.bank(), channels, &x[0], n, &actualY[0]);
+        assert(expectedY == actualY);
+        assert(expected.x1 == actual.x1);
+        assert(expected.x2 == actual.x2);
+        assert(expected.y1 == actual.y1);
+        assert(expected.y2 == actual.y2);
+    }
+}
+
+} // namespace
+
+void compare_fir16()
+{
+    std::cout << "compare_fir16:";
+
+    compare_fir<short>(fir16, fir16_naive, 16);
+
+    // Q15 taps 0.5 and -1.0: halves round to even, -1.0 * -1.0 saturates
+    const short h[] = { 16384, -32768 };
+    const short x[] = { 0, 3, 1, -32768, 0 };
+    short       y[4];
+    fir16(h, 2, x + 1, 4, y);
+    assert(y[0] == 2);
+    assert(y[1] == -2);
+    assert(y[2] == -16385);
+    assert(y[3] == 32767);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_fir24()
+{
+    std::cout << "compare_fir24:";
+
+    compare_fir<int>(fir24, fir24_naive, 24);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_fir16_decimate()
+{
+    std::cout << "compare_fir16_decimate:";
+
+    const int n = 240;
+    for(int factor = 1; factor <= 6; ++factor)
+    {
+        for(int taps = 1; taps <= History; taps += 5)
+        {
+            for(int large = 0; large < 2; ++large)
+            {
+                const std::vector<short> h = random_taps(taps, large != 0);
+                const std::vector<short> x = random_samples<short>(History + n, 16);
+                std::vector<short>       expected(n / factor);
+                std::vector<short>       actual(n / factor);
+
+                fir16_decimate_naive(&h[0], taps, factor, &x[History], n, &expected[0]);
+                fir16_decimate(&h[0], taps, factor, &x[History], n, &actual[0]);
+                assert(expected == actual);
+            }
+        }
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_biquad16()
+{
+    std::cout << "compare_biquad16:";
+
+    compare_biquad<short>(biquad16, biquad16_naive, 16);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_biquad24()
+{
+    std::cout << "compare_biquad24:";
+
+    compare_biquad<int>(biquad24, biquad24_naive, 24);
+
+    std::cout << "ok" << std::endl;
+}
+
+void test()
+{
+    compare_fir16();
+    compare_fir24();
+    compare_fir16_decimate();
+    compare_biquad16();
+    compare_biquad24();
+}
+
+int main(int, char* [])
+{
+    test();
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef DATAPATH_H
+#define DATAPATH_H
+
+#include "rtl.h"
+
+// blocks written once for both models (see rtl.h)
+
+// CRC-8 (x^8 + x^2 + x + 1) of one more byte, a shift per bit:
+//   crc = {crc[6:0], 1'b0} ^ ({8{crc[7]}} & 8'h07)
+template<typename M>
+typename M::template signal<8>::type crc8(const typename M::template signal<8>::type& crc, const typename M::template signal<8>::type& data)
+{
+    typedef typename M::template signal<1>::type bit;
+    typedef typename M::template signal<8>::type byte;
+
+    byte c(crc ^ data);
+    for(int i = 0; i < 8; ++i)
+    {
+        c = byte((part<6, 0>(c), bit(0))) ^ (replicate<8>(part<7, 7>(c)) & byte(0x07));
+    }
+    return c;
+}
+
+// an 8 bit ALU: op 0 add, 1 subtract, 2 and, 3 xor; carry is the 9th bit of add and subtract
+template<typename M>
+void alu(const typename M::template signal<2>::type& op, const typename M::template signal<8>::type& a, const typename M::template signal<8>::type& b,
+         typename M::template signal<8>::type& result, typename M::template signal<1>::type& zero, typename M::template signal<1>::type& carry)
+{
+    typedef typename M::template signal<1>::type bit;
+    typedef typename M::template signal<8>::type byte;
+    typedef typename M::template signal<9>::type wide;
+
+    const wide sum((bit(0), a) + (bit(0), b));
+    const wide difference((bit(0), a) - (bit(0), b));
+    const wide arithmetic(mux(part<0, 0>(op), difference, sum));
+    const byte logic(mux(part<0, 0>(op), byte(a ^ b), byte(a & b)));
+
+    result = mux(part<1, 1>(op), logic, byte(part<7, 0>(arithmetic)));
+    zero   = bit(result == byte(0));
+    carry  = mux(part<1, 1>(op), bit(0), bit(part<8, 8>(arithmetic)));
+}
+
+#endif//DATAPATH_H
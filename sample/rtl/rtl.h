@@ -0,0 +1,495 @@
+#ifndef RTL_H
+#define RTL_H
+
+#include "Bits.h"
+#include "planar.h"
+
+#include <vector>
+
+// RTL datapaths on Bits, as Verilog writes them:
+//   {a, b}        (a, b)            the comma Pack of Bits
+//   {K{x}}        replicate<K>(x)
+//   x[Hi:Lo]      part<Hi, Lo>(x)
+//   s ? a : b     mux(s, a, b)
+//   a <= b        r.d(b), r.q()     a Reg takes its input at the tick of its Clock
+//
+// a combinational block written once on the signals of a model, M::signal<N>::type, evaluates either
+// one instance (Scalar: Bits<N>) or 64 independent instances bit sliced in a word per bit (Sliced: Slice<N>).
+// signals are unsigned bit vectors, as in Verilog; + and - wrap to N bits
+
+//----------------------------------------------------------------------
+
+class Clock;
+
+class RegBase
+{
+public:
+    virtual ~RegBase();
+
+protected:
+    explicit RegBase(Clock& clock);
+
+    virtual void update() = 0;
+
+private:
+    friend class Clock;
+
+    RegBase(const RegBase&);
+    RegBase& operator = (const RegBase&);
+
+    Clock*   clock_; // 0 once the clock is destroyed
+    RegBase* next_;
+};
+
+// the registers of a clock domain; tick() updates every register after the whole cycle is evaluated,
+// so that a block reads the outputs of the previous cycle whatever the order of its statements.
+// a register leaves its clock when it is destroyed, and a clock releases its registers when it is
+// destroyed, so that they may be destroyed in any order
+class Clock
+{
+public:
+    Clock() : head_(0)
+    {
+    }
+
+    ~Clock()
+    {
+        for(RegBase* r = head_; r != 0; r = r->next_)
+        {
+            r->clock_ = 0;
+        }
+    }
+
+    void tick()
+    {
+        for(RegBase* r = head_; r != 0; r = r->next_)
+        {
+            r->update();
+        }
+    }
+
+private:
+    friend class RegBase;
+
+    Clock(const Clock&);
+    Clock& operator = (const Clock&);
+
+    RegBase* head_;
+};
+
+inline RegBase::RegBase(Clock& clock) : clock_(&clock), next_(clock.head_)
+{
+    clock.head_ = this;
+}
+
+inline RegBase::~RegBase()
+{
+    if(clock_ == 0)
+    {
+        return;
+    }
+    for(RegBase** r = &clock_->head_; *r != 0; r = &(*r)->next_)
+    {
+        if(*r == this)
+        {
+            *r = next_;
+            break;
+        }
+    }
+}
+
+// a register of T, Bits or Slice
+template<typename T>
+class Reg : public RegBase
+{
+public:
+    explicit Reg(Clock& clock, const T& reset = T()) : RegBase(clock), q_(reset), d_(reset)
+    {
+    }
+
+    // the output, the input taken at the last tick
+    const T& q() const
+    {
+        return q_;
+    }
+
+    // the input of this cycle
+    template<typename V>
+    void d(const V& next)
+    {
+        d_ = T(next);
+    }
+
+private:
+    virtual void update()
+    {
+        q_ = d_;
+    }
+
+    T q_;
+    T d_;
+};
+
+//----------------------------------------------------------------------
+
+template<int HI, int LO, int N, typename T>
+inline emattsan::bits::Bits<HI - LO + 1> part(const emattsan::bits::Bits<N, T>& x)
+{
+    return emattsan::bits::Bits<HI - LO + 1>(x.template slice<HI, LO>().get());
+}
+
+template<int K, int N, typename T>
+inline emattsan::bits::Bits<K * N> replicate(const emattsan::bits::Bits<N, T>& x)
+{
+    unsigned long result = 0;
+    for(int i = 0; i < K; ++i)
+    {
+        result = (result << N) | static_cast<unsigned long>(x.getSequence());
+    }
+    return emattsan::bits::Bits<K * N>(result);
+}
+
+template<typename T>
+inline T mux(bool select, const T& a, const T& b)
+{
+    return select ? a : b;
+}
+
+template<typename T, typename U>
+inline U mux(const emattsan::bits::Bits<1, T>& select, const U& a, const U& b)
+{
+    return (select.get() != 0) ? a : b;
+}
+
+//----------------------------------------------------------------------
+
+// N bit signals of 64 instances: plane[b] holds bit b of every instance, instance i in bit 63 - i
+// (the layout of transpose64x64)
+template<int N>
+struct Slice
+{
+    static const int Size = N;
+
+    uint64_t plane[N];
+
+    Slice()
+    {
+        for(int b = 0; b < N; ++b)
+        {
+            plane[b] = 0;
+        }
+    }
+
+    // the same value in every instance
+    explicit Slice(unsigned long value)
+    {
+        for(int b = 0; b < N; ++b)
+        {
+            plane[b] = ((value >> b) & 1) ? ~static_cast<uint64_t>(0) : 0;
+        }
+    }
+
+    // instances from values[0] .. values[count - 1], count <= 64; the others are 0.
+    // 8 instances and 8 bits at a time, so that only the N planes used are transposed
+    template<typename T>
+    static Slice load(const emattsan::bits::Bits<N, T>* values, int count)
+    {
+        Slice result;
+        for(int i = 0; i < 64; i += 8)
+        {
+            for(int c = 0; c < N; c += 8)
+            {
+                // row k is bits c .. c + 7 of instance i + k
+                uint64_t rows = 0;
+                for(int k = 0; k < 8; ++k)
+                {
+                    const uint64_t value = (i + k < count) ? static_cast<uint64_t>(values[i + k].getSequence()) : 0;
+                    rows = (rows << 8) | ((value >> c) & 0xff);
+                }
+                // byte b is bit c + b of the 8 instances
+                const uint64_t columns = transpose8x8(rows);
+                for(int b = c; (b < N) && (b < c + 8); ++b)
+                {
+                    result.plane[b] = (result.plane[b] << 8) | ((columns >> ((b - c) * 8)) & 0xff);
+                }
+            }
+        }
+        return result;
+    }
+
+    template<typename T>
+    void store(emattsan::bits::Bits<N, T>* values, int count) const
+    {
+        for(int i = 0; i < count; i += 8)
+        {
+            uint64_t instances[8] = { 0 };
+            for(int c = 0; c < N; c += 8)
+            {
+                uint64_t columns = 0;
+                for(int b = c; (b < N) && (b < c + 8); ++b)
+                {
+                    columns |= ((plane[b] >> (56 - i)) & 0xff) << ((b - c) * 8);
+                }
+                const uint64_t rows = transpose8x8(columns);
+                for(int k = 0; k < 8; ++k)
+                {
+                    instances[k] |= ((rows >> ((7 - k) * 8)) & 0xff) << c;
+                }
+            }
+            for(int k = 0; (k < 8) && (i + k < count); ++k)
+            {
+                values[i + k].setSequence(static_cast<typename emattsan::bits::Bits<N, T>::const_arg_type>(instances[k]));
+            }
+        }
+    }
+
+    Slice operator ~ () const
+    {
+        Slice result;
+        for(int b = 0; b < N; ++b)
+        {
+            result.plane[b] = ~plane[b];
+        }
+        return result;
+    }
+
+    // shifts of the same distance in every instance
+    Slice operator << (int n) const
+    {
+        Slice result;
+        for(int b = n; b < N; ++b)
+        {
+            result.plane[b] = plane[b - n];
+        }
+        return result;
+    }
+
+    Slice operator >> (int n) const
+    {
+        Slice result;
+        for(int b = 0; b + n < N; ++b)
+        {
+            result.plane[b] = plane[b + n];
+        }
+        return result;
+    }
+
+    friend inline Slice operator & (const Slice& lhs, const Slice& rhs)
+    {
+        Slice result;
+        for(int b = 0; b < N; ++b)
+        {
+            result.plane[b] = lhs.plane[b] & rhs.plane[b];
+        }
+        return result;
+    }
+
+    friend inline Slice operator | (const Slice& lhs, const Slice& rhs)
+    {
+        Slice result;
+        for(int b = 0; b < N; ++b)
+        {
+            result.plane[b] = lhs.plane[b] | rhs.plane[b];
+        }
+        return result;
+    }
+
+    friend inline Slice operator ^ (const Slice& lhs, const Slice& rhs)
+    {
+        Slice result;
+        for(int b = 0; b < N; ++b)
+        {
+            result.plane[b] = lhs.plane[b] ^ rhs.plane[b];
+        }
+        return result;
+    }
+
+    // ripple carry adders; a - b is a + ~b + 1
+    friend inline Slice operator + (const Slice& lhs, const Slice& rhs)
+    {
+        return add(lhs, rhs, 0);
+    }
+
+    friend inline Slice operator - (const Slice& lhs, const Slice& rhs)
+    {
+        return add(lhs, ~rhs, ~static_cast<uint64_t>(0));
+    }
+
+    friend inline Slice<1> operator == (const Slice& lhs, const Slice& rhs)
+    {
+        Slice<1> result;
+        result.plane[0] = ~static_cast<uint64_t>(0);
+        for(int b = 0; b < N; ++b)
+        {
+            result.plane[0] &= ~(lhs.plane[b] ^ rhs.plane[b]);
+        }
+        return result;
+    }
+
+    friend inline Slice<1> operator != (const Slice& lhs, const Slice& rhs)
+    {
+        return ~(lhs == rhs);
+    }
+
+    // unsigned; the borrow out of lhs - rhs
+    friend inline Slice<1> operator < (const Slice& lhs, const Slice& rhs)
+    {
+        uint64_t borrow = 0;
+        for(int b = 0; b < N; ++b)
+        {
+            borrow = (~lhs.plane[b] & (rhs.plane[b] | borrow)) | (lhs.plane[b] & rhs.plane[b] & borrow);
+        }
+        Slice<1> result;
+        result.plane[0] = borrow;
+        return result;
+    }
+
+private:
+    static Slice add(const Slice& lhs, const Slice& rhs, uint64_t carry)
+    {
+        Slice result;
+        for(int b = 0; b < N; ++b)
+        {
+            const uint64_t half = lhs.plane[b] ^ rhs.plane[b];
+            result.plane[b] = half ^ carry;
+            carry = (lhs.plane[b] & rhs.plane[b]) | (half & carry);
+        }
+        return result;
+    }
+};
+
+template<int N> const int Slice<N>::Size;
+
+// {lhs, rhs}
+template<int N, int M>
+inline Slice<N + M> operator , (const Slice<N>& lhs, const Slice<M>& rhs)
+{
+    Slice<N + M> result;
+    for(int b = 0; b < M; ++b)
+    {
+        result.plane[b] = rhs.plane[b];
+    }
+    for(int b = 0; b < N; ++b)
+    {
+        result.plane[M + b] = lhs.plane[b];
+    }
+    return result;
+}
+
+template<int HI, int LO, int N>
+inline Slice<HI - LO + 1> part(const Slice<N>& x)
+{
+    Slice<HI - LO + 1> result;
+    for(int b = 0; b <= HI - LO; ++b)
+    {
+        result.plane[b] = x.plane[LO + b];
+    }
+    return result;
+}
+
+template<int K, int N>
+inline Slice<K * N> replicate(const Slice<N>& x)
+{
+    Slice<K * N> result;
+    for(int b = 0; b < K * N; ++b)
+    {
+        result.plane[b] = x.plane[b % N];
+    }
+    return result;
+}
+
+template<int N>
+inline Slice<N> mux(const Slice<1>& select, const Slice<N>& a, const Slice<N>& b)
+{
+    Slice<N> result;
+    for(int i = 0; i < N; ++i)
+    {
+        result.plane[i] = (select.plane[0] & a.plane[i]) | (~select.plane[0] & b.plane[i]);
+    }
+    return result;
+}
+
+// any number of instances kept bit sliced, 64 to a Slice, so that the state of a block stays sliced
+// across cycles and is transposed only when it enters and leaves the model
+template<int N>
+class SliceArray
+{
+public:
+    explicit SliceArray(int count) : count_(count), slices_((count + 63) / 64)
+    {
+    }
+
+    int count() const
+    {
+        return count_;
+    }
+
+    // the number of Slices; instances 64 * j .. 64 * j + 63 are in (*this)[j]
+    int size() const
+    {
+        return static_cast<int>(slices_.size());
+    }
+
+    Slice<N>& operator [] (int j)
+    {
+        return slices_[j];
+    }
+
+    const Slice<N>& operator [] (int j) const
+    {
+        return slices_[j];
+    }
+
+    template<typename T>
+    void load(const emattsan::bits::Bits<N, T>* values)
+    {
+        for(int j = 0; j < size(); ++j)
+        {
+            slices_[j] = Slice<N>::load(values + j * 64, block(j));
+        }
+    }
+
+    template<typename T>
+    void store(emattsan::bits::Bits<N, T>* values) const
+    {
+        for(int j = 0; j < size(); ++j)
+        {
+            slices_[j].store(values + j * 64, block(j));
+        }
+    }
+
+private:
+    int block(int j) const
+    {
+        return (count_ - j * 64 < 64) ? (count_ - j * 64) : 64;
+    }
+
+    int                    count_;
+    std::vector<Slice<N> > slices_;
+};
+
+//----------------------------------------------------------------------
+
+struct Scalar
+{
+    template<int N>
+    struct signal
+    {
+        typedef emattsan::bits::Bits<N> type;
+    };
+
+    static const int Instances = 1;
+};
+
+struct Sliced
+{
+    template<int N>
+    struct signal
+    {
+        typedef Slice<N> type;
+    };
+
+    static const int Instances = 64;
+};
+
+#endif//RTL_H
@@ -0,0 +1,339 @@
+// g++ -ansi -Wall -O3 -I../.. -I../color_conv -o rtl_test rtl_test.cpp ../color_conv/planar.cpp
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "rtl.h"
+#include "datapath.h"
+
+using namespace emattsan::bits;
+
+namespace
+{
+
+// CRC-8 of one more byte, as software computes it
+unsigned int crc8_naive(unsigned int crc, unsigned int data)
+{
+    crc ^= data;
+    for(int i = 0; i < 8; ++i)
+    {
+        crc = ((crc << 1) ^ ((crc & 0x80) ? 0x07 : 0)) & 0xff;
+    }
+    return crc;
+}
+
+template<int N>
+std::vector<Bits<N> > random_bits(int count)
+{
+    std::vector<Bits<N> > values(count);
+    for(int i = 0; i < count; ++i)
+    {
+        values[i] = static_cast<unsigned long>(std::rand()) * 65537;
+    }
+    return values;
+}
+
+// the sliced instances of s against values
+template<int N>
+bool equal(const Slice<N>& s, const Bits<N>* values, int count)
+{
+    std::vector<Bits<N> > stored(count);
+    s.store(&stored[0], count);
+    for(int i = 0; i < count; ++i)
+    {
+        if(stored[i].get() != values[i].get())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<int N>
+bool equal(const Slice<N>& s, const std::vector<Bits<N> >& values)
+{
+    return equal(s, &values[0], static_cast<int>(values.size()));
+}
+
+} // namespace
+
+void compare_rtl_bits()
+{
+    std::cout << "compare_rtl_bits:";
+
+    const Bits<4> a(0x9);
+    const Bits<4> b(0x5);
+
+    // {a, b}, {3{b[0]}}, a[2:1]
+    assert(Bits<8>((a, b)).get() == 0x95);
+    assert((replicate<3>(part<0, 0>(b)).get() == 0x7));
+    assert(replicate<2>(a).get() == 0x99);
+    assert((part<2, 1>(a).get() == 0x0));
+    assert((part<3, 2>(b).get() == 0x1));
+    assert((Bits<9>((replicate<2>(part<3, 3>(a)), part<2, 0>(a), b)).get() == 0x195));
+
+    assert(mux(Bits<1>(1), a, b).get() == 0x9);
+    assert(mux(Bits<1>(0), a, b).get() == 0x5);
+    assert(mux(a == b, a, b).get() == 0x5);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_rtl_reg()
+{
+    std::cout << "compare_rtl_reg:";
+
+    // two registers swap in one cycle, whatever the order of the statements
+    Clock        clock;
+    Reg<Bits<4> > r1(clock, Bits<4>(1));
+    Reg<Bits<4> > r2(clock, Bits<4>(2));
+    r1.d(r2.q());
+    r2.d(r1.q());
+    assert(r1.q().get() == 1);
+    assert(r2.q().get() == 2);
+    clock.tick();
+    assert(r1.q().get() == 2);
+    assert(r2.q().get() == 1);
+
+    // 64 accumulators of 8 bits, one per instance
+    const std::vector<Bits<8> > in = random_bits<8>(64);
+    const Slice<8>              x  = Slice<8>::load(&in[0], 64);
+    Reg<Slice<8> >              acc(clock);
+    for(int cycle = 0; cycle < 5; ++cycle)
+    {
+        acc.d(acc.q() + x);
+        clock.tick();
+    }
+    std::vector<Bits<8> > expected(64);
+    for(int i = 0; i < 64; ++i)
+    {
+        expected[i] = in[i].get() * 5;
+    }
+    assert(equal(acc.q(), expected));
+
+    // a register destroyed before its clock leaves it
+    {
+        Reg<Bits<4> > inner(clock, Bits<4>(3));
+        inner.d(r2.q());
+        clock.tick();
+        assert(inner.q().get() == 1);
+    }
+    r1.d(Bits<4>(7));
+    clock.tick();
+    assert(r1.q().get() == 7);
+
+    // and a clock destroyed before its registers releases them
+    Clock*        early = new Clock;
+    Reg<Bits<4> > outer(*early, Bits<4>(5));
+    Reg<Bits<4> > other(*early);
+    delete early;
+    assert(outer.q().get() == 5);
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_rtl_slice()
+{
+    std::cout << "compare_rtl_slice:";
+
+    for(int count = 1; count <= 64; count += 9)
+    {
+        const std::vector<Bits<8> > a  = random_bits<8>(count);
+        const std::vector<Bits<8> > b  = random_bits<8>(count);
+        const std::vector<Bits<1> > s  = random_bits<1>(count);
+        const Slice<8>              sa = Slice<8>::load(&a[0], count);
+        const Slice<8>              sb = Slice<8>::load(&b[0], count);
+        const Slice<1>              ss = Slice<1>::load(&s[0], count);
+        assert(equal(sa, a));
+
+        std::vector<Bits<8> >  r8(count);
+        std::vector<Bits<1> >  r1(count);
+        std::vector<Bits<16> > r16(count);
+        std::vector<Bits<3> >  r3(count);
+        std::vector<Bits<24> > r24(count);
+
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] + b[i];
+        }
+        assert(equal(sa + sb, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] - b[i];
+        }
+        assert(equal(sa - sb, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] & b[i];
+        }
+        assert(equal(sa & sb, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] | b[i];
+        }
+        assert(equal(sa | sb, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] ^ b[i];
+        }
+        assert(equal(sa ^ sb, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = ~a[i];
+        }
+        assert(equal(~sa, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] << 3;
+        }
+        assert(equal(sa << 3, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = a[i] >> 3;
+        }
+        assert(equal(sa >> 3, r8));
+        for(int i = 0; i < count; ++i)
+        {
+            r8[i] = mux(s[i], a[i], b[i]);
+        }
+        assert(equal(mux(ss, sa, sb), r8));
+
+        for(int i = 0; i < count; ++i)
+        {
+            r1[i] = (a[i] == b[i]) || ((i % 3) == 0);
+        }
+        std::vector<Bits<8> > c(b);
+        for(int i = 0; i < count; i += 3)
+        {
+            c[i] = a[i];
+        }
+        assert(equal(sa == Slice<8>::load(&c[0], count), r1));
+        for(int i = 0; i < count; ++i)
+        {
+            r1[i] = !r1[i].get();
+        }
+        assert(equal(sa != Slice<8>::load(&c[0], count), r1));
+        for(int i = 0; i < count; ++i)
+        {
+            r1[i] = a[i].get() < b[i].get();
+        }
+        assert(equal(sa < sb, r1));
+
+        for(int i = 0; i < count; ++i)
+        {
+            r16[i] = (a[i], b[i]);
+        }
+        assert(equal((sa, sb), r16));
+        for(int i = 0; i < count; ++i)
+        {
+            r3[i] = part<6, 4>(a[i]);
+        }
+        assert((equal(part<6, 4>(sa), r3)));
+        for(int i = 0; i < count; ++i)
+        {
+            r24[i] = replicate<3>(a[i]);
+        }
+        assert(equal(replicate<3>(sa), r24));
+
+        // more than 8 planes load and store 8 at a time
+        assert(equal(Slice<16>::load(&r16[0], count), r16));
+        assert(equal(Slice<24>::load(&r24[0], count), r24));
+        const std::vector<Bits<13> > v13 = random_bits<13>(count);
+        assert(equal(Slice<13>::load(&v13[0], count), v13));
+    }
+
+    assert(equal(Slice<8>(0xa5), std::vector<Bits<8> >(64, Bits<8>(0xa5))));
+
+    std::cout << "ok" << std::endl;
+}
+
+void compare_rtl_blocks()
+{
+    std::cout << "compare_rtl_blocks:";
+
+    const int                   n    = 1000;
+    const std::vector<Bits<8> > crc  = random_bits<8>(n);
+    const std::vector<Bits<8> > data = random_bits<8>(n);
+    const std::vector<Bits<2> > op   = random_bits<2>(n);
+
+    // the blocks one instance at a time, against software
+    std::vector<Bits<8> > crcs(n);
+    std::vector<Bits<8> > results(n);
+    std::vector<Bits<1> > zeros(n);
+    std::vector<Bits<1> > carries(n);
+    for(int i = 0; i < n; ++i)
+    {
+        crcs[i] = crc8<Scalar>(crc[i], data[i]);
+        assert(crcs[i].get() == crc8_naive(crc[i].get(), data[i].get()));
+
+        alu<Scalar>(op[i], crc[i], data[i], results[i], zeros[i], carries[i]);
+        const unsigned int a = crc[i].get();
+        const unsigned int b = data[i].get();
+        const unsigned int r = (op[i].get() == 0) ? a + b : (op[i].get() == 1) ? a - b : (op[i].get() == 2) ? a & b : a ^ b;
+        assert(results[i].get() == (r & 0xff));
+        assert(zeros[i].get() == ((r & 0xff) == 0));
+        assert(carries[i].get() == ((op[i].get() < 2) && ((r & 0x100) != 0)));
+    }
+
+    // 64 instances at a time
+    for(int i = 0; i < n; i += 64)
+    {
+        const int      count = std::min(64, n - i);
+        const Slice<8> c     = Slice<8>::load(&crc[i], count);
+        const Slice<8> d     = Slice<8>::load(&data[i], count);
+        assert(equal(crc8<Sliced>(c, d), &crcs[i], count));
+
+        Slice<8> result;
+        Slice<1> zero;
+        Slice<1> carry;
+        alu<Sliced>(Slice<2>::load(&op[i], count), c, d, result, zero, carry);
+        assert(equal(result, &results[i], count));
+        assert(equal(zero, &zeros[i], count));
+        assert(equal(carry, &carries[i], count));
+    }
+
+    // many cycles on instances kept sliced, transposed once in and once out
+    std::vector<Bits<8> > scalar(crc);
+    SliceArray<8>         state(n);
+    SliceArray<8>         input(n);
+    state.load(&crc[0]);
+    input.load(&data[0]);
+    assert(state.size() == (n + 63) / 64);
+    for(int cycle = 0; cycle < 4; ++cycle)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            scalar[i] = crc8<Scalar>(scalar[i], data[i]);
+        }
+        for(int j = 0; j < state.size(); ++j)
+        {
+            state[j] = crc8<Sliced>(state[j], input[j]);
+        }
+    }
+    std::vector<Bits<8> > stored(n);
+    state.store(&stored[0]);
+    for(int i = 0; i < n; ++i)
+    {
+        assert(stored[i].get() == scalar[i].get());
+    }
+
+    std::cout << "ok" << std::endl;
+}
+
+void test()
+{
+    compare_rtl_bits();
+    compare_rtl_reg();
+    compare_rtl_slice();
+    compare_rtl_blocks();
+}
+
+int main(int, char* [])
+{
+    test();
+
+    return 0;
+}